@@ -63,6 +63,8 @@ enum ConstructionTag {
 };
 
 struct ConstructionPreset {
+	GC_SERIALIZABLE_CLASS
+public:
 	ConstructionPreset();
 	int maxCondition;
 	std::vector<int> graphic;
@@ -94,6 +96,8 @@ struct ConstructionPreset {
 	std::vector<StatusEffectType> passiveStatusEffects;
 };
 
+BOOST_CLASS_VERSION(ConstructionPreset, 0)
+
 class Construction : public Entity {
 	GC_SERIALIZABLE_CLASS
 	
@@ -155,6 +159,8 @@ public:
 	static std::set<std::string> Categories;
 	static void LoadPresets(std::string);
 	static void ResolveProducts();
+	static void SavePresetCache(OutputArchive&);
+	static void LoadPresetCache(InputArchive&);
 	virtual boost::weak_ptr<Container> Storage() const;
 	bool HasTag(ConstructionTag) const;
 	virtual void Update();
@@ -18,6 +18,7 @@ along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
 #include <set>
 #include <string>
 #include <list>
+#include <vector>
 #include <boost/enable_shared_from_this.hpp>
 
 #include "UI/UIComponents.hpp"
@@ -36,6 +37,28 @@ struct FlightPath {
 	int height;
 };
 
+/* The squares a flying entity still has to pass, the next one at the back. The steps are kept in
+   one contiguous buffer taken from a pool shared by all entities, and the buffer goes back to the
+   pool when the flight ends, so launching a projectile doesn't allocate once the pool is warm. */
+class FlightPathList {
+	std::vector<FlightPath>* steps;
+	static std::vector<std::vector<FlightPath>*> pool;
+public:
+	FlightPathList() : steps(0) {}
+	FlightPathList(const FlightPathList&) : steps(0) {} //Flights aren't copied along with entities
+	FlightPathList& operator=(const FlightPathList&) { clear(); return *this; }
+	~FlightPathList() { clear(); }
+
+	bool empty() const { return !steps || steps->empty(); }
+	size_t size() const { return steps ? steps->size() : 0; }
+	FlightPath& operator[](size_t i) { return (*steps)[i]; }
+	FlightPath& back() { return steps->back(); }
+	const FlightPath& back() const { return steps->back(); }
+	void push_back(const FlightPath&);
+	void pop_back();
+	void clear();
+};
+
 class Entity: public boost::enable_shared_from_this<Entity> {
 	GC_SERIALIZABLE_CLASS
 	
@@ -48,7 +71,7 @@ protected:
 	int faction;
 	int velocity, nextVelocityMove;
 	Coordinate velocityTarget;
-	std::list<FlightPath> flightPath;
+	FlightPathList flightPath;
 	int bulk;
 	float strobe;
 	Map* map;
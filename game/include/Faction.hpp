@@ -105,6 +105,8 @@ public:
 
 	FactionGoal GetCurrentGoal() const;
 	static void LoadPresets(std::string);
+	static void SavePresetCache(OutputArchive&);
+	static void LoadPresetCache(InputArchive&);
 
 	bool IsCoward();
 	bool IsAggressive();
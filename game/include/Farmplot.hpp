@@ -16,6 +16,7 @@ along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
 #pragma once
 
 #include "Stockpile.hpp"
+#include "TimerWheel.hpp"
 #include "data/Serialization.hpp"
 
 class FarmPlot : public Stockpile {
@@ -26,7 +27,11 @@ class FarmPlot : public Stockpile {
 	FarmPlot(ConstructionType=0, int symbol='?', Coordinate=Coordinate(0,0));
 	bool tilled;
 	std::map<ItemType, bool> allowedSeeds;
-	std::map<Coordinate, int> growth;
+	/* Planted tiles, due when their plant next gets a chance to change stage. Rebuilt on load,
+	   so wheel times only mean something within one session. */
+	TimerWheel<Coordinate> growthTimers;
+	int GrowthClock() const;
+	void ScheduleGrowth(const Coordinate&);
 public:
 	void Update();
 	virtual void Draw(Coordinate, TCODConsole*);
@@ -38,6 +43,7 @@ public:
 	virtual void AcceptVisitor(ConstructionVisitor& visitor);
 	virtual bool Full(ItemType);
 	virtual Coordinate FreePosition();
+	virtual void ItemAdded(boost::weak_ptr<Item>);
 };
 
 BOOST_CLASS_VERSION(FarmPlot, 0)
@@ -15,6 +15,7 @@ You should have received a copy of the GNU General Public License
 along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
 #pragma once
 
+#include <vector>
 #include <boost/enable_shared_from_this.hpp>
 #include <libtcod.hpp>
 
@@ -23,6 +24,23 @@ along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
 
 class Job;
 
+//A spell a fire wants to launch, created once every fire has been updated
+struct SpellLaunch {
+	SpellLaunch(const Coordinate& pos, int type, const Coordinate& target, int speed) :
+		pos(pos), target(target), type(type), speed(speed) {}
+	Coordinate pos, target;
+	int type, speed;
+};
+
+/* What every burning tile shares during one fire phase: the wind is looked up once, and the
+   sparks, smoke and steam the fires give off are collected in launches. */
+struct FireStep {
+	FireStep(Direction wind);
+	Coordinate drift; //Which way the wind carries things, -1, 0 or 1 on each axis
+	int spark, smoke, steam;
+	std::vector<SpellLaunch> launches;
+};
+
 class FireNode : public boost::enable_shared_from_this<FireNode> {
 	GC_SERIALIZABLE_CLASS
 	
@@ -36,7 +54,7 @@ public:
 	FireNode(const Coordinate& = zero, int temperature = 0);
 	~FireNode();
 
-	void Update();
+	void Update(FireStep&);
 	void Draw(Coordinate, TCODConsole*);
 	Coordinate Position();
 	void AddHeat(int);
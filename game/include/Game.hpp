@@ -37,6 +37,7 @@ along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
 #include "Fire.hpp"
 #include "Spell.hpp"
 #include "GCamp.hpp"
+#include "TimerWheel.hpp"
 
 #include "MapRenderer.hpp"
 #include "data/Serialization.hpp"
@@ -101,11 +102,43 @@ class Game {
 
 	static bool initializedOnce;
 
+	/* Periodic work that used to roll a die every tick. Each timer fires on average
+	   as often as the roll succeeded, see Random::Geometric. */
+	enum NPCTimer {
+		NPC_THIRST_TIMER,
+		NPC_HUNGER_TIMER,
+		NPC_FILTH_TIMER,
+		NPC_TIMER_COUNT
+	};
+	TimerWheel<std::pair<int, int> > npcTimers; //(npc uid, NPCTimer)
+	TimerWheel<boost::weak_ptr<WaterNode> > waterTimers;
+	TimerWheel<int> decayTimers; //Item uids, advanced once per DecayItems() pass and rebuilt on load
+	int stockpileRefreshDelay;
+	static int NPCTimerPeriod(int);
+	void ScheduleNPCTimers(int uid);
+	static const int DormantWaterSteps = 8; //Water in dormant chunks updates this many times less often
+	void ScheduleWater(boost::shared_ptr<WaterNode>);
+	void UpdateTimers();
+	void UpdateActivity();
+
+	/* Projectile hits are collected while flying items and spells move, and applied together once
+	   every projectile has moved, so a creature dying mid-phase doesn't change what the rest hit. */
+	std::vector<std::pair<boost::weak_ptr<Entity>, Attack> > pendingHits;
+	void UpdateProjectiles();
+	void UpdateFires();
+
+	void GenerateNature(uint32 seed);
+	int ChooseNatureObject(const Coordinate&, int surroundingNatureObjects);
+	bool CanGrowNatureObject(const Coordinate&);
+	void InsertNatureObject(boost::shared_ptr<NatureObject>);
+
 public:
 	static Game* Inst();
 	~Game();
 	static bool LoadGame(const std::string&);
 	static bool SaveGame(const std::string&);
+	static bool SaveGameInBackground(const std::string&);
+	static void FinishBackgroundSave(bool wait = false);
 	static void ToMainMenu(bool);
 	static bool ToMainMenu();
 	void Running(bool);
@@ -230,6 +263,7 @@ public:
 	std::list<boost::weak_ptr<WaterNode> > waterList;
 	void CreateWater(Coordinate);
 	void CreateWater(Coordinate,int,int=0);
+	void CreateWater(const std::vector<Coordinate>&, int);
 	void CreateWaterFromNode(boost::shared_ptr<WaterNode>);
 	void RemoveWater(Coordinate, bool removeFromList = true);
 	Coordinate FindWater(Coordinate);
@@ -248,6 +282,7 @@ public:
 	static bool Adjacent(Coordinate, Coordinate);
 	void CreateNatureObject(Coordinate, int surroundingNatureObjects);
 	void CreateNatureObject(Coordinate, std::string);
+	void CreateNatureObjects(const std::vector<Coordinate>&, const std::string&);
 	void CreateDitch(Coordinate);
 
 	Season CurrentSeason();
@@ -256,6 +291,8 @@ public:
 	void SpawnTillageJobs();
 	void DeTillFarmPlots();
 	void DecayItems();
+	void ScheduleDecay(boost::shared_ptr<Item>);
+	boost::uint64_t DecayClock() const;
 
 	std::list<boost::weak_ptr<FilthNode> > filthList;
 	void CreateFilth(Coordinate);
@@ -271,13 +308,14 @@ public:
 
 	void AddDelay(int delay, boost::function<void()>);
 
-	std::list<boost::weak_ptr<FireNode> > fireList;
+	std::vector<boost::weak_ptr<FireNode> > fireList; //Burning tiles, in no particular order
 	void CreateFire(Coordinate);
 	void CreateFire(Coordinate,int);
 	void StartFire(Coordinate);
 
 	boost::shared_ptr<Spell> CreateSpell(Coordinate, int type);
 	std::list<boost::shared_ptr<Spell> > spellList;
+	void QueueHit(boost::weak_ptr<Entity> target, const Attack&);
 
 	int GetAge();
 
@@ -285,4 +323,4 @@ public:
 	void ProvideMap();
 };
 
-BOOST_CLASS_VERSION(Game, 1)
+BOOST_CLASS_VERSION(Game, 2)
@@ -0,0 +1,70 @@
+/* Copyright 2010-2011 Ilkka Halila
+This file is part of Goblins' Lot (former Goblin Camp)
+
+Goblin Camp is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Goblin Camp is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
+#pragma once
+
+#include <vector>
+#include <boost/noncopyable.hpp>
+#if GCAMP_USE_THREADS
+#include <mutex>
+#endif
+
+#include <libtcod.hpp>
+#include "Coordinate.hpp"
+
+/*
+	One route across the map shared by a group of NPCs heading the same way, like a squad
+	given an order or a raid coming in from the map's edge. Instead of every member searching
+	all the way there, the first one to look for a path (the leader) searches as usual and
+	hands its path over, and the rest only search to the nearest tile of that route and from
+	where it passes closest to their own target. Members walking the same tiles step around
+	each other with Map::FindEquivalentMoveTarget as they move.
+*/
+class GroupPath : private boost::noncopyable {
+public:
+	enum State {
+		PENDING, //The leader is still searching
+		LEADING, //Returned to the member that has to do the search
+		READY,
+		FAILED
+	};
+
+	//How far from the route a member can be, and its target, to be able to use it
+	static const int JoinDistance = 12;
+
+	GroupPath();
+
+	//Returns LEADING to the first member to ask while the route is still unknown
+	State Enlist();
+	State GetState();
+	//Called by the leader once its search ends, with null if it found no path
+	void Publish(const std::vector<Coordinate>* path);
+
+	/*Fills path with a way from start to target that follows the route, using short searches to
+	get on and off it. Returns false when either end is too far from the route, or the part of
+	the route in between can't be walked anymore.*/
+	bool Follow(const Coordinate& start, const Coordinate& target, const Coordinate& extent,
+		const ITCODPathCallback* map, void* walker, std::vector<Coordinate>& path) const;
+
+private:
+#if GCAMP_USE_THREADS
+	std::mutex stateMutex;
+#endif
+	State state;
+	std::vector<Coordinate> route;
+
+	//Index of the tile from the route, at or after first, that's closest to p
+	size_t Closest(const Coordinate& p, size_t first) const;
+};
@@ -21,6 +21,8 @@ along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
 #include <map>
 #include <boost/unordered_map.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/dynamic_bitset.hpp>
 #include <libtcod.hpp>
 
 #include "Entity.hpp"
@@ -33,6 +35,7 @@ typedef int ItemCategory;
 typedef int ItemType;
 
 class ItemCat {
+	GC_SERIALIZABLE_CLASS
 public:
 	ItemCat();
 	bool flammable;
@@ -50,12 +53,16 @@ public:
 };
 
 struct ItemPreset {
+	GC_SERIALIZABLE_CLASS
+public:
 	ItemPreset();
 	int graphic;
 	TCODColor color;
 	std::string name;
 	std::set<ItemCategory> specificCategories;
 	std::set<ItemCategory> categories;
+	boost::dynamic_bitset<> categoryBits; //The same categories as bits, see Item::UpdateCategoryBits
+	bool IsCategory(ItemCategory) const;
 	std::vector<ItemCategory> components;
 	int nutrition;
 	ItemType growth;
@@ -81,6 +88,9 @@ struct ItemPreset {
 	std::vector<std::pair<StatusEffectType, int> > removesEffects;
 };
 
+BOOST_CLASS_VERSION(ItemCat, 0)
+BOOST_CLASS_VERSION(ItemPreset, 0)
+
 class Item : public Entity {
 	GC_SERIALIZABLE_CLASS
 	
@@ -88,9 +98,10 @@ class Item : public Entity {
 	friend class ItemListener;
 	
 	ItemType type;
-	std::set<ItemCategory> categories;
+	boost::dynamic_bitset<> categoryOverride; //Only set when the item's categories differ from its preset's
 	bool flammable;
-	int decayCounter;
+	int decayCounter; //Decay passes left when the item was scheduled to rot, -1 if it never does
+	boost::uint64_t decayScheduled; //Game::DecayClock() at that time
 
 	static boost::unordered_map<std::string, ItemType> itemTypeNames;
 	static boost::unordered_map<std::string, ItemCategory> itemCategoryNames;
@@ -107,6 +118,7 @@ protected:
 		std::vector<boost::weak_ptr<Item> > = std::vector<boost::weak_ptr<Item> >());
 	boost::weak_ptr<Item> container;
 	bool internal;
+	void ChangeType(ItemType);
 
 public:
 	static std::string ItemTypeToString(ItemType);
@@ -120,6 +132,9 @@ public:
 	static void LoadPresets(std::string);
 	static void ResolveContainers();
 	static void UpdateEffectItems();
+	static void UpdateCategoryBits();
+	static void SavePresetCache(OutputArchive&);
+	static void LoadPresetCache(InputArchive&);
 
 	static std::vector<ItemCat> Categories;
 	static std::vector<ItemCat> ParentCategories;
@@ -140,7 +155,7 @@ public:
 	int GetGraphic();
 	TCODColor Color();
 	void Color(TCODColor);
-	bool IsCategory(ItemCategory);
+	bool IsCategory(ItemCategory) const;
 	virtual void Reserve(bool);
 	virtual void SetFaction(int);
 	virtual int GetFaction() const;
@@ -171,6 +186,7 @@ public:
 	void Nutrition(int);
 	ItemType Growth();
 	void Growth(ItemType);
+	void Grow();
 };
 
 BOOST_CLASS_VERSION(OrganicItem, 0)
@@ -20,6 +20,7 @@ along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
 #include <list>
 
 #include <boost/tuple/tuple.hpp>
+#include <boost/container/small_vector.hpp>
 
 #include "Construction.hpp"
 #include "data/Serialization.hpp"
@@ -130,11 +131,16 @@ class Job {
 	bool obeyTerritory;
 	std::list<int> mapMarkers;
 	bool fireAllowed;
+	const std::string* name; //Interned, jobs with the same name share it
 public:
-	Job(std::string = "NONAME JOB", JobPriority = MED, int zone = 0, bool menial = true);
+	Job(const std::string& = "NONAME JOB", JobPriority = MED, int zone = 0, bool menial = true);
 	~Job();
-	std::string name;
-	std::vector<Task> tasks;
+	//Jobs are made and thrown away all the time, these come from a pool instead of the heap
+	static boost::shared_ptr<Job> Create(const std::string& = "NONAME JOB", JobPriority = MED, int zone = 0, bool menial = true);
+	const std::string& Name() const;
+	//Most jobs have only a few tasks, those are kept inside the job
+	typedef boost::container::small_vector<Task, 6> TaskList;
+	TaskList tasks;
 	void priority(JobPriority);
 	JobPriority priority();
 	bool Completed();
@@ -15,6 +15,11 @@ You should have received a copy of the GNU General Public License
 along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
 #pragma once
 
+#include <map>
+#include <list>
+#include <utility>
+#include <boost/unordered_map.hpp>
+
 #include "Job.hpp"
 #include "data/Serialization.hpp"
 
@@ -29,6 +34,19 @@ class JobManager {
 	std::vector<int> expertNPCsWaiting;
 	std::vector<std::vector<boost::weak_ptr<Job> > > toolJobs;
 	std::list<boost::shared_ptr<Job> > failList;
+
+	typedef std::list<boost::shared_ptr<Job> > JobList;
+	//Where each job in availableList or waitingList currently is
+	boost::unordered_map<Job*, std::pair<JobList*, JobList::iterator> > queued;
+	/* Jobs by the targets of their tasks, recorded when the job is queued. Entries aren't
+	   removed with the job, they are checked against 'queued' when looked up. */
+	std::multimap<std::pair<Action, Coordinate>, boost::weak_ptr<Job> > jobsByTarget;
+	size_t jobsByTargetPruned;
+
+	void Enqueue(JobList&, boost::shared_ptr<Job>);
+	JobList::iterator Dequeue(JobList&, JobList::iterator);
+	void IndexTargets(boost::shared_ptr<Job>);
+	void PruneTargets();
 public:
 	static JobManager* Inst();
 	static void Reset();
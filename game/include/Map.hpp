@@ -18,16 +18,18 @@ along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
 
 #include <utility>
 #include <list>
+#include <vector>
 #if GCAMP_USE_THREADS
 #include <shared_mutex>
 #endif
 
-#include <boost/multi_array.hpp>
-#include <boost/unordered_set.hpp>
+#include <boost/shared_ptr.hpp>
 #include <libtcod.hpp>
 
 #include "Tile.hpp"
+#include "MapChunk.hpp"
 #include "Coordinate.hpp"
+#include "SpatialIndex.hpp"
 #include "data/Serialization.hpp"
 
 class MapMarker;
@@ -41,27 +43,61 @@ class Map : public ITCODPathCallback {
 	
 	Map();
 	static Map* instance;
-	boost::multi_array<Tile, 2> tileMap;
-	boost::multi_array<CacheTile, 2> cachedTileMap;
 	Coordinate extent; //X->width, Y->height
+	Coordinate chunkExtent; //Amount of chunks in both dimensions
+	std::vector<boost::shared_ptr<MapChunk> > chunks;
+	std::vector<int> dirtyChunks; //Chunks with tiles whose cached copy is out of date
 	float waterlevel;
 	int overlayFlags;
 	std::list< std::pair<unsigned int, MapMarker> > mapMarkers;
 	unsigned int markerids;
-	boost::unordered_set<Coordinate> changedTiles;
+	SpatialIndex drinkableWater; //Tiles whose water node is coastal and deep enough to drink from
+	SpatialIndex filthTiles;
+	std::vector<int> regions; //Label of the 8-connected walkable area each tile is in, 0 if unwalkable
+	bool regionsDirty; //Walkability changed since the labels were made
+	std::vector<Coordinate> blockedTiles; //Turned unwalkable since TakeBlockedTiles() was called
 
+	void Resize(const Coordinate&);
+
+	inline int ChunkIndex(const Coordinate& p) const {
+		return (p.Y() >> MapChunk::SizeBits) * chunkExtent.X() + (p.X() >> MapChunk::SizeBits);
+	}
+	inline const MapChunk& chunk(const Coordinate& p) const {
+		return *chunks[ChunkIndex(p)];
+	}
+	inline MapChunk& chunk(const Coordinate& p) {
+		return *chunks[ChunkIndex(p)];
+	}
 	inline const Tile& tile(const Coordinate& p) const {
-		return tileMap[p.X()][p.Y()];
+		return chunk(p).tiles[MapChunk::Index(p)];
 	}
 	inline const CacheTile& cachedTile(const Coordinate& p) const {
-		return cachedTileMap[p.X()][p.Y()];
+		return chunk(p).cache[MapChunk::Index(p)];
 	}
 	inline Tile& tile(const Coordinate& p) {
-		return tileMap[p.X()][p.Y()];
+		return chunk(p).tiles[MapChunk::Index(p)];
 	}
 	inline CacheTile& cachedTile(const Coordinate& p) {
-		return cachedTileMap[p.X()][p.Y()];
+		return chunk(p).cache[MapChunk::Index(p)];
+	}
+	template <typename T>
+	inline boost::shared_ptr<T> node(const Coordinate& p, boost::shared_ptr<T> TileNodes::*field) const {
+		return chunk(p).Node(MapChunk::Index(p), field);
+	}
+	//Queues the tile's cached copy for updating
+	inline void MarkChanged(const Coordinate& p) {
+		MapChunk& changedChunk = chunk(p);
+		changedChunk.changed.set(MapChunk::Index(p));
+		++changedChunk.revision;
+		if (!changedChunk.dirty) {
+			changedChunk.dirty = true;
+			dirtyChunks.push_back(ChunkIndex(p));
+		}
 	}
+	void RefreshCachedTile(MapChunk&, int index);
+	Coordinate ChunkOrigin(int index) const;
+	void WakeChunk(int index);
+	void SleepChunk(int index);
 	
 public:
 	typedef std::list<std::pair<unsigned int, MapMarker> >::const_iterator MarkerIterator;
@@ -77,6 +113,12 @@ public:
 	bool IsWalkable(const Coordinate&) const;
 	bool IsWalkable(const Coordinate&,void*) const;
 	void SetWalkable(const Coordinate&,bool);
+	/* Walkability changes are passed on so that paths and jobs can be checked before anyone bumps
+	   into them: blocked tiles through TakeBlockedTiles(), connectivity through the walkable areas. */
+	void TakeBlockedTiles(std::vector<Coordinate>&);
+	void UpdateRegions(); //Relabels the walkable areas if walkability changed
+	//False only if both tiles are walkable and in separate areas, for creatures that can't fly or dig
+	bool Reachable(const Coordinate& from, const Coordinate& to) const;
 	
 	Coordinate Extent();
 	int Width();
@@ -90,12 +132,16 @@ public:
 	TileType GetType(const Coordinate&);
 	void ResetType(const Coordinate&,TileType,float tileHeight = 0.0);  //ResetType() resets all tile variables to defaults
 	void ChangeType(const Coordinate&,TileType,float tileHeight = 0.0); //ChangeType() preserves information such as buildability
+	void ChangeTypes(const std::vector<Coordinate>&, TileType, unsigned int seed); //ChangeType() for many tiles, marking each chunk changed once
+	void ResetTypes(const std::vector<TileType>&, unsigned int seed); //ResetType() for the whole map from a row-major array, RebuildCache() afterwards
 	void MoveTo(const Coordinate&,int);
 	void MoveFrom(const Coordinate&,int);
 	void SetConstruction(const Coordinate&,int);
 	int GetConstruction(const Coordinate&) const;
 	boost::weak_ptr<WaterNode> GetWater(const Coordinate&);
 	void SetWater(const Coordinate&,boost::shared_ptr<WaterNode>);
+	void SetDrinkable(const Coordinate&, const WaterNode*, bool); //Called by WaterNode when its drinkability changes
+	const SpatialIndex& DrinkableWater() const;
 	bool IsLow(const Coordinate&) const;
 	void SetLow(const Coordinate&,bool);
 	bool BlocksWater(const Coordinate&) const;
@@ -110,6 +156,7 @@ public:
 	std::set<int>* ItemList(const Coordinate&);
 	boost::weak_ptr<FilthNode> GetFilth(const Coordinate&);
 	void SetFilth(const Coordinate&,boost::shared_ptr<FilthNode>);
+	const SpatialIndex& FilthTiles() const;
 	boost::weak_ptr<BloodNode> GetBlood(const Coordinate&);
 	void SetBlood(const Coordinate&,boost::shared_ptr<BloodNode>);
 	boost::weak_ptr<FireNode> GetFire(const Coordinate&);
@@ -164,7 +211,18 @@ public:
 	mutable std::shared_mutex cacheMutex;
 #endif
 	void UpdateCache();
+	//Rebuilds the whole cache in one pass, used after loading
+	void RebuildCache();
 	void TileChanged(const Coordinate&);
+	//Goes up whenever a tile of the chunk holding p changes
+	unsigned int ChunkRevision(const Coordinate&) const;
+	//Chunks further than ActivityRadius chunks from every anchor (the camp's creatures and
+	//constructions) go dormant, the others wake up and catch up on what they missed
+	static const int ActivityRadius = 2;
+	void UpdateActivity(const std::vector<Coordinate>& anchors);
+	bool IsActive(const Coordinate&) const;
+	//Replaces every tile's npc and item uid sets with the given (position, uid) pairs
+	void RebuildEntityLists(std::vector<std::pair<Coordinate, int> >& npcs, std::vector<std::pair<Coordinate, int> >& items);
 };
 
-BOOST_CLASS_VERSION(Map, 2)
+BOOST_CLASS_VERSION(Map, 5)
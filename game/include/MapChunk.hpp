@@ -0,0 +1,87 @@
+/* Copyright 2010-2011 Ilkka Halila
+This file is part of Goblins' Lot (former Goblin Camp)
+
+Goblin Camp is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Goblin Camp is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
+#pragma once
+
+#include <bitset>
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_array.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "Tile.hpp"
+#include "Coordinate.hpp"
+
+/* A square block of map tiles, together with their cached copies read by the pathing threads.
+
+   The water, filth, blood and fire nodes, which most of the map never has, are kept in a
+   block that is allocated when the chunk gets its first node and freed once it has none.
+   Changes are tracked per tile so that Map::UpdateCache() only visits the chunks that
+   changed since the last time.
+
+   Chunks that are not near the camp are dormant: Map and Weather skip their random tile
+   updates and catch up on them when the chunk becomes active again, see Map::UpdateActivity(). */
+class MapChunk : private boost::noncopyable {
+	boost::scoped_array<TileNodes> nodes;
+	int nodeCount;
+
+public:
+	static const int SizeBits = 5;
+	static const int Size = 1 << SizeBits; //32x32 tiles
+	static const int Mask = Size - 1;
+	static const int TileCount = Size * Size;
+
+	Tile tiles[TileCount];
+	CacheTile cache[TileCount];
+	std::bitset<TileCount> changed; //Tiles whose cached copy is out of date
+	bool dirty; //Waiting in Map's list of chunks to update the cache of
+	unsigned int revision; //Goes up with every change, for anything that keeps data per chunk
+
+	bool active; //Simulated in full detail
+	int pendingNaturify; //Map::Naturify() calls that fell on this chunk while it was dormant
+	int weatherPhase; //Weather's seasonal tile changes that were applied here before going dormant
+	double weatherExposure;
+
+	MapChunk() : nodeCount(0), dirty(false), revision(0),
+		active(false), pendingNaturify(0), weatherPhase(0), weatherExposure(0.0) {}
+
+	//Index of the tile at p, which has to be inside this chunk
+	static inline int Index(const Coordinate& p) {
+		return ((p.Y() & Mask) << SizeBits) | (p.X() & Mask);
+	}
+
+	//The nodes on a tile, or null if the chunk has none at all
+	inline const TileNodes* Nodes(int index) const {
+		return nodes ? &nodes[index] : 0;
+	}
+	bool HasNodes() const { return nodeCount > 0; }
+
+	template <typename T>
+	inline boost::shared_ptr<T> Node(int index, boost::shared_ptr<T> TileNodes::*field) const {
+		return nodes ? nodes[index].*field : boost::shared_ptr<T>();
+	}
+
+	template <typename T>
+	void SetNode(int index, boost::shared_ptr<T> TileNodes::*field, const boost::shared_ptr<T>& value) {
+		if (!nodes) {
+			if (!value) return;
+			nodes.reset(new TileNodes[TileCount]);
+		}
+		//Held until the end, in case destroying the node leads back to this chunk
+		boost::shared_ptr<T> previous = nodes[index].*field;
+		nodeCount += (value ? 1 : 0) - (previous ? 1 : 0);
+		nodes[index].*field = value;
+		if (nodeCount == 0) nodes.reset();
+	}
+};
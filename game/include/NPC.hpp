@@ -18,6 +18,8 @@ along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
 
 #include <queue>
 #include <list>
+#include <vector>
+#include <bitset>
 #if GCAMP_USE_THREADS
 #include <mutex>
 #endif
@@ -25,6 +27,7 @@ along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
 #include <boost/multi_array.hpp>
 #include <boost/function.hpp>
 #include <boost/weak_ptr.hpp>
+#include <boost/unordered_set.hpp>
 
 #include <libtcod.hpp>
 
@@ -51,6 +54,7 @@ along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
 typedef int NPCType;
 
 class Faction;
+class GroupPath;
 
 enum Trait {
 	FRESH,
@@ -79,7 +83,9 @@ public:
 BOOST_CLASS_VERSION(SkillSet, 0)
 
 struct NPCPreset {
-	NPCPreset(std::string);
+	GC_SERIALIZABLE_CLASS
+public:
+	NPCPreset(std::string = "");
 	std::string typeName;
 	std::string name;
 	std::string plural;
@@ -105,13 +111,15 @@ struct NPCPreset {
 	int faction;
 };
 
+BOOST_CLASS_VERSION(NPCPreset, 0)
+
 class NPC : public Entity {
 	GC_SERIALIZABLE_CLASS
 	
 	friend class Game;
 	friend class NPCListener;
 	friend class Faction;
-	friend void tFindPath(TCODPath*, int, int, int, int, NPC*, bool);
+	friend void tFindPath(int, int, int, int, NPC*, bool, boost::shared_ptr<GroupPath>);
 	
 	NPC(Coordinate = Coordinate(0,0),
 		boost::function<bool(boost::shared_ptr<NPC>)> findJob = boost::function<bool(boost::shared_ptr<NPC>)>(),
@@ -125,11 +133,14 @@ class NPC : public Entity {
 #if GCAMP_USE_THREADS
 	std::mutex pathMutex;
 #endif
-	TCODPath *path;
+	std::vector<Coordinate> path;
 	int pathIndex;
 	bool nopath;
 	bool findPathWorking;
 	bool pathIsDangerous;
+	boost::shared_ptr<GroupPath> groupPath; //Route to share on the next path search
+	boost::shared_ptr<GroupPath> awaitedGroup; //Its leader is still searching, findPathWorking stays on until it's done
+	Coordinate awaitedTarget;
 
 	int timer;
 	unsigned int nextMove;
@@ -153,6 +164,12 @@ class NPC : public Entity {
 	int thinkSpeed;
 	std::list<StatusEffect> statusEffects;
 	std::list<StatusEffect>::iterator statusEffectIterator;
+	/* Which effects statusEffects holds, and the product of their stat and resistance changes.
+	   UpdateEffectCache() refreshes these whenever an effect is added or removed. */
+	std::bitset<STATUS_EFFECT_COUNT> effectFlags;
+	double effectStatMultipliers[STAT_COUNT];
+	double effectResistanceMultipliers[RES_COUNT];
+	void UpdateEffectCache();
 	int statusGraphicCounter;
 	void HandleThirst();
 	void HandleHunger();
@@ -195,6 +212,10 @@ class NPC : public Entity {
 	void UpdateVelocity();
 	int addedTasksToCurrentJob;
 
+	void CheckPathDanger();
+	bool FollowGroupPath(const GroupPath&, const Coordinate& target);
+	void ResumeGroupPath();
+
 	bool hasMagicRangedAttacks;
 
 	void ScanSurroundings(bool onlyHostiles=false);
@@ -243,7 +264,9 @@ public:
 	void TaskFinished(TaskResult, std::string = "");
 	TaskResult Move(TaskResult);
 	void findPath(Coordinate);
+	void JoinGroupPath(boost::shared_ptr<GroupPath>);
 	bool IsPathWalkable();
+	void CheckPath(const boost::unordered_set<Coordinate>& blocked);
 	void StartJob(boost::shared_ptr<Job>);
 	void AddEffect(StatusEffectType);
 	void AddEffect(StatusEffect);
@@ -274,6 +297,7 @@ public:
 	boost::weak_ptr<Item> Carrying() const;
 	bool HasHands() const;
 	bool IsTunneler() const;
+	bool BoundToWalkableArea() const; //Can't fly or dig, so stays within Map's walkable area
 	bool IsFlying() const; //Special case for pathing's sake. Equivalent to HasEffect(FLYING) except it's threadsafe
 	void FindNewArmor();
 	boost::weak_ptr<Item> Wearing() const;
@@ -283,6 +307,8 @@ public:
 	int GetMaxHealth() const;
 
 	static void LoadPresets(std::string);
+	static void SavePresetCache(OutputArchive&);
+	static void LoadPresetCache(InputArchive&);
 	static std::vector<NPCPreset> Presets;
 	static std::string NPCTypeToString(NPCType);
 	static NPCType StringToNPCType(std::string);
@@ -319,4 +345,4 @@ public:
 
 BOOST_CLASS_VERSION(NPC, 1)
 
-void tFindPath(TCODPath*, int, int, int, int, NPC*, bool);
+void tFindPath(int, int, int, int, NPC*, bool, boost::shared_ptr<GroupPath>);
@@ -28,6 +28,7 @@ typedef int ItemType;
 typedef int NatureObjectType;
 
 class NatureObjectPreset {
+	GC_SERIALIZABLE_CLASS
 public:
 	NatureObjectPreset();
 	std::string name;
@@ -44,6 +45,8 @@ public:
 	int graphicsHint;
 };
 
+BOOST_CLASS_VERSION(NatureObjectPreset, 0)
+
 class NatureObject : public Entity {
 	GC_SERIALIZABLE_CLASS
 	
@@ -62,6 +65,8 @@ public:
 	~NatureObject();
 	static std::vector<NatureObjectPreset> Presets;
 	static void LoadPresets(std::string);
+	static void SavePresetCache(OutputArchive&);
+	static void LoadPresetCache(InputArchive&);
 
 	int Type();
 
@@ -17,13 +17,67 @@ along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
 
 #include <array>
 #include <random>
+#include <boost/cstdint.hpp>
 
 #include <boost/random.hpp>
 #include <libtcod.hpp>
 #include <Coordinate.hpp>
 
 namespace Random {
-	typedef boost::rand48 GeneratorImpl;
+	/* xoshiro128** by David Blackman and Sebastiano Vigna, a small and fast generator
+	   usable with Boost.Random distributions. */
+	class Xoshiro128 {
+		boost::uint32_t state[4];
+		static inline boost::uint32_t Rotl(boost::uint32_t x, int k) { return (x << k) | (x >> (32 - k)); }
+	public:
+		typedef boost::uint32_t result_type;
+		static const bool has_fixed_range = true;
+		static const result_type min_value = 0;
+		static const result_type max_value = 0xffffffffU;
+
+		Xoshiro128(boost::uint64_t value = 1) { seed(value); }
+
+		//Fills the state using splitmix64, so that similar seeds give unrelated streams
+		void seed(boost::uint64_t value) {
+			for (int i = 0; i < 4; i += 2) {
+				boost::uint64_t z = (value += 0x9E3779B97F4A7C15ULL);
+				z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+				z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+				z ^= z >> 31;
+				state[i] = static_cast<boost::uint32_t>(z);
+				state[i + 1] = static_cast<boost::uint32_t>(z >> 32);
+			}
+		}
+
+		result_type operator()() {
+			const boost::uint32_t result = Rotl(state[1] * 5, 7) * 9;
+			const boost::uint32_t t = state[1] << 9;
+			state[2] ^= state[0];
+			state[3] ^= state[1];
+			state[1] ^= state[2];
+			state[0] ^= state[3];
+			state[2] ^= t;
+			state[3] = Rotl(state[3], 11);
+			return result;
+		}
+
+		static result_type min() { return min_value; }
+		static result_type max() { return max_value; }
+	};
+
+	typedef Xoshiro128 GeneratorImpl;
+
+	/* Independently seeded streams, so that randomness used by one subsystem
+	   doesn't shift the numbers every other subsystem sees. */
+	enum StreamType {
+		DefaultStream,
+		WaterStream,
+		AIStream,
+		CombatStream,
+		WeatherStream,
+		EventsStream,
+		StreamCount
+	};
 
 	struct Dice {
 		Dice(unsigned int, unsigned int = 1, float = 1.f, float = 0.f);
@@ -45,6 +99,7 @@ namespace Random {
 		int Generate(int, int);
 		int Generate(int);
 		double Generate();
+		int Geometric(int);
 		short Sign();
 		bool GenerateBool();
 		Coordinate ChooseInExtent(const Coordinate& origin, const Coordinate& extent);
@@ -58,9 +113,28 @@ namespace Random {
 	};
 	
 	void Init();
+	//Reseeds every stream from one master seed
+	void Seed(unsigned int);
+	unsigned int MasterSeed();
+	//Derives an unrelated seed for the index'th part of work seeded with 'seed'
+	unsigned int DeriveSeed(unsigned int seed, unsigned int index);
+	Generator& Stream(StreamType);
+
+	/* Makes the functions below draw from the given stream in the current thread until
+	   the scope ends. Threads other than the main one draw from their own stream by default. */
+	class StreamScope {
+		Generator* previous;
+	public:
+		explicit StreamScope(StreamType);
+		//Draws from a generator of the caller's, for work split over threads that has to come out the same
+		explicit StreamScope(Generator&);
+		~StreamScope();
+	};
+
 	int Generate(int, int);
 	int Generate(int);
 	double Generate();
+	int Geometric(int);
 	short Sign();
 	bool GenerateBool();
 	
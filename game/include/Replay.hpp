@@ -0,0 +1,40 @@
+/* Copyright 2010-2011 Ilkka Halila
+This file is part of Goblins' Lot (former Goblin Camp)
+
+Goblin Camp is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Goblin Camp is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
+#pragma once
+
+#include <string>
+#include <libtcod.hpp>
+
+/* Records the random seed of a new game and the keyboard and mouse input of every
+   frame of the main loop, so that the session can be played back exactly.
+   
+   Started with the -record <file> and -replay <file> command line options. Input
+   read by modal dialogs with their own loops is not covered. */
+namespace Replay {
+	bool Record(const std::string&);
+	bool Play(const std::string&);
+	//True when recording or playing back
+	bool Active();
+	bool Playing();
+	
+	//Seed for a new game, read from the replay when playing back
+	unsigned int NewGameSeed();
+	//Marks the start of a main loop frame
+	void Frame();
+	//Record the input read this frame, or replace it with the recorded one when playing back
+	void Key(TCOD_key_t&);
+	void Mouse(TCOD_mouse_t&);
+}
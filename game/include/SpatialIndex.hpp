@@ -0,0 +1,104 @@
+/* Copyright 2010-2011 Ilkka Halila
+This file is part of Goblins' Lot (former Goblin Camp)
+
+Goblin Camp is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Goblin Camp is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
+#pragma once
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+#include "Coordinate.hpp"
+
+/* A set of map positions bucketed into square cells, for nearest-position
+   queries that only look at the cells around the query point instead of at
+   every element.
+
+   Nearest() takes a cost functor, returning the (possibly weighted) distance of
+   a candidate position, or a negative value to reject it. A cost may only be
+   lower than the plain Distance() by at most the 'discount' factor, this is
+   what allows the search to stop once the remaining cells are too far away. */
+class SpatialIndex {
+	int cellSize;
+	Coordinate cells; //Amount of cells in both dimensions
+	std::vector<std::vector<Coordinate> > grid;
+	size_t count;
+
+	inline std::vector<Coordinate>& Cell(const Coordinate& p) {
+		return grid[(p.Y() / cellSize) * cells.X() + p.X() / cellSize];
+	}
+	inline const std::vector<Coordinate>& Cell(int cx, int cy) const {
+		return grid[cy * cells.X() + cx];
+	}
+
+	//Smallest Distance() from p to any position of the cell
+	inline int CellDistance(const Coordinate& p, int cx, int cy) const {
+		int distance = 0;
+		int cell[2] = { cx, cy };
+		for (int d = 0; d < 2; ++d) {
+			int low = cell[d] * cellSize, high = low + cellSize - 1;
+			if (p[d] < low) distance += low - p[d];
+			else if (p[d] > high) distance += p[d] - high;
+		}
+		return distance;
+	}
+
+public:
+	SpatialIndex(int cellSize = 16);
+
+	//Drops all positions and sizes the index for a map of the given extent
+	void Reset(const Coordinate& extent);
+	void Insert(const Coordinate&);
+	void Remove(const Coordinate&);
+	bool Contains(const Coordinate&) const;
+	size_t Size() const;
+	bool Empty() const;
+
+	template <typename CostFunc>
+	Coordinate Nearest(const Coordinate& origin, CostFunc cost, int discount = 1) const {
+		Coordinate nearest = undefined;
+		if (count == 0) return nearest;
+
+		int nearestCost = std::numeric_limits<int>::max();
+		Coordinate center = origin.shrinkExtent(zero, cells * cellSize);
+		int cx = center.X() / cellSize, cy = center.Y() / cellSize;
+		int maxRing = std::max(std::max(cx, cells.X() - 1 - cx), std::max(cy, cells.Y() - 1 - cy));
+
+		for (int ring = 0; ring <= maxRing; ++ring) {
+			//Every cell of this ring is at least this far away from the origin
+			int ringDistance = std::max(0, (ring - 1) * cellSize + 1);
+			if (ringDistance / discount >= nearestCost) break;
+
+			for (int y = cy - ring; y <= cy + ring; ++y) {
+				if (y < 0 || y >= cells.Y()) continue;
+				bool edgeRow = (y == cy - ring || y == cy + ring);
+				for (int x = cx - ring; x <= cx + ring; x += (edgeRow || ring == 0) ? 1 : 2 * ring) {
+					if (x < 0 || x >= cells.X()) continue;
+					if (CellDistance(origin, x, y) / discount >= nearestCost) continue;
+
+					const std::vector<Coordinate>& cell = Cell(x, y);
+					for (std::vector<Coordinate>::const_iterator posi = cell.begin(); posi != cell.end(); ++posi) {
+						if (Distance(origin, *posi) / discount >= nearestCost) continue;
+						int candidateCost = cost(*posi);
+						if (candidateCost >= 0 && candidateCost < nearestCost) {
+							nearestCost = candidateCost;
+							nearest = *posi;
+						}
+					}
+				}
+			}
+		}
+		return nearest;
+	}
+};
@@ -27,8 +27,9 @@ typedef int SpellType;
 class SpellListener;
 
 class SpellPreset {
+	GC_SERIALIZABLE_CLASS
 public:
-	SpellPreset(std::string);
+	SpellPreset(std::string = "");
 	std::string name;
 	std::list<Attack> attacks;
 	bool immaterial;
@@ -39,6 +40,8 @@ public:
 	int graphicsHint;
 };
 
+BOOST_CLASS_VERSION(SpellPreset, 0)
+
 class Spell : public Entity {
 	GC_SERIALIZABLE_CLASS
 	
@@ -68,6 +71,8 @@ public:
 	static std::string SpellTypeToString(SpellType);
 
 	static void LoadPresets(std::string);
+	static void SavePresetCache(OutputArchive&);
+	static void LoadPresetCache(InputArchive&);
 };
 
 BOOST_CLASS_VERSION(Spell, 0)
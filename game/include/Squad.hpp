@@ -20,12 +20,14 @@ along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
 #include <vector>
 
 #include <boost/weak_ptr.hpp>
+#include <boost/shared_ptr.hpp>
 #include <boost/enable_shared_from_this.hpp>
 
 #include "data/Serialization.hpp"
 
 class Coordinate;
 class Entity;
+class GroupPath;
 typedef int ItemCategory;
 
 enum Order {
@@ -46,6 +48,7 @@ class Squad : public boost::enable_shared_from_this<Squad> {
 	std::vector<Order> orders;
 	std::vector<Coordinate> targetCoordinates;
 	std::vector<boost::weak_ptr<Entity> > targetEntities;
+	std::vector<boost::shared_ptr<GroupPath> > groupPaths; //Not saved, members search again after loading
 	int priority;
 	ItemCategory weapon;
 	ItemCategory armor;
@@ -60,6 +63,7 @@ public:
 	void ClearOrders();
 	Coordinate TargetCoordinate(int orderIndex);
 	void AddTargetCoordinate(Coordinate);
+	boost::shared_ptr<GroupPath> SharedPath(int orderIndex);
 	boost::weak_ptr<Entity> TargetEntity(int orderIndex);
 	void AddTargetEntity(boost::weak_ptr<Entity>);
 	int MemberCount();
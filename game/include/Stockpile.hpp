@@ -15,6 +15,8 @@ You should have received a copy of the GNU General Public License
 along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
 #pragma once
 
+#include <vector>
+
 #include "Coordinate.hpp"
 #include "Construction.hpp"
 #include "Container.hpp"
@@ -42,9 +44,21 @@ protected:
 	int capacity;
 	std::map<ItemCategory, int> amount;
 	std::map<ItemCategory, bool> allowed;
-	std::map<Coordinate, bool> reserved;
-	std::map<Coordinate, boost::shared_ptr<Container> > containers;
-	std::map<Coordinate, TCODColor> colors;
+	/* Per-tile state, kept row by row over the bounding box a..b. Tiles inside the box
+	   that don't belong to the pile have no container. */
+	struct Spot {
+		Spot() : reserved(false), growth(0), growthDue(0) {}
+		boost::shared_ptr<Container> container;
+		TCODColor color;
+		bool reserved;
+		int growth, growthDue; //Only used by farm plots, see FarmPlot::ScheduleGrowth
+	};
+	std::vector<Spot> spots;
+	int spotCount; //Spots that have a container
+	Spot* GetSpot(const Coordinate&);
+	Coordinate SpotPosition(size_t index) const;
+	void Reshape(const Coordinate& low, const Coordinate& high);
+	void AddSpot(const Coordinate&, boost::shared_ptr<Container>);
 	std::map<ItemCategory, int> limits;
 	std::map<ItemCategory, int> demand;
 	std::map<ItemCategory, int> lastDemandBalance; //At what amount did we last check container demand?
@@ -40,6 +40,14 @@ enum TileType {
 	TILE_TYPE_COUNT
 };
 
+//The nodes that can be on a tile. Map keeps these apart from the tiles, see MapChunk
+struct TileNodes {
+	boost::shared_ptr<WaterNode> water;
+	boost::shared_ptr<FilthNode> filth;
+	boost::shared_ptr<BloodNode> blood;
+	boost::shared_ptr<FireNode> fire;
+};
+
 class Tile {
 	GC_SERIALIZABLE_CLASS
 	
@@ -53,22 +61,21 @@ class Tile {
 	int moveCost;
 	int construction;
 	bool low, blocksWater;
-	boost::shared_ptr<WaterNode> water;
 	int graphic;
 	TCODColor foreColor, originalForeColor;
 	TCODColor backColor;
 	int natureObject;
 	std::set<int> npcList; //Set of NPC uid's
 	std::set<int> itemList; //Set of Item uid's
-	boost::shared_ptr<FilthNode> filth;
-	boost::shared_ptr<BloodNode> blood;
-	boost::shared_ptr<FireNode> fire;
 	bool marked;
 	int walkedOver, corruption;
 	bool territory;
 	int burnt;
 	Direction flow;
 
+	//Saves from before Map version 3 kept the nodes in the tiles, load() leaves the last tile's here
+	static TileNodes loadedNodes;
+
 public:
 	Tile(TileType = TILEGRASS, int = 1);
 	TileType GetType();
@@ -85,23 +92,15 @@ public:
 	void MoveTo(int);
 	void SetConstruction(int);
 	int GetConstruction() const;
-	boost::weak_ptr<WaterNode> GetWater() const;
-	void SetWater(boost::shared_ptr<WaterNode>);
 	bool IsLow() const;
 	void SetLow(bool);
 	bool BlocksWater() const;
 	void SetBlocksWater(bool);
 	int GetGraphic() const;
 	TCODColor GetForeColor() const;
-	TCODColor GetBackColor() const;
+	TCODColor GetBackColor(BloodNode* blood = 0) const;
 	void SetNatureObject(int);
 	int GetNatureObject() const;
-	boost::weak_ptr<FilthNode> GetFilth() const;
-	void SetFilth(boost::shared_ptr<FilthNode>);
-	boost::weak_ptr<BloodNode> GetBlood() const;
-	void SetBlood(boost::shared_ptr<BloodNode>);
-	boost::weak_ptr<FireNode> GetFire() const;
-	void SetFire(boost::shared_ptr<FireNode>);
 	void Mark();
 	void Unmark();
 	void WalkOver();
@@ -130,6 +129,7 @@ public:
 
 	CacheTile();
 	CacheTile& operator=(const Tile&);
+	void SetNodes(const TileNodes*); //The tile's nodes, or null if there are none
 	int GetMoveCost() const;
 	int GetMoveCost(void*) const;
 };
@@ -0,0 +1,140 @@
+/* Copyright 2010-2011 Ilkka Halila
+This file is part of Goblins' Lot (former Goblin Camp)
+
+Goblin Camp is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Goblin Camp is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <boost/cstdint.hpp>
+#include <boost/serialization/utility.hpp>
+
+#include "data/Serialization.hpp"
+
+/* Hierarchical timer wheel, holds values that become due after a given amount of ticks.
+
+   Level 0 has one slot per tick for the next 256 ticks, every further level has slots
+   256 times as wide. Entries live in the lowest level that can hold them and move down
+   a level each time the wheel reaches their slot, so Advance() only touches entries that
+   are (nearly) due.
+
+   There is no explicit cancellation: whoever handles the due values checks that they
+   still refer to something that exists, and drops them otherwise. */
+template <typename T>
+class TimerWheel {
+	GC_SERIALIZABLE_CLASS
+
+	static const int SlotBits = 8;
+	static const int Slots = 1 << SlotBits;
+	static const int Levels = 4; //Delays up to 2^32 ticks
+
+	typedef std::pair<boost::uint64_t, T> Entry;
+
+	boost::uint64_t now;
+	std::vector<Entry> slots[Levels][Slots];
+	size_t count;
+
+	void Insert(const Entry& entry) {
+		boost::uint64_t delay = entry.first - now;
+		int level = 0;
+		while (level < Levels - 1 && delay >= (boost::uint64_t(1) << (SlotBits * (level + 1)))) ++level;
+		slots[level][(entry.first >> (SlotBits * level)) & (Slots - 1)].push_back(entry);
+	}
+
+public:
+	TimerWheel() : now(0), count(0) {}
+
+	//Makes value due after delay ticks, delay is at least 1
+	void Schedule(unsigned int delay, const T& value) {
+		if (delay < 1) delay = 1;
+		Insert(Entry(now + delay, value));
+		++count;
+	}
+
+	//Moves to the next tick, appending the values that are due to 'due'
+	void Advance(std::vector<T>& due) {
+		++now;
+
+		//Bring down the entries of every level whose slot boundary was just crossed, highest first
+		int level = 1;
+		while (level < Levels && (now & ((boost::uint64_t(1) << (SlotBits * level)) - 1)) == 0) ++level;
+		for (--level; level >= 1; --level) {
+			std::vector<Entry> cascading;
+			cascading.swap(slots[level][(now >> (SlotBits * level)) & (Slots - 1)]);
+			for (typename std::vector<Entry>::const_iterator entry = cascading.begin(); entry != cascading.end(); ++entry) {
+				Insert(*entry);
+			}
+		}
+
+		std::vector<Entry>& slot = slots[0][now & (Slots - 1)];
+		for (typename std::vector<Entry>::const_iterator entry = slot.begin(); entry != slot.end(); ++entry) {
+			due.push_back(entry->second);
+		}
+		count -= slot.size();
+		slot.clear();
+	}
+
+	void Clear() {
+		for (int level = 0; level < Levels; ++level) {
+			for (int slot = 0; slot < Slots; ++slot) slots[level][slot].clear();
+		}
+		count = 0;
+	}
+
+	//Calls f with every pending value
+	template <typename Func>
+	void ForEach(Func f) const {
+		for (int level = 0; level < Levels; ++level) {
+			for (int slot = 0; slot < Slots; ++slot) {
+				for (typename std::vector<Entry>::const_iterator entry = slots[level][slot].begin(); entry != slots[level][slot].end(); ++entry) {
+					f(entry->second);
+				}
+			}
+		}
+	}
+
+	boost::uint64_t Now() const { return now; }
+	size_t Size() const { return count; }
+	bool Empty() const { return count == 0; }
+};
+
+template <typename T>
+void TimerWheel<T>::save(OutputArchive& ar, const unsigned int version) const {
+	ar & now;
+	boost::uint64_t entries = count;
+	ar & entries;
+	for (int level = 0; level < Levels; ++level) {
+		for (int slot = 0; slot < Slots; ++slot) {
+			for (typename std::vector<Entry>::const_iterator entry = slots[level][slot].begin(); entry != slots[level][slot].end(); ++entry) {
+				ar & entry->first;
+				ar & entry->second;
+			}
+		}
+	}
+}
+
+template <typename T>
+void TimerWheel<T>::load(InputArchive& ar, const unsigned int version) {
+	Clear();
+	ar & now;
+	boost::uint64_t entries;
+	ar & entries;
+	for (boost::uint64_t i = 0; i < entries; ++i) {
+		Entry entry;
+		ar & entry.first;
+		ar & entry.second;
+		Insert(entry);
+	}
+	count = static_cast<size_t>(entries);
+}
@@ -34,6 +34,9 @@ class WaterNode : public boost::enable_shared_from_this<WaterNode> {
 	int timeFromRiverBed;
 	int filth;
 	bool coastal;
+	bool drinkable;
+	bool updateScheduled; //Has a pending timer in Game::waterTimers, not saved
+	void UpdateDrinkable();
 public:
 	WaterNode(const Coordinate& pos = undefined, int depth = 0, int time = 0);
 	~WaterNode();
@@ -45,7 +48,8 @@ public:
 	void X(int);
 	void Y(int);
 
-	bool Update();
+	//Dormant water updates seldom, 'steps' is how many regular updates this one stands for
+	bool Update(int steps = 1);
 	void MakeInert();
 	void DeInert();
 	int Depth();
@@ -56,6 +60,9 @@ public:
 	int GetGraphic();
 	TCODColor GetColor();
 	bool IsCoastal();
+	bool IsDrinkable() const;
+	bool UpdateScheduled() const;
+	void UpdateScheduled(bool);
 };
 
 BOOST_CLASS_VERSION(WaterNode, 0)
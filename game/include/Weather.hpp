@@ -21,6 +21,7 @@ along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
 #include "data/Serialization.hpp"
 
 class Map;
+class MapChunk;
 
 enum WeatherType {
 	NORMALWEATHER,
@@ -40,7 +41,14 @@ class Weather {
 	int changePosition;
 	int currentTemperature;
 	int currentSeason;
+	/* Dormant chunks don't get the random tile changes, instead the expected amount of changes
+	   per tile is tracked and applied in one go once they wake up. */
+	int phase; //Goes up when the tile changes turn from snow to grass or back
+	double exposure; //Expected changes per tile so far in this phase
+	double previousExposure; //The same for the whole previous phase
 	void SeasonChange();
+	void ChangeTiles(const std::vector<Coordinate>&, int temperature);
+	void CatchUpTiles(const Coordinate& origin, double missed, int temperature);
 
 public:
 	Weather(Map* map = 0);
@@ -51,6 +59,10 @@ public:
 	void Update();
 	void ChangeWeather(WeatherType);
 	void ApplySeasonalEffects();
+	//Applies the changes a dormant chunk at origin missed
+	void CatchUp(const Coordinate& origin, MapChunk&);
+	//Marks a chunk that is going dormant as up to date
+	void Synchronize(const Coordinate& origin, MapChunk&);
 };
 
-BOOST_CLASS_VERSION(Weather, 0)
+BOOST_CLASS_VERSION(Weather, 1)
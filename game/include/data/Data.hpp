@@ -45,6 +45,7 @@ namespace Data {
 	unsigned CountSavedGames();
 	bool LoadGame(const std::string&);
 	bool SaveGame(const std::string&, bool=true);
+	bool AutoSave(const std::string&);
 	
 	// font, config
 	void LoadConfig();
@@ -17,6 +17,8 @@ along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
 
 // Data refactoring: mods.
 #include <list>
+#include <vector>
+#include <boost/filesystem.hpp>
 #include "tileRenderer/TileSetLoader.hpp"
 
 namespace Mods {
@@ -31,4 +33,5 @@ namespace Mods {
 	const std::list<TilesetModMetadata>& GetAvailableTilesetMods();
 	
 	void Load();
+	std::vector<boost::filesystem::path> PresetFiles(const std::vector<boost::filesystem::path>&);
 }
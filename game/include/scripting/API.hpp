@@ -20,6 +20,8 @@ along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
 namespace Script {
 	void ExposeAPI();
 	void AppendListener(PyObject*);
+	// True if any listener handles given event method. Does not need the GIL.
+	bool HasListeners(const char*);
 	void InvokeListeners(const char*, const char*, ...);
 	void InvokeListeners(const char*, PyObject* = NULL);
 	void ReleaseListeners();
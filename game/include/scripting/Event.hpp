@@ -31,6 +31,11 @@ namespace Script {
 		void BuildingDestroyed(boost::weak_ptr<Construction>, int, int);
 		void ItemCreated(boost::weak_ptr<Item>, int, int);
 		void TierChanged(int, const std::string&);
+
+		// BuildingCreated, BuildingDestroyed and ItemCreated are only queued when raised,
+		// and delivered in one go by this function (the caller must hold the GIL).
+		// Other events flush the queue before being delivered themselves.
+		void DispatchQueued();
 		/*void ItemDestroyed(Item*, int, int);
 		void NPCSpawned(NPC*, Construction*, int, int);
 		void NPCKilled(NPC*, NPC*, int, int);*/
@@ -42,6 +42,7 @@ public:
 	~TerrainSprite();
 
 	bool Exists() const;
+	bool IsAnimated() const;
 
 	void Draw(int screenX, int screenY, Coordinate coords, const PermutationTable& permTable, float height, Sprite::ConnectedFunction terrainConnected) const;
 	void DrawCorrupted(int screenX, int screenY, Coordinate coords, const PermutationTable& permTable, float height, Sprite::ConnectedFunction terrainConnected, Sprite::ConnectedFunction corruptConnected) const;
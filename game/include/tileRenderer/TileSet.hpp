@@ -51,6 +51,8 @@ public:
 	std::string GetDescription() const;
 
 	bool IsIceSupported() const;
+	// Whether anything DrawTerrain draws changes from frame to frame
+	bool IsTerrainAnimated() const;
 
 	void DrawCursor(int screenX, int screenY, CursorType type, int cursorHint, bool placeable) const;
 	void DrawMarkedOverlay(int screenX, int screenY) const;
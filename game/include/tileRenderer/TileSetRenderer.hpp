@@ -57,6 +57,8 @@ protected:
 	virtual void DrawNullTile(int screenX, int screenY) = 0;
 
 	virtual bool TilesetChanged();
+	// Draws the terrain of every tile in view at once, returns false to have DrawTerrain called for each of them instead
+	virtual bool DrawCachedTerrain();
 
 	TCODConsole * tcodConsole;
 	PermutationTable permutationTable;
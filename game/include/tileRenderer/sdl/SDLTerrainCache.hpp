@@ -0,0 +1,71 @@
+/* Copyright 2010-2011 Ilkka Halila
+This file is part of Goblins' Lot (former Goblin Camp)
+
+Goblin Camp is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Goblin Camp is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
+#pragma once
+
+#include <map>
+#include <vector>
+#include <SDL.h>
+#include <boost/cstdint.hpp>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include "Coordinate.hpp"
+
+/****************/
+// SDLTerrainCache
+// Keeps the static terrain layer of the map pre-composited in off-screen surfaces of
+// ChunkSize x ChunkSize tiles, so that a frame only has to blit them instead of drawing
+// every terrain, water and blood sprite again.
+// A chunk is redrawn when the signature of one of its tiles, or of a tile bordering it
+// (connection maps look at the neighbours), differs from the one it was drawn with.
+/****************/
+class SDLTerrainCache
+{
+public:
+	static const int ChunkSize = 16;
+
+	// Everything about a tile inside the map that its terrain layer depends on
+	typedef boost::function<boost::uint64_t (const Coordinate&)> SignatureFunction;
+	// Draws the terrain layer of a tile with its top left corner at the given pixel of a surface
+	typedef boost::function<void (SDL_Surface*, int, int, const Coordinate&)> DrawFunction;
+
+	SDLTerrainCache();
+
+	// Drops every chunk if the map, tile size or pixel format changed
+	void Reset(const Coordinate& mapExtent, int tileWidth, int tileHeight, const SDL_PixelFormat* format);
+	void Clear();
+
+	// Blits the terrain of the tiles start .. start + extent onto target, with the start tile's top left
+	// corner at (originX, originY), redrawing the chunks that went stale. Chunks that weren't needed
+	// for this frame are released.
+	void Draw(SDL_Surface* target, int originX, int originY, const Coordinate& start, const Coordinate& extent,
+		const SignatureFunction& signature, const DrawFunction& draw);
+
+private:
+	struct Chunk {
+		boost::shared_ptr<SDL_Surface> surface;
+		std::vector<boost::uint64_t> signatures; //(ChunkSize + 2)^2, including the bordering tiles
+		bool used;
+	};
+
+	std::map<int, Chunk> chunks;
+	Coordinate mapExtent;
+	int tileWidth, tileHeight;
+	Uint32 pixelFormat;
+	int bitsPerPixel;
+	std::vector<boost::uint64_t> current;
+
+	bool Refresh(Chunk&, const Coordinate& origin, const SignatureFunction&, const DrawFunction&);
+};
@@ -17,6 +17,7 @@ along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
 #pragma once
 
 #include "tileRenderer/TileSetRenderer.hpp"
+#include "tileRenderer/sdl/SDLTerrainCache.hpp"
 #include <SDL.h>
 
 class SDLTilesetRenderer : public TilesetRenderer, public ITCODSDLRenderer
@@ -38,8 +39,16 @@ protected:
 	void PreDrawMap(int viewportX, int viewportY, int viewportW, int viewportH);
 	void PostDrawMap();
 	void DrawNullTile(int screenX, int screenY);
+	bool TilesetChanged();
+	bool DrawCachedTerrain();
 private:
 	boost::shared_ptr<SDL_Surface> mapSurface;
+	SDL_Surface * target; // Where sprites are drawn, mapSurface unless a terrain chunk is being cached
+	SDLTerrainCache terrainCache;
+	bool terrainCacheable;
+
+	boost::uint64_t TerrainSignature(const Coordinate& pos) const;
+	void DrawTerrainTo(SDL_Surface * surface, int pixelX, int pixelY, const Coordinate& pos);
 
 	SDL_Rect CalcDest(int screenX, int screenY) const {
 		SDL_Rect dstRect = {
@@ -51,3 +60,7 @@ private:
 		return dstRect;
 	}
 };
+
+// Makes the key colored pixels in the top left width x height area of a locked 32-bit surface
+// transparent, and the black ones half transparent, so the console can be blitted over the map.
+void KeyTranslucentSurface(SDL_Surface *surface, int width, int height, Uint32 keyColor);
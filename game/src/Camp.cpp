@@ -248,7 +248,7 @@ void Camp::UpdateWaterJobs() {
 		//The amount and priority of water pouring jobs depends on if there's fire anywhere
 		if (Game::Inst()->fireList.size() > 0) {
 			for (int i = 1; static_cast<int>(menialWaterJobs.size()) < Game::Inst()->GoblinCount() && i <= 10; ++i) {
-				boost::shared_ptr<Job> waterJob(new Job("Pour water", VERYHIGH, 0, true));
+				boost::shared_ptr<Job> waterJob(Job::Create("Pour water", VERYHIGH, 0, true));
 				Coordinate location = *boost::next(waterZones.begin(), Random::Generate(waterZones.size()-1));
 				Job::CreatePourWaterJob(waterJob, location);
 				if (waterJob) {
@@ -258,7 +258,7 @@ void Camp::UpdateWaterJobs() {
 			}
 
 			for (int i = 1; static_cast<int>(expertWaterJobs.size()) < Game::Inst()->OrcCount() && i <= 10; ++i) {
-				boost::shared_ptr<Job> waterJob(new Job("Pour water", VERYHIGH, 0, false));
+				boost::shared_ptr<Job> waterJob(Job::Create("Pour water", VERYHIGH, 0, false));
 				Coordinate location = *boost::next(waterZones.begin(), Random::Generate(waterZones.size()-1));
 				Job::CreatePourWaterJob(waterJob, location);
 				if (waterJob) {
@@ -269,7 +269,7 @@ void Camp::UpdateWaterJobs() {
 
 		} else {
 			if (menialWaterJobs.size() < 5) {
-				boost::shared_ptr<Job> waterJob(new Job("Pour water", LOW, 0, true));
+				boost::shared_ptr<Job> waterJob(Job::Create("Pour water", LOW, 0, true));
 				Coordinate location = *boost::next(waterZones.begin(), Random::Generate(waterZones.size()-1));
 				Job::CreatePourWaterJob(waterJob, location);
 				if (waterJob) {
@@ -33,6 +33,8 @@ along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
 #include <boost/serialization/vector.hpp>
 #include <boost/serialization/deque.hpp>
 #include <boost/serialization/list.hpp>
+#include <boost/serialization/set.hpp>
+#include <boost/serialization/map.hpp>
 
 #include "Random.hpp"
 #include "Construction.hpp"
@@ -296,7 +298,7 @@ int Construction::Use() {
 					break;
 				}
 			}
-			if (Item::Presets[jobList[0]].categories.find(Item::StringToItemCategory("charcoal")) != Item::Presets[jobList[0]].categories.end())
+			if (Item::Presets[jobList[0]].IsCategory(Item::StringToItemCategory("charcoal")))
 				smoke = 2;
 		}
 
@@ -749,12 +751,12 @@ bool Construction::SpawnProductionJob() {
 		}
 
 
-		boost::shared_ptr<Job> newProductionJob(new Job("Produce "+Item::ItemTypeToString(jobList.front()), MED, 0, false));
+		boost::shared_ptr<Job> newProductionJob(Job::Create("Produce "+Item::ItemTypeToString(jobList.front()), MED, 0, false));
 		newProductionJob->ConnectToEntity(shared_from_this());
 		newProductionJob->ReserveEntity(shared_from_this());
 
 		for (int compi = 0; compi < (signed int)Item::Components(jobList.front()).size(); ++compi) {
-			boost::shared_ptr<Job> newPickupJob(new Job("Pickup " + Item::ItemCategoryToString(Item::Components(jobList.front(), compi)) + " for " + Presets[Type()].name));
+			boost::shared_ptr<Job> newPickupJob(Job::Create("Pickup " + Item::ItemCategoryToString(Item::Components(jobList.front(), compi)) + " for " + Presets[Type()].name));
 			newPickupJob->tasks.push_back(Task(FIND, Center(), boost::shared_ptr<Entity>(), Item::Components(jobList.front(), compi), APPLYMINIMUMS | EMPTY));
 			newPickupJob->tasks.push_back(Task(MOVE));
 			newPickupJob->tasks.push_back(Task(TAKE));
@@ -868,7 +870,7 @@ void Construction::Dismantle(const Coordinate&) {
 		}
 
 		if (built) {
-			boost::shared_ptr<Job> dismantleJob(new Job((boost::format("Dismantle %s") % name).str(), HIGH, 0, false));
+			boost::shared_ptr<Job> dismantleJob(Job::Create((boost::format("Dismantle %s") % name).str(), HIGH, 0, false));
 			dismantleJob->ConnectToEntity(shared_from_this());
 			dismantleJob->Attempts(3);
 			dismantleJob->tasks.push_back(Task(MOVEADJACENT, Position(), shared_from_this()));
@@ -967,6 +969,93 @@ ConstructionPreset::ConstructionPreset() :
 	for (int i = 0; i < TAGCOUNT; ++i) { tags[i] = false; }
 }
 
+void ConstructionPreset::save(OutputArchive& ar, const unsigned int version) const {
+	ar & maxCondition;
+	ar & graphic;
+	ar & walkable;
+	ar & materials;
+	ar & producer;
+	ar & products;
+	ar & name;
+	ar & blueprint;
+	ar & tags;
+	ar & productionSpot;
+	ar & dynamic;
+	ar & spawnCreaturesTag;
+	ar & spawnFrequency;
+	ar & category;
+	ar & placementType;
+	ar & blocksLight;
+	ar & permanent;
+	ar & color.r;
+	ar & color.g;
+	ar & color.b;
+	ar & tileReqs;
+	ar & tier;
+	ar & description;
+	ar & fallbackGraphicsSet;
+	ar & graphicsHint;
+	ar & chimney;
+	ar & trapAttack;
+	ar & trapReloadItem;
+	ar & moveSpeedModifier;
+	ar & passiveStatusEffects;
+}
+
+void ConstructionPreset::load(InputArchive& ar, const unsigned int version) {
+	ar & maxCondition;
+	ar & graphic;
+	ar & walkable;
+	ar & materials;
+	ar & producer;
+	ar & products;
+	ar & name;
+	ar & blueprint;
+	ar & tags;
+	ar & productionSpot;
+	ar & dynamic;
+	ar & spawnCreaturesTag;
+	ar & spawnFrequency;
+	ar & category;
+	ar & placementType;
+	ar & blocksLight;
+	ar & permanent;
+	ar & color.r;
+	ar & color.g;
+	ar & color.b;
+	ar & tileReqs;
+	ar & tier;
+	ar & description;
+	ar & fallbackGraphicsSet;
+	ar & graphicsHint;
+	ar & chimney;
+	ar & trapAttack;
+	ar & trapReloadItem;
+	ar & moveSpeedModifier;
+	ar & passiveStatusEffects;
+}
+
+//The construction tables as they are after loading every mod, see PresetCache
+void Construction::SavePresetCache(OutputArchive& ar) {
+	ar & Presets;
+	ar & Categories;
+	ar & AllowedAmount;
+	std::map<std::string, ConstructionType> names(constructionNames.begin(), constructionNames.end());
+	ar & names;
+}
+
+void Construction::LoadPresetCache(InputArchive& ar) {
+	Presets.clear();
+	Categories.clear();
+	AllowedAmount.clear();
+	ar & Presets;
+	ar & Categories;
+	ar & AllowedAmount;
+	std::map<std::string, ConstructionType> names;
+	ar & names;
+	constructionNames = boost::unordered_map<std::string, ConstructionType>(names.begin(), names.end());
+}
+
 void Construction::AcceptVisitor(ConstructionVisitor& visitor) {
 	visitor.Visit(this);
 }
@@ -983,7 +1072,7 @@ void Construction::SpawnRepairJob() {
 		boost::shared_ptr<Item> repairItem = Game::Inst()->FindItemByCategoryFromStockpiles(*boost::next(Construction::Presets[type].materials.begin(), Random::ChooseIndex(Construction::Presets[type].materials)),
 			Position()).lock();
 		if (repairItem) {
-			boost::shared_ptr<Job> repJob(new Job("Repair " + name));
+			boost::shared_ptr<Job> repJob(Job::Create("Repair " + name));
 			repJob->ReserveEntity(repairItem);
 			repJob->tasks.push_back(Task(MOVE, repairItem->Position()));
 			repJob->tasks.push_back(Task(TAKE, repairItem->Position(), repairItem));
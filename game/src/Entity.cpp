@@ -78,6 +78,33 @@ void Entity::SetVelocity(int value) { velocity = value; }
 Coordinate Entity::GetVelocityTarget() { return velocityTarget; }
 void Entity::SetVelocityTarget(Coordinate value) { velocityTarget = value; }
 
+std::vector<std::vector<FlightPath>*> FlightPathList::pool;
+
+void FlightPathList::push_back(const FlightPath& step) {
+	if (!steps) {
+		if (pool.empty()) {
+			steps = new std::vector<FlightPath>();
+		} else {
+			steps = pool.back();
+			pool.pop_back();
+		}
+	}
+	steps->push_back(step);
+}
+
+void FlightPathList::pop_back() {
+	steps->pop_back();
+	if (steps->empty()) clear();
+}
+
+void FlightPathList::clear() {
+	if (steps) {
+		steps->clear();
+		pool.push_back(steps);
+		steps = 0;
+	}
+}
+
 int Entity::GetHeight() const { return flightPath.size() ? flightPath.back().height : 0; }
 
 void Entity::CalculateFlightPath(Coordinate target, int speed, int initialHeight) {
@@ -94,22 +121,14 @@ void Entity::CalculateFlightPath(Coordinate target, int speed, int initialHeight
 	} while (!TCODLine::step(p.Xptr(), p.Yptr()));
 
 	if (flightPath.size() > 0) {
-		int h = 0;
 		int hAdd = std::max(1, 50 / speed); /* The lower the speed, the higher the entity has to arch in order
 							   for it to fly the distance */
 		
-		std::list<FlightPath>::iterator begIt = flightPath.begin();
-		std::list<FlightPath>::iterator endIt = flightPath.end();
-		--endIt;
-
-		while (begIt->height == -1 && endIt->height == -1) {
-			begIt->height = h;
-			endIt->height = std::max(initialHeight, h);
-			h += hAdd;
-			// Preventing iterator problems
-			if (begIt != flightPath.end()) ++begIt;
-			if (endIt != flightPath.begin()) --endIt;
-			if (begIt == flightPath.end() || endIt == flightPath.end()) break;
+		//Rise from both ends towards the middle, the launching end starts at initialHeight
+		const int last = flightPath.size() - 1;
+		for (int i = 0; i <= last; ++i) {
+			if (i < last - i) flightPath[i].height = i * hAdd;
+			else flightPath[i].height = std::max(initialHeight, (last - i) * hAdd);
 		}
 		flightPath.pop_back(); //Last coordinate is the entity's coordinate
 	}
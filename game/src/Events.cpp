@@ -30,6 +30,7 @@ along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
 #include "StockManager.hpp"
 #include "data/Config.hpp"
 #include "Faction.hpp"
+#include "GroupPath.hpp"
 
 Events::Events(Map* vmap) :
 	map(vmap),
@@ -51,6 +52,7 @@ Events::Events(Map* vmap) :
 }
 
 void Events::Update(bool safe) {
+	Random::StreamScope eventsStream(Random::EventsStream);
 	if (!safe) {
 		++timeSinceHostileSpawn;
 		if (Random::Generate(UPDATES_PER_SECOND * 60 * 15 - 1) == 0 || timeSinceHostileSpawn > (UPDATES_PER_SECOND * 60 * 25)) {
@@ -149,7 +151,12 @@ void Events::SpawnHostileMonsters() {
 		Coordinate a, b;
 		GenerateEdgeCoordinates(map, a, b);
 
-		Game::Inst()->CreateNPCs(hostileSpawnCount, monsterType, a, b);
+		std::vector<int> uids = Game::Inst()->CreateNPCs(hostileSpawnCount, monsterType, a, b);
+		//They come in together, one route into the camp does for all of them
+		boost::shared_ptr<GroupPath> raid(new GroupPath());
+		for (std::vector<int>::iterator uidi = uids.begin(); uidi != uids.end(); ++uidi) {
+			if (boost::shared_ptr<NPC> raider = Game::Inst()->GetNPC(*uidi)) raider->JoinGroupPath(raid);
+		}
 		Announce::Inst()->AddMsg(msg, GCampColor::red, Coordinate((a.X() + b.X()) / 2, (a.Y() + b.Y()) / 2));
 		timeSinceHostileSpawn = 0;
 		if (Config::GetCVar<bool>("pauseOnDanger")) 
@@ -369,10 +376,11 @@ void Events::SpawnMigratingAnimals() {
 			return;
 		}
 		
-		// Create jobs for the migration
+		// Create jobs for the migration, the herd shares one route across the map
+		boost::shared_ptr<GroupPath> migration(new GroupPath());
 		for(std::vector<NPC*>::iterator mgrnt = migrants.begin();
 			mgrnt != migrants.end(); mgrnt++) {
-			boost::shared_ptr<Job> migrateJob(new Job("Migrate"));
+			boost::shared_ptr<Job> migrateJob(Job::Create("Migrate"));
 			
 			// This is so they don't all disapear into one spot.
 			int fx, fy;
@@ -386,6 +394,7 @@ void Events::SpawnMigratingAnimals() {
 			
 			migrateJob->tasks.push_back(Task(MOVENEAR, Coordinate(fx, fy)));
 			migrateJob->tasks.push_back(Task(FLEEMAP));
+			(*mgrnt)->JoinGroupPath(migration);
 			(*mgrnt)->StartJob(migrateJob);
 		}
 
@@ -26,6 +26,7 @@ along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
 #include <boost/serialization/list.hpp>
 #include <boost/serialization/map.hpp>
 #include <boost/serialization/weak_ptr.hpp>
+#include <boost/serialization/shared_ptr.hpp>
 #include <boost/serialization/vector.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/algorithm/string.hpp>
@@ -201,7 +202,7 @@ namespace {
 bool Faction::FindJob(boost::shared_ptr<NPC> npc) {
 	
 	if (maxActiveTime >= 0 && activeTime >= maxActiveTime) {
-		boost::shared_ptr<Job> fleeJob(new Job("Leave"));
+		boost::shared_ptr<Job> fleeJob(Job::Create("Leave"));
 		fleeJob->internal = true;
 		fleeJob->tasks.push_back(Task(CALMDOWN));
 		fleeJob->tasks.push_back(Task(FLEEMAP));
@@ -215,7 +216,7 @@ bool Faction::FindJob(boost::shared_ptr<NPC> npc) {
 		switch (goals[currentGoal]) {
 		case FACTIONDESTROY: 
 			{
-				boost::shared_ptr<Job> destroyJob(new Job("Destroy building"));
+				boost::shared_ptr<Job> destroyJob(Job::Create("Destroy building"));
 				if (GenerateDestroyJob(npc->map, destroyJob, npc) || GenerateKillJob(destroyJob)) {
 					npc->StartJob(destroyJob);
 					return true;
@@ -225,7 +226,7 @@ bool Faction::FindJob(boost::shared_ptr<NPC> npc) {
 
 		case FACTIONKILL:
 			{
-				boost::shared_ptr<Job> attackJob(new Job("Attack settlement"));
+				boost::shared_ptr<Job> attackJob(Job::Create("Attack settlement"));
 				if (GenerateKillJob(attackJob)) {
 					npc->StartJob(attackJob);
 					return true;
@@ -235,7 +236,7 @@ bool Faction::FindJob(boost::shared_ptr<NPC> npc) {
 
 		case FACTIONSTEAL:
 			if (currentGoal < static_cast<int>(goalSpecifiers.size()) && goalSpecifiers[currentGoal] >= 0) {
-				boost::shared_ptr<Job> stealJob(new Job("Steal "+Item::ItemCategoryToString(goalSpecifiers[currentGoal])));
+				boost::shared_ptr<Job> stealJob(Job::Create("Steal "+Item::ItemCategoryToString(goalSpecifiers[currentGoal])));
 				boost::weak_ptr<Item> item = Game::Inst()->FindItemByCategoryFromStockpiles(goalSpecifiers[currentGoal], npc->Position());
 				if (item.lock()) {
 					if (GenerateStealJob(stealJob, item.lock())) {
@@ -250,7 +251,7 @@ bool Faction::FindJob(boost::shared_ptr<NPC> npc) {
 
 		case FACTIONPATROL:
 			{
-				boost::shared_ptr<Job> patrolJob(new Job("Patrol"));
+				boost::shared_ptr<Job> patrolJob(Job::Create("Patrol"));
 				patrolJob->internal = true;
 				Coordinate location = undefined;
 				if (IsFriendsWith(PLAYERFACTION)) {
@@ -398,6 +399,17 @@ void Faction::LoadPresets(std::string filename) {
 	}
 }
 
+//The factions as they are after loading every mod, see PresetCache
+void Faction::SavePresetCache(OutputArchive& ar) {
+	ar & factions;
+}
+
+void Faction::LoadPresetCache(InputArchive& ar) {
+	factions.clear();
+	ar & factions;
+	InitAfterLoad();
+}
+
 FactionGoal Faction::StringToFactionGoal(std::string goal) {
 	if (boost::iequals(goal, "destroy")) {
 		return FACTIONDESTROY;
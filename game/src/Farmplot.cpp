@@ -34,8 +34,7 @@ along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
 #include "Color.hpp"
 
 FarmPlot::FarmPlot(ConstructionType type, int symbol, Coordinate target) : Stockpile(type, symbol, target),
-	tilled(false),
-	growth(std::map<Coordinate, int>())
+	tilled(false)
 {
 	//Farmplots are a form of stockpile, disallow all items so they don't get stored here
 	for (int i = 0; i < Game::ItemCatCount; ++i) {
@@ -44,7 +43,7 @@ FarmPlot::FarmPlot(ConstructionType type, int symbol, Coordinate target) : Stock
 
 	//Allow all discovered seeds
 	for (int i = 0; i < Game::ItemTypeCount; ++i) {
-		if (Item::Presets[i].categories.find(Item::StringToItemCategory("Seed")) != Item::Presets[i].categories.end()) {
+		if (Item::Presets[i].IsCategory(Item::StringToItemCategory("Seed"))) {
 			if (StockManager::Inst()->TypeQuantity((ItemType)i) >= 0)
 				allowedSeeds.insert(std::pair<ItemType,bool>(i, false));
 		}
@@ -65,8 +64,9 @@ void FarmPlot::Draw(Coordinate upleft, TCODConsole* console) {
 						console->setCharForeground(screenx, screeny, GCampColor::darkAmber);
 						console->setChar(screenx, screeny, (graphic[1]));
 
-						if (!containers[p]->empty()) {
-							boost::weak_ptr<Item> item = containers[p]->GetFirstItem();
+						Spot* spot = GetSpot(p);
+						if (spot && spot->container && !spot->container->empty()) {
+							boost::weak_ptr<Item> item = spot->container->GetFirstItem();
 							if (item.lock()) {
 								console->putCharEx(screenx, screeny, item.lock()->GetGraphic(), item.lock()->Color(), GCampColor::black);
 							}
@@ -81,39 +81,63 @@ void FarmPlot::Draw(Coordinate upleft, TCODConsole* console) {
 	}
 }
 
+/* A plant gets a one in five chance to change stage on every tick once its tile has grown for
+   more than two months, so instead of counting and rolling every tick only the tiles whose
+   successful roll is due are looked at. */
 void FarmPlot::Update() {
 	if (!tilled) graphic[1] = 176;
-	for (std::map<Coordinate, boost::shared_ptr<Container> >::iterator containerIt = containers.begin(); containerIt != containers.end(); ++containerIt) {
-		++growth[containerIt->first];
-		//Normal plants ought to grow seed -> young plant -> mature plant -> fruits, which means 3
-		//growths before giving fruit. 3 * 2 months means 6 months from seed to fruits
-		if (!containerIt->second->empty() && growth[containerIt->first] > MONTH_LENGTH * 2 && Random::Generate(4) == 0) {
-			boost::weak_ptr<OrganicItem> plant(boost::static_pointer_cast<OrganicItem>(containerIt->second->GetFirstItem().lock()));
-			if (plant.lock() && !plant.lock()->Reserved()) {
-				if (Random::Generate(9) == 0) { //Chance for the plant to die
-					containerIt->second->RemoveItem(plant);
-					Game::Inst()->CreateItem(plant.lock()->Position(), Item::StringToItemType("Dead plant"), true);
-					Game::Inst()->RemoveItem(plant);
-					growth[containerIt->first] = 0;
-				} else {
-					if (plant.lock()->Growth() > -1) { //Plant is stil growing
-						int newPlant = Game::Inst()->CreateItem(plant.lock()->Position(), plant.lock()->Growth());
-						containerIt->second->RemoveItem(plant);
-						containerIt->second->AddItem(Game::Inst()->GetItem(newPlant));
-						Game::Inst()->RemoveItem(plant);
-						growth[containerIt->first] = 0;
-					} else { //Plant has grown to full maturity, and should be harvested
-						boost::shared_ptr<Job> harvestJob(new Job("Harvest", HIGH, 0, true));
-						harvestJob->ReserveEntity(plant);
-						harvestJob->tasks.push_back(Task(MOVE, plant.lock()->Position()));
-						harvestJob->tasks.push_back(Task(TAKE, plant.lock()->Position(), plant));
-						harvestJob->tasks.push_back(Task(HARVEST, plant.lock()->Position(), plant));
-						JobManager::Inst()->AddJob(harvestJob);
-						growth[containerIt->first] = 0;
-					}
-				}
-			}
+
+	std::vector<Coordinate> due;
+	growthTimers.Advance(due);
+	for (std::vector<Coordinate>::iterator duei = due.begin(); duei != due.end(); ++duei) {
+		Spot* spot = GetSpot(*duei);
+		//Skip tiles that were dropped or rescheduled since
+		if (!spot || spot->growthDue != GrowthClock() || !spot->container || spot->container->empty()) continue;
+
+		boost::shared_ptr<Container> container = spot->container;
+		boost::shared_ptr<OrganicItem> plant = boost::dynamic_pointer_cast<OrganicItem>(container->GetFirstItem().lock());
+		if (!plant) continue;
+		if (plant->Reserved()) { //Keep rolling until whoever reserved it is done
+			ScheduleGrowth(*duei);
+			continue;
 		}
+
+		spot->growth = GrowthClock();
+		if (Random::Generate(9) == 0) { //Chance for the plant to die
+			container->RemoveItem(plant);
+			Game::Inst()->CreateItem(plant->Position(), Item::StringToItemType("Dead plant"), true);
+			Game::Inst()->RemoveItem(plant);
+		} else if (plant->Growth() > -1) { //Plant is stil growing
+			container->RemoveItem(plant);
+			plant->Grow();
+			container->AddItem(plant); //Reschedules through ItemAdded
+		} else { //Plant has grown to full maturity, and should be harvested
+			boost::shared_ptr<Job> harvestJob(Job::Create("Harvest", HIGH, 0, true));
+			harvestJob->ReserveEntity(plant);
+			harvestJob->tasks.push_back(Task(MOVE, plant->Position()));
+			harvestJob->tasks.push_back(Task(TAKE, plant->Position(), plant));
+			harvestJob->tasks.push_back(Task(HARVEST, plant->Position(), plant));
+			JobManager::Inst()->AddJob(harvestJob);
+			ScheduleGrowth(*duei);
+		}
+	}
+}
+
+int FarmPlot::GrowthClock() const { return static_cast<int>(growthTimers.Now()); }
+
+//Spot::growth is the clock time the tile started growing at, growthDue when it next changes
+void FarmPlot::ScheduleGrowth(const Coordinate& p) {
+	if (Spot* spot = GetSpot(p)) {
+		spot->growthDue = std::max(GrowthClock(), spot->growth + MONTH_LENGTH * 2) + Random::Geometric(5);
+		growthTimers.Schedule(spot->growthDue - GrowthClock(), p);
+	}
+}
+
+void FarmPlot::ItemAdded(boost::weak_ptr<Item> witem) {
+	Stockpile::ItemAdded(witem);
+	if (boost::shared_ptr<Item> item = witem.lock()) {
+		Spot* spot = GetSpot(item->Position());
+		if (spot && spot->container && item->ContainedIn().lock() == spot->container) ScheduleGrowth(item->Position());
 	}
 }
 
@@ -125,26 +149,28 @@ int FarmPlot::Use() {
 		progress = 0;
 
 		bool seedsLeft = true;
-		std::map<Coordinate, boost::shared_ptr<Container> >::iterator containerIt = containers.begin();
-		while (seedsLeft && containerIt != containers.end()) {
-			while (!containerIt->second->empty() || reserved[containerIt->first]) {
-				++containerIt;
-				if (containerIt == containers.end()) return 100;
+		size_t index = 0;
+		while (seedsLeft && index < spots.size()) {
+			while (!spots[index].container || !spots[index].container->empty() || spots[index].reserved) {
+				++index;
+				if (index == spots.size()) return 100;
 			}
 			seedsLeft = false;
-			if (containerIt->first.X() >= 0 && containerIt->first.Y() >= 0 && containerIt->second) {
+			Coordinate spotPos = SpotPosition(index);
+			boost::shared_ptr<Container> container = spots[index].container;
+			if (spotPos.X() >= 0 && spotPos.Y() >= 0) {
 				for (std::map<ItemType, bool>::iterator seedi = allowedSeeds.begin(); seedi != allowedSeeds.end(); ++seedi) {
-					growth[containerIt->first] = -(MONTH_LENGTH / 2) + Random::Generate(MONTH_LENGTH - 1);
+					spots[index].growth = GrowthClock() - (-(MONTH_LENGTH / 2) + Random::Generate(MONTH_LENGTH - 1));
 					if (seedi->second) {
 						boost::weak_ptr<Item> seed = Game::Inst()->FindItemByTypeFromStockpiles(seedi->first, Center());
 						if (seed.lock()) {
-							boost::shared_ptr<Job> plantJob(new Job("Plant " + Item::ItemTypeToString(seedi->first)));
+							boost::shared_ptr<Job> plantJob(Job::Create("Plant " + Item::ItemTypeToString(seedi->first)));
 							plantJob->ReserveEntity(seed);
-							plantJob->ReserveSpot(boost::static_pointer_cast<Stockpile>(shared_from_this()), containerIt->first, seed.lock()->Type());
+							plantJob->ReserveSpot(boost::static_pointer_cast<Stockpile>(shared_from_this()), spotPos, seed.lock()->Type());
 							plantJob->tasks.push_back(Task(MOVE, seed.lock()->Position()));
 							plantJob->tasks.push_back(Task(TAKE, seed.lock()->Position(), seed));
-							plantJob->tasks.push_back(Task(MOVE, containerIt->first));
-							plantJob->tasks.push_back(Task(PUTIN, containerIt->first, containerIt->second));
+							plantJob->tasks.push_back(Task(MOVE, spotPos));
+							plantJob->tasks.push_back(Task(PUTIN, spotPos, container));
 							JobManager::Inst()->AddJob(plantJob);
 							seedsLeft = true;
 							break; //Break out of for-loop, we found a seed to plant
@@ -191,11 +217,14 @@ bool FarmPlot::Full(ItemType type) {
 					}
 				}
 
+				Spot* spot = GetSpot(p);
+				if (!spot || !spot->container) continue;
+
 				//If theres a free space then it obviously is not full
-				if (containers[p]->empty() && !reserved[p]) return false;
+				if (spot->container->empty() && !spot->reserved) return false;
 
 				//Check if a container exists for this ItemCategory that isn't full
-				boost::weak_ptr<Item> item = containers[p]->GetFirstItem();
+				boost::weak_ptr<Item> item = spot->container->GetFirstItem();
 				if (item.lock() && item.lock()->IsCategory(Item::StringToItemCategory("Container"))) {
 					boost::shared_ptr<Container> container = boost::static_pointer_cast<Container>(item.lock());
 					if (type != -1 && container->IsCategory(Item::Presets[type].fitsin) && 
@@ -208,21 +237,17 @@ bool FarmPlot::Full(ItemType type) {
 }
 
 Coordinate FarmPlot::FreePosition() {
-	if (containers.size() > 0) {
+	if (spotCount > 0) {
 		//First attempt to find a random position
-		for (int i = 0; i < std::max(1, (signed int)containers.size()/4); ++i) {
-			std::map<Coordinate, boost::shared_ptr<Container> >::iterator conti = boost::next(containers.begin(), Random::ChooseIndex(containers));
-			if (conti != containers.end() && conti->second->empty() && !reserved[conti->first]) 
-				return conti->first;
+		for (int i = 0; i < std::max(1, spotCount/4); ++i) {
+			size_t index = Random::ChooseIndex(spots);
+			if (spots[index].container && spots[index].container->empty() && !spots[index].reserved) 
+				return SpotPosition(index);
 		}
 		//If that fails still iterate through each position because a free position _should_ exist
-		for (int ix = a.X(); ix <= b.X(); ++ix) {
-			for (int iy = a.Y(); iy <= b.Y(); ++iy) {
-				Coordinate p(ix,iy);
-				if (map->GetConstruction(p) == uid) {
-					if (containers[p]->empty() && !reserved[p]) return p;
-				}
-			}
+		for (size_t index = 0; index < spots.size(); ++index) {
+			if (spots[index].container && spots[index].container->empty() && !spots[index].reserved)
+				return SpotPosition(index);
 		}
 	}
 	return Coordinate(-1,-1);
@@ -232,6 +257,11 @@ void FarmPlot::save(OutputArchive& ar, const unsigned int version) const {
 	ar & boost::serialization::base_object<Stockpile>(*this);
 	ar & tilled;
 	ar & allowedSeeds;
+	//Saved as how long each tile has been growing
+	std::map<Coordinate, int> growth;
+	for (size_t i = 0; i < spots.size(); ++i) {
+		if (spots[i].container) growth.insert(std::make_pair(SpotPosition(i), GrowthClock() - spots[i].growth));
+	}
 	ar & growth;
 }
 
@@ -239,5 +269,13 @@ void FarmPlot::load(InputArchive& ar, const unsigned int version) {
 	ar & boost::serialization::base_object<Stockpile>(*this);
 	ar & tilled;
 	ar & allowedSeeds;
+	std::map<Coordinate, int> growth;
 	ar & growth;
+	for (std::map<Coordinate, int>::iterator growthi = growth.begin(); growthi != growth.end(); ++growthi) {
+		if (Spot* spot = GetSpot(growthi->first)) spot->growth = GrowthClock() - growthi->second;
+	}
+	growthTimers.Clear();
+	for (size_t i = 0; i < spots.size(); ++i) {
+		if (spots[i].container && !spots[i].container->empty()) ScheduleGrowth(SpotPosition(i));
+	}
 }
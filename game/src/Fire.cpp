@@ -65,7 +65,22 @@ void FireNode::Draw(Coordinate upleft, TCODConsole* console) {
 	}
 }
 
-void FireNode::Update() {
+namespace {
+	//Rolls how far along the drift something travels, separately for each axis
+	Coordinate Drift(const Coordinate& drift, int low, int high) {
+		return Coordinate(drift.X() ? drift.X() * Random::Generate(low, high) : 0,
+			drift.Y() ? drift.Y() * Random::Generate(low, high) : 0);
+	}
+}
+
+FireStep::FireStep(Direction wind) :
+	drift(zero - Coordinate::DirectionToCoordinate(wind)),
+	spark(Spell::StringToSpellType("spark")),
+	smoke(Spell::StringToSpellType("smoke")),
+	steam(Spell::StringToSpellType("steam")) {
+}
+
+void FireNode::Update(FireStep& step) {
 	graphic = Random::Generate(176,178);
 	color.r = Random::Generate(225, 255);
 	color.g = Random::Generate(0, 250);
@@ -76,16 +91,9 @@ void FireNode::Update() {
 	if (water && water->Depth() > 0 && Map::Inst()->IsUnbridgedWater(pos)) {
 		temperature = 0;
 		water->Depth(water->Depth()-1);
-		boost::shared_ptr<Spell> steam = Game::Inst()->CreateSpell(pos, Spell::StringToSpellType("steam"));
-
-		Coordinate direction;
-		Direction wind = Map::Inst()->GetWindDirection();
-		if (wind == NORTH || wind == NORTHEAST || wind == NORTHWEST) direction.Y(Random::Generate(1, 7));
-		if (wind == SOUTH || wind == SOUTHEAST || wind == SOUTHWEST) direction.Y(Random::Generate(-7, -1));
-		if (wind == EAST || wind == NORTHEAST || wind == SOUTHEAST) direction.X(Random::Generate(-7, -1));
-		if (wind == WEST || wind == SOUTHWEST || wind == NORTHWEST) direction.X(Random::Generate(1, 7));
-		direction += Random::ChooseInRadius(1);
-		steam->CalculateFlightPath(pos + direction, 5, 1);
+
+		Coordinate direction = Drift(step.drift, 1, 7) + Random::ChooseInRadius(1);
+		step.launches.push_back(SpellLaunch(pos, step.steam, pos + direction, 5));
 	} else if (temperature > 0) {
 		if (Random::Generate(10) == 0) { 
 			--temperature;
@@ -98,7 +106,6 @@ void FireNode::Update() {
 		int inverseSparkChance = 150 - std::max(0, ((temperature - 50) / 8));
 
 		if (Random::Generate(inverseSparkChance) == 0) {
-			boost::shared_ptr<Spell> spark = Game::Inst()->CreateSpell(pos, Spell::StringToSpellType("spark"));
 			int distance = Random::Generate(0, 15);
 			if (distance < 12) {
 				distance = 1;
@@ -108,34 +115,23 @@ void FireNode::Update() {
 				distance = 3;
 			}
 
-			Coordinate direction;
-			Direction wind = Map::Inst()->GetWindDirection();
-			if (wind == NORTH || wind == NORTHEAST || wind == NORTHWEST) direction.Y(distance);
-			if (wind == SOUTH || wind == SOUTHEAST || wind == SOUTHWEST) direction.Y(-distance);
-			if (wind == EAST || wind == NORTHEAST || wind == SOUTHEAST) direction.X(-distance);
-			if (wind == WEST || wind == SOUTHWEST || wind == NORTHWEST) direction.X(distance);
+			Coordinate direction(step.drift.X() * distance, step.drift.Y() * distance);
 			if (Random::Generate(9) < 8) direction += Random::ChooseInRadius(1);
 			else direction += Random::ChooseInRadius(3);
 
-			spark->CalculateFlightPath(pos + direction, 50, 1);
+			step.launches.push_back(SpellLaunch(pos, step.spark, pos + direction, 50));
 		}
 
 		if (Random::Generate(60) == 0) {
-			boost::shared_ptr<Spell> smoke = Game::Inst()->CreateSpell(pos, Spell::StringToSpellType("smoke"));
-			Coordinate direction;
-			Direction wind = Map::Inst()->GetWindDirection();
-			if (wind == NORTH || wind == NORTHEAST || wind == NORTHWEST) direction.Y(Random::Generate(25, 75));
-			if (wind == SOUTH || wind == SOUTHEAST || wind == SOUTHWEST) direction.Y(Random::Generate(-75, -25));
-			if (wind == EAST || wind == NORTHEAST || wind == SOUTHEAST) direction.X(Random::Generate(-75, -25));
-			if (wind == WEST || wind == SOUTHWEST || wind == NORTHWEST) direction.X(Random::Generate(25, 75));
-			direction += Random::ChooseInRadius(3);
-			smoke->CalculateFlightPath(pos + direction, 5, 1);
+			Coordinate direction = Drift(step.drift, 25, 75) + Random::ChooseInRadius(3);
+			step.launches.push_back(SpellLaunch(pos, step.smoke, pos + direction, 5));
 		}
 
 		if (temperature > 1 && Random::Generate(9) < 4) {
 			//Burn npcs on the ground
 			for (std::set<int>::iterator npci = Map::Inst()->NPCList(pos)->begin(); npci != Map::Inst()->NPCList(pos)->end(); ++npci) {
-				if (!Game::Inst()->GetNPC(*npci)->HasEffect(FLYING) && Random::Generate(10) == 0) Game::Inst()->GetNPC(*npci)->AddEffect(BURNING);
+				boost::shared_ptr<NPC> npc = Game::Inst()->GetNPC(*npci);
+				if (!npc->HasEffect(FLYING) && Random::Generate(10) == 0) npc->AddEffect(BURNING);
 			}
 
 			//Burn items
@@ -203,7 +199,7 @@ void FireNode::Update() {
 
 			//Create pour water job here if in player territory
 			if (Map::Inst()->IsTerritory(pos) && !waterJob.lock()) {
-				boost::shared_ptr<Job> pourWaterJob(new Job("Douse flames", VERYHIGH));
+				boost::shared_ptr<Job> pourWaterJob(Job::Create("Douse flames", VERYHIGH));
 				Job::CreatePourWaterJob(pourWaterJob, pos);
 				if (pourWaterJob) {
 					pourWaterJob->MarkGround(pos);
@@ -27,6 +27,7 @@ along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
 #include <functional>
 
 #include "Random.hpp"
+#include "Replay.hpp"
 #include "Camp.hpp"
 #include "GCamp.hpp"
 #include "Game.hpp"
@@ -98,6 +99,14 @@ int GCMain(std::vector<std::string>& args) {
 	bool bootTest = false;
 	Globals::noDumpMode = false;
 	
+	for (size_t i = 0; i + 1 < args.size(); ++i) {
+		if (args[i] == "-record") {
+			Replay::Record(args[i + 1]);
+		} else if (args[i] == "-replay") {
+			Replay::Play(args[i + 1]);
+		}
+	}
+	
 	BOOST_FOREACH(std::string arg, args) {
 		if (arg == "-boottest") {
 			bootTest = true;
@@ -153,6 +162,7 @@ void MainLoop() {
 			return;
 		}
 
+		Replay::Frame();
 		UI::Inst()->Update();
 		if (!game->Paused()) {
 			game->Update();
@@ -177,7 +187,9 @@ void StartNewGame() {
 	Game::Reset();
 	Game* game = Game::Inst();
 
-	game->GenerateMap(time(0));
+	unsigned int seed = Replay::NewGameSeed();
+	Random::Seed(seed);
+	game->GenerateMap(seed);
 	game->SetSeason(EarlySpring);
 
 	std::priority_queue<std::pair<int, Coordinate> > spawnCenterCandidates;
@@ -75,6 +75,7 @@ namespace py = boost::python;
 #include "tileRenderer/TileSetRenderer.hpp"
 #include "MathEx.hpp"
 #include "Color.hpp"
+#include "Parallel.hpp"
 
 int Game::ItemTypeCount = 0;
 int Game::ItemCatCount = 0;
@@ -99,6 +100,7 @@ screenWidth(0),
 	safeMonths(3),
 	events(boost::shared_ptr<Events>()),
 	gameOver(false),
+	stockpileRefreshDelay(1),
 	camX(180),
 	camY(180),
 	buffer(0)
@@ -196,11 +198,11 @@ int Game::PlaceConstruction(Coordinate target, ConstructionType construct) {
 		}
 	}
 
-	boost::shared_ptr<Job> buildJob(new Job("Build " + Construction::Presets[construct].name, MED, 0, false));
+	boost::shared_ptr<Job> buildJob(Job::Create("Build " + Construction::Presets[construct].name, MED, 0, false));
 	buildJob->DisregardTerritory();
 
 	for (std::list<ItemCategory>::iterator materialIter = newCons->MaterialList()->begin(); materialIter != newCons->MaterialList()->end(); ++materialIter) {
-		boost::shared_ptr<Job> pickupJob(new Job("Pickup " + Item::ItemCategoryToString(*materialIter) + " for " + Construction::Presets[construct].name, MED, 0, true));
+		boost::shared_ptr<Job> pickupJob(Job::Create("Pickup " + Item::ItemCategoryToString(*materialIter) + " for " + Construction::Presets[construct].name, MED, 0, true));
 		pickupJob->Parent(buildJob);
 		pickupJob->DisregardTerritory();
 		buildJob->PreReqs()->push_back(pickupJob);
@@ -389,23 +391,23 @@ int Game::CreateNPC(Coordinate target, NPCType type) {
 	for (size_t equipIndex = 0; equipIndex < NPC::Presets[type].possibleEquipment.size(); ++equipIndex) {
 		int itemType = Random::ChooseElement(NPC::Presets[type].possibleEquipment[equipIndex]);
 		if (itemType > 0 && itemType < static_cast<int>(Item::Presets.size())) {
-			std::set<ItemCategory> categories = Item::Presets[itemType].categories;
-			if (categories.find(Item::StringToItemCategory("weapon")) != categories.end()
+			const ItemPreset& preset = Item::Presets[itemType];
+			if (preset.IsCategory(Item::StringToItemCategory("weapon"))
 				&& !npc->Wielding().lock()) {
 					int itemUid = CreateItem(npc->Position(), itemType, false, npc->GetFaction(), std::vector<boost::weak_ptr<Item> >(), npc->inventory);
 					boost::shared_ptr<Item> item = itemList[itemUid];
 					npc->mainHand = item;
-			} else if (categories.find(Item::StringToItemCategory("armor")) != categories.end()
+			} else if (preset.IsCategory(Item::StringToItemCategory("armor"))
 				&& !npc->Wearing().lock()) {
 					int itemUid = CreateItem(npc->Position(), itemType, false, npc->GetFaction(), std::vector<boost::weak_ptr<Item> >(), npc->inventory);
 					boost::shared_ptr<Item> item = itemList[itemUid];
 					npc->armor = item;
-			} else if (categories.find(Item::StringToItemCategory("quiver")) != categories.end()
+			} else if (preset.IsCategory(Item::StringToItemCategory("quiver"))
 				&& !npc->quiver.lock()) {
 					int itemUid = CreateItem(npc->Position(), itemType, false, npc->GetFaction(), std::vector<boost::weak_ptr<Item> >(), npc->inventory);
 					boost::shared_ptr<Item> item = itemList[itemUid];
 					npc->quiver = boost::static_pointer_cast<Container>(item); //Quivers = containers
-			} else if (categories.find(Item::StringToItemCategory("ammunition")) != categories.end()
+			} else if (preset.IsCategory(Item::StringToItemCategory("ammunition"))
 				&& npc->quiver.lock() && npc->quiver.lock()->empty()) {
 					for (int i = 0; i < 20 && !npc->quiver.lock()->Full(); ++i) {
 						CreateItem(npc->Position(), itemType, false, npc->GetFaction(), std::vector<boost::weak_ptr<Item> >(), npc->quiver.lock());
@@ -419,6 +421,7 @@ int Game::CreateNPC(Coordinate target, NPCType type) {
 
 	npcList.insert(std::pair<int,boost::shared_ptr<NPC> >(npc->Uid(),npc));
 	npc->factionPtr->AddMember(npc);
+	ScheduleNPCTimers(npc->Uid());
 
 	return npc->Uid();
 }
@@ -743,6 +746,7 @@ int Game::CreateItem(Coordinate pos, ItemType type, bool store, int ownerFaction
 
 			if ( newItem != 0 ) { // No null pointers in itemList... I'm being overly cautious here.
 				itemList.insert(std::pair<int,boost::shared_ptr<Item> >(newItem->Uid(), newItem));
+				ScheduleDecay(newItem);
 			} else {
 				return -1;
 			}
@@ -802,6 +806,7 @@ void Game::CreateWater(Coordinate pos, int amount, int time) {
 		boost::shared_ptr<WaterNode> newWater(new WaterNode(pos, amount, time));
 		waterList.push_back(boost::weak_ptr<WaterNode>(newWater));
 		Map::Inst()->SetWater(pos, newWater);
+		ScheduleWater(newWater);
 		if (filth) newWater->AddFilth(filth->Depth());
 	} else {
 		water.lock()->Depth(water.lock()->Depth()+amount);
@@ -811,6 +816,16 @@ void Game::CreateWater(Coordinate pos, int amount, int time) {
 	if (filth) RemoveFilth(pos);
 }
 
+//For a freshly generated map: the positions may not have water or filth on them yet
+void Game::CreateWater(const std::vector<Coordinate>& positions, int amount) {
+	for (std::vector<Coordinate>::const_iterator posi = positions.begin(); posi != positions.end(); ++posi) {
+		boost::shared_ptr<WaterNode> newWater(new WaterNode(*posi, amount));
+		waterList.push_back(boost::weak_ptr<WaterNode>(newWater));
+		Map::Inst()->SetWater(*posi, newWater);
+		ScheduleWater(newWater);
+	}
+}
+
 void Game::CreateWaterFromNode(boost::shared_ptr<WaterNode> water) {
 	if (water) {
 		boost::shared_ptr<FilthNode> filth = Map::Inst()->GetFilth(water->Position()).lock();
@@ -818,6 +833,7 @@ void Game::CreateWaterFromNode(boost::shared_ptr<WaterNode> water) {
 		if (!existingWater.lock()) {
 			waterList.push_back(water);
 			Map::Inst()->SetWater(water->Position(), water);
+			ScheduleWater(water);
 			if (filth) water->AddFilth(filth->Depth());
 		} else {
 			boost::shared_ptr<WaterNode> originalWater = existingWater.lock();
@@ -886,68 +902,134 @@ void Game::CreateItems(int quantity, ItemType type, Coordinate corner1, Coordina
 	}
 }
 
-Coordinate Game::FindFilth(Coordinate pos) {
-	if (filthList.size() == 0) return undefined;
+namespace {
+	struct FilthCost {
+		Coordinate origin;
+		int operator()(const Coordinate& p) const {
+			boost::shared_ptr<FilthNode> filth = Map::Inst()->GetFilth(p).lock();
+			if (filth && filth->Depth() > 0 && Map::Inst()->IsWalkable(p))
+				return Distance(origin, p);
+			return -1;
+		}
+	};
 
-	//First check the vicinity of the given position
-	if (pos.X() >= 0) {
-		for (int i = 0; i < 10; ++i) {
-			Coordinate candidate = Random::ChooseInRadius(pos, 5);
-			boost::shared_ptr<FilthNode> filth = Map::Inst()->GetFilth(candidate).lock();
-			if (filth && filth->Depth() > 0 && Map::Inst()->IsWalkable(candidate))
-				return candidate;
+	struct WaterCost {
+		Coordinate origin;
+		int operator()(const Coordinate& p) const {
+			int waterDistance = Distance(p, origin);
+			//Favor water inside territory
+			if (Map::Inst()->IsTerritory(p)) waterDistance /= 4;
+			return waterDistance;
 		}
+	};
+}
+
+//FindFilth returns the coordinates to the closest walkable filth, or around the camp center if no position is given
+Coordinate Game::FindFilth(Coordinate pos) {
+	if (pos.X() < 0) pos = Camp::Inst()->Center();
+	FilthCost cost = { pos };
+	return Map::Inst()->FilthTiles().Nearest(pos, cost);
+}
+
+//Findwater returns the coordinates to the closest Water* that has sufficient depth and is coastal
+Coordinate Game::FindWater(Coordinate pos) {
+	WaterCost cost = { pos };
+	return Map::Inst()->DrinkableWater().Nearest(pos, cost, 4);
+}
+
+int Game::NPCTimerPeriod(int timer) {
+	switch (timer) {
+	case NPC_THIRST_TIMER:
+	case NPC_HUNGER_TIMER:
+		return UPDATES_PER_SECOND * 5;
+	default:
+		return MONTH_LENGTH;
 	}
-	
-	//Then around the camp center (a pretty good place to find filth most of the time)
-	for (int i = 0; i < 10; ++i) {
-		Coordinate candidate = Random::ChooseInRadius(Camp::Inst()->Center(), 5);
-		boost::shared_ptr<FilthNode> filth = Map::Inst()->GetFilth(candidate).lock();
-		if (filth && filth->Depth() > 0 && Map::Inst()->IsWalkable(candidate))
-			return candidate;
+}
+
+void Game::ScheduleNPCTimers(int uid) {
+	for (int timer = 0; timer < NPC_TIMER_COUNT; ++timer) {
+		npcTimers.Schedule(Random::Geometric(NPCTimerPeriod(timer)), std::make_pair(uid, timer));
 	}
+}
 
-	//If we still haven't found filth just choose the closest filth out of 30 at random
-	std::vector<boost::weak_ptr<FilthNode> > filthArray(filthList.begin(), filthList.end());
-	Coordinate closest = undefined;
-	int closest_distance = std::numeric_limits<int>::max();
-	for (size_t i = 0; i < std::min(static_cast<size_t>(30), filthArray.size()); ++i) {
-		boost::weak_ptr<FilthNode> filth = Random::ChooseElement(filthArray);
-		boost::shared_ptr<FilthNode> candidate = filth.lock();
-		if (candidate) {
-			int distance = Distance(pos, candidate->Position());
-			if (candidate->Depth() > 0 && Map::Inst()->IsWalkable(candidate->Position()) && distance < closest_distance) {
-				closest = candidate->Position();
-				closest_distance = distance;
-			}
-		}
+//Every water node updates once every 50 ticks on average. Updating one water tile also updates
+//its neighbours, and from the player's viewpoint this is just fine
+void Game::ScheduleWater(boost::shared_ptr<WaterNode> water) {
+	if (!water->UpdateScheduled()) {
+		water->UpdateScheduled(true);
+		int period = Map::Inst()->IsActive(water->Position()) ? 50 : 50 * DormantWaterSteps;
+		waterTimers.Schedule(Random::Geometric(period), water);
 	}
-	return closest;
 }
 
-//Findwater returns the coordinates to the closest Water* that has sufficient depth and is coastal
-Coordinate Game::FindWater(Coordinate pos) {
-	Coordinate closest = undefined;
-	int closestDistance = std::numeric_limits<int>::max();
-	for (std::list<boost::weak_ptr<WaterNode> >::iterator wati = waterList.begin(); wati != waterList.end(); ++wati) {
+void Game::UpdateTimers() {
+	Random::StreamScope waterStream(Random::WaterStream);
+	std::vector<boost::weak_ptr<WaterNode> > dueWater;
+	waterTimers.Advance(dueWater);
+	for (std::vector<boost::weak_ptr<WaterNode> >::iterator wati = dueWater.begin(); wati != dueWater.end(); ++wati) {
 		if (boost::shared_ptr<WaterNode> water = wati->lock()) {
-			if (water->IsCoastal() && water->Depth() > DRINKABLE_WATER_DEPTH) {
-				int waterDistance = Distance(water->Position(), pos);
-				//Favor water inside territory
-				if (Map::Inst()->IsTerritory(water->Position())) waterDistance /= 4;
-				if (waterDistance < closestDistance) { 
-					closest = water->Position();
-					closestDistance = waterDistance;
-				}
-			}
+			water->UpdateScheduled(false);
+			if (Map::Inst()->GetWater(water->Position()).lock() != water) continue; //No longer on the map
+			int steps = Map::Inst()->IsActive(water->Position()) ? 1 : DormantWaterSteps;
+			if (water->Update(steps)) RemoveWater(water->Position(), false);
+			else ScheduleWater(water);
 		}
 	}
-	return closest;
+
+	//Nodes that evaporated above are only dropped from the list here
+	if (time % UPDATES_PER_SECOND == 0) {
+		for (std::list<boost::weak_ptr<WaterNode> >::iterator wati = waterList.begin(); wati != waterList.end();) {
+			boost::shared_ptr<WaterNode> water = wati->lock();
+			if (!water || Map::Inst()->GetWater(water->Position()).lock() != water) wati = waterList.erase(wati);
+			else ++wati;
+		}
+	}
+
+	Random::StreamScope aiStream(Random::AIStream);
+	std::vector<std::pair<int, int> > dueNPCTimers;
+	npcTimers.Advance(dueNPCTimers);
+	for (std::vector<std::pair<int, int> >::iterator timer = dueNPCTimers.begin(); timer != dueNPCTimers.end(); ++timer) {
+		std::map<int, boost::shared_ptr<NPC> >::iterator npci = npcList.find(timer->first);
+		if (npci == npcList.end() || npci->second->Dead()) continue; //Timers of removed NPCs just run out
+		boost::shared_ptr<NPC> npc = npci->second;
+
+		switch (timer->second) {
+		case NPC_THIRST_TIMER:
+			if (npc->needsNutrition && npc->thirst > THIRST_THRESHOLD) npc->HandleThirst();
+			break;
+		case NPC_HUNGER_TIMER:
+			if (npc->needsNutrition && npc->hunger > HUNGER_THRESHOLD) npc->HandleHunger();
+			break;
+		case NPC_FILTH_TIMER:
+			if (npc->faction == PLAYERFACTION) CreateFilth(npc->Position());
+			break;
+		}
+		npcTimers.Schedule(Random::Geometric(NPCTimerPeriod(timer->second)), *timer);
+	}
+}
+
+//The map is simulated in full detail only around the camp and the camera, see Map::UpdateActivity
+void Game::UpdateActivity() {
+	std::vector<Coordinate> anchors;
+	anchors.push_back(Coordinate(static_cast<int>(camX), static_cast<int>(camY)));
+	for (std::map<int, boost::shared_ptr<NPC> >::iterator npci = npcList.begin(); npci != npcList.end(); ++npci) {
+		if (npci->second->GetFaction() == PLAYERFACTION) anchors.push_back(npci->second->Position());
+	}
+	for (std::map<int, boost::shared_ptr<Construction> >::iterator consi = staticConstructionList.begin(); consi != staticConstructionList.end(); ++consi) {
+		anchors.push_back(consi->second->Position());
+	}
+	for (std::map<int, boost::shared_ptr<Construction> >::iterator consi = dynamicConstructionList.begin(); consi != dynamicConstructionList.end(); ++consi) {
+		anchors.push_back(consi->second->Position());
+	}
+	Map::Inst()->UpdateActivity(anchors);
 }
 
 void Game::Update() {
 	++time;
 
+	FinishBackgroundSave();
+
 	if (time >= MONTH_LENGTH) {
 	  time -= MONTH_LENGTH; // Decrement time now to avoid autosaving issues.
 		Stats::Inst()->AddPoints(10U);
@@ -968,9 +1050,7 @@ void Game::Update() {
 			++age;
 			if (Config::GetCVar<bool>("autosave")) {
 				std::string saveName = "autosave" + std::string(age % 2 ? "1" : "2");
-				if (Data::SaveGame(saveName, false))
-					Announce::Inst()->AddMsg("Autosaved");
-				else
+				if (!Data::AutoSave(saveName))
 					Announce::Inst()->AddMsg("Failed to autosave! Refer to the logfile", GCampColor::red);
 			}
 		case Spring:
@@ -1006,29 +1086,15 @@ void Game::Update() {
 		}
 	}
 
-	//This actually only updates every 50th waternode. This is due to 2 things: updating one water tile actually also
-	//updates all its neighbours. Also, by updating only every 50th one, the load on the cpu is less, but you need to
-	//remember that Update gets called 25 times a second, and given the nature of rand() this means that each waternode
-	//will be updated once every 2 seconds. It turns out that from the player's viewpoint this is just fine
-	
-	// nextWati removed because list<> complained about invalidated iterators -pl
-	for (auto watIt = waterList.begin(); watIt != waterList.end(); ) {
-		if (auto water = watIt->lock()) {
-			if (Random::Generate(49) == 0 && water->Update()) {
-				RemoveWater(water->Position(), false);
-				watIt = waterList.erase(watIt);
-			} else {
-				++watIt;
-			}
-		} else {
-			watIt = waterList.erase(watIt);
-		}
-	}
-	
+	if (time % UPDATES_PER_SECOND == 0) UpdateActivity();
+
+	UpdateTimers();
+
 	//Updating the last 10 waternodes each time means that recently created water moves faster.
 	//This has the effect of making water rush to new places such as a moat very quickly, which is the
 	//expected behaviour of water.
 	if (waterList.size() > 0) {
+		Random::StreamScope waterStream(Random::WaterStream);
 		//We have to use two iterators, because wati may be invalidated if the water evaporates and is removed
 		std::list<boost::weak_ptr<WaterNode> >::iterator wati = waterList.end();
 		std::list<boost::weak_ptr<WaterNode> >::iterator nextwati = --wati;
@@ -1040,13 +1106,28 @@ void Game::Update() {
 		}
 	}
 	
+	if (time % UPDATES_PER_SECOND == 0) Map::Inst()->UpdateRegions();
+	{
+		std::vector<Coordinate> blocked;
+		Map::Inst()->TakeBlockedTiles(blocked);
+		if (!blocked.empty()) {
+			boost::unordered_set<Coordinate> blockedSet(blocked.begin(), blocked.end());
+			for (std::map<int,boost::shared_ptr<NPC> >::iterator npci = npcList.begin(); npci != npcList.end(); ++npci) {
+				npci->second->CheckPath(blockedSet);
+			}
+		}
+	}
+
 	std::list<boost::weak_ptr<NPC> > npcsWaitingForRemoval;
-	for (std::map<int,boost::shared_ptr<NPC> >::iterator npci = npcList.begin(); npci != npcList.end(); ++npci) {
-		npci->second->Update();
-		if (!npci->second->Dead()) npci->second->Think();
-		if (npci->second->Dead() || npci->second->Escaped()) npcsWaitingForRemoval.push_back(npci->second);
+	{
+		Random::StreamScope aiStream(Random::AIStream);
+		for (std::map<int,boost::shared_ptr<NPC> >::iterator npci = npcList.begin(); npci != npcList.end(); ++npci) {
+			npci->second->Update();
+			if (!npci->second->Dead()) npci->second->Think();
+			if (npci->second->Dead() || npci->second->Escaped()) npcsWaitingForRemoval.push_back(npci->second);
+		}
+		JobManager::Inst()->AssignJobs();
 	}
-	JobManager::Inst()->AssignJobs();
 	
 	for (std::list<boost::weak_ptr<NPC> >::iterator remNpci = npcsWaitingForRemoval.begin(); remNpci != npcsWaitingForRemoval.end(); ++remNpci) {
 		RemoveNPC(*remNpci);
@@ -1056,24 +1137,13 @@ void Game::Update() {
 		consi->second->Update();
 	}
 
-	for (std::list<boost::weak_ptr<Item> >::iterator itemi = stoppedItems.begin(); itemi != stoppedItems.end();) {
-		flyingItems.erase(*itemi);
-		if (boost::shared_ptr<Item> item = itemi->lock()) {
-			if (item->condition == 0) { //The impact has destroyed the item
-				RemoveItem(item);
-			}
-		}
-		itemi = stoppedItems.erase(itemi);
-	}
-
-	for (std::set<boost::weak_ptr<Item> >::iterator itemi = flyingItems.begin(); itemi != flyingItems.end(); ++itemi) {
-		if (boost::shared_ptr<Item> item = itemi->lock()) item->UpdateVelocity();
-	}
+	UpdateProjectiles();
 
 	/*Constantly checking our free item list for items that can be stockpiled is overkill, so it's done once every
 	5 seconds, on average, or immediately if a new stockpile is built or a stockpile's allowed items are changed.
 	To further reduce load when very many free items exist, only a quarter of them will be checked*/
-	if (Random::Generate(UPDATES_PER_SECOND * 5 - 1) == 0 || refreshStockpiles) {
+	if (--stockpileRefreshDelay <= 0 || refreshStockpiles) {
+		if (stockpileRefreshDelay <= 0) stockpileRefreshDelay = Random::Geometric(UPDATES_PER_SECOND * 5);
 		refreshStockpiles = false;
 		if (freeItems.size() < 100) {
 			for (std::set<boost::weak_ptr<Item> >::iterator itemi = freeItems.begin(); itemi != freeItems.end(); ++itemi) {
@@ -1113,6 +1183,8 @@ void Game::Update() {
 	PyGILState_STATE gstate;
 	gstate = PyGILState_Ensure();  // Grab Global Interpreter Lock before doing python related stuff
 
+	Script::Event::DispatchQueued();
+
 	for (std::list<std::pair<int, boost::function<void()> > >::iterator delit = delays.begin(); delit != delays.end();) {
 		if (--delit->first <= 0) {
 			try {
@@ -1133,16 +1205,29 @@ void Game::Update() {
 		MessageBox::ShowMessageBox("Do you wish to keep watching?", NULL, "Keep watching", boost::bind(&Game::GameOver, Game::Inst()), "Quit");
 	}
 
-	for (std::list<boost::weak_ptr<FireNode> >::iterator fireit = fireList.begin(); fireit != fireList.end();) {
-		if (boost::shared_ptr<FireNode> fire = fireit->lock()) {
-			if (Random::GenerateBool()) fire->Update();
-			if (fire->GetHeat() <= 0) {
-				Map::Inst()->SetFire(fire->Position(), boost::shared_ptr<FireNode>());
-				fireit = fireList.erase(fireit);
-			} else { ++fireit; }
-		} else {
-			fireit = fireList.erase(fireit);
+	UpdateFires();
+
+	for (size_t i = 1; i < Faction::factions.size(); ++i) {
+		Faction::factions[i]->Update();
+	}
+}
+
+//Moves every flying item and spell, then applies the hits they scored
+void Game::UpdateProjectiles() {
+	Random::StreamScope combatStream(Random::CombatStream);
+
+	for (std::list<boost::weak_ptr<Item> >::iterator itemi = stoppedItems.begin(); itemi != stoppedItems.end();) {
+		flyingItems.erase(*itemi);
+		if (boost::shared_ptr<Item> item = itemi->lock()) {
+			if (item->condition == 0) { //The impact has destroyed the item
+				RemoveItem(item);
+			}
 		}
+		itemi = stoppedItems.erase(itemi);
+	}
+
+	for (std::set<boost::weak_ptr<Item> >::iterator itemi = flyingItems.begin(); itemi != flyingItems.end(); ++itemi) {
+		if (boost::shared_ptr<Item> item = itemi->lock()) item->UpdateVelocity();
 	}
 
 	for (std::list<boost::shared_ptr<Spell> >::iterator spellit = spellList.begin(); spellit != spellList.end();) {
@@ -1154,11 +1239,48 @@ void Game::Update() {
 		}
 	}
 
-	for (size_t i = 1; i < Faction::factions.size(); ++i) {
-		Faction::factions[i]->Update();
+	std::vector<std::pair<boost::weak_ptr<Entity>, Attack> > hits;
+	hits.swap(pendingHits);
+	for (std::vector<std::pair<boost::weak_ptr<Entity>, Attack> >::iterator hiti = hits.begin(); hiti != hits.end(); ++hiti) {
+		if (boost::shared_ptr<Entity> target = hiti->first.lock()) {
+			if (boost::shared_ptr<NPC> npc = boost::dynamic_pointer_cast<NPC>(target)) {
+				npc->Damage(&hiti->second);
+			} else if (boost::shared_ptr<Construction> construct = boost::dynamic_pointer_cast<Construction>(target)) {
+				construct->Damage(&hiti->second);
+			}
+		}
 	}
 }
 
+/* Updates about half of the burning tiles each tick. Dead fires are swapped out with the last
+   entry, and whatever the fires give off is launched after all of them have been updated. */
+void Game::UpdateFires() {
+	if (fireList.empty()) return;
+
+	FireStep step(Map::Inst()->GetWindDirection());
+	for (size_t i = 0; i < fireList.size();) {
+		boost::shared_ptr<FireNode> fire = fireList[i].lock();
+		if (fire) {
+			if (Random::GenerateBool()) fire->Update(step);
+			if (fire->GetHeat() > 0) {
+				++i;
+				continue;
+			}
+			Map::Inst()->SetFire(fire->Position(), boost::shared_ptr<FireNode>());
+		}
+		fireList[i] = fireList.back();
+		fireList.pop_back();
+	}
+
+	for (std::vector<SpellLaunch>::iterator launchi = step.launches.begin(); launchi != step.launches.end(); ++launchi) {
+		CreateSpell(launchi->pos, launchi->type)->CalculateFlightPath(launchi->target, launchi->speed, 1);
+	}
+}
+
+void Game::QueueHit(boost::weak_ptr<Entity> target, const Attack& attack) {
+	pendingHits.push_back(std::make_pair(target, attack));
+}
+
 boost::shared_ptr<Job> Game::StockpileItem(boost::weak_ptr<Item> witem, bool returnJob, bool disregardTerritory, bool reserveItem) {
 	if (boost::shared_ptr<Item> item = witem.lock()) {
 		if ((!reserveItem || !item->Reserved()) && item->GetFaction() == PLAYERFACTION) {
@@ -1215,24 +1337,23 @@ boost::shared_ptr<Job> Game::StockpileItem(boost::weak_ptr<Item> witem, bool ret
 					else priority = HIGH;
 				}
 
-				boost::shared_ptr<Job> stockJob(new Job("Store " + Item::ItemTypeToString(item->Type()) + " in stockpile", priority));
-				stockJob->Attempts(1);
-				stockJob->ConnectToEntity(nearest);
 				Coordinate target = Coordinate(-1,-1);
 				boost::weak_ptr<Item> container;
 
 				//Check if the item can be contained, and if so if any containers are in the stockpile
 				if (Item::Presets[item->Type()].fitsin >= 0) {
 					container = nearest->FindItemByCategory(Item::Presets[item->Type()].fitsin, NOTFULL, item->GetBulk());
-					if (container.lock()) {
-						target = container.lock()->Position();
-						stockJob->ReserveSpace(boost::static_pointer_cast<Container>(container.lock()), item->GetBulk());
-					}
+					if (container.lock()) target = container.lock()->Position();
 				}
 
 				if (target.X() == -1) target = nearest->FreePosition();
 
+				//The job is only made once it's certain there's somewhere to put the item
 				if (target.X() != -1) {
+					boost::shared_ptr<Job> stockJob(Job::Create("Store " + Item::ItemTypeToString(item->Type()) + " in stockpile", priority));
+					stockJob->Attempts(1);
+					stockJob->ConnectToEntity(nearest);
+					if (container.lock()) stockJob->ReserveSpace(boost::static_pointer_cast<Container>(container.lock()), item->GetBulk());
 					stockJob->ReserveSpot(nearest, target, item->Type());
 					if (reserveItem) stockJob->ReserveEntity(item);
 					stockJob->tasks.push_back(Task(MOVE, item->Position()));
@@ -1306,7 +1427,7 @@ Season Game::CurrentSeason() { return season; }
 void Game::SpawnTillageJobs() {
 	for (std::map<int,boost::shared_ptr<Construction> >::iterator consi = dynamicConstructionList.begin(); consi != dynamicConstructionList.end(); ++consi) {
 		if (consi->second->farmplot) {
-			boost::shared_ptr<Job> tillJob(new Job("Till farmplot"));
+			boost::shared_ptr<Job> tillJob(Job::Create("Till farmplot"));
 			tillJob->tasks.push_back(Task(MOVE, consi->second->Position()));
 			tillJob->tasks.push_back(Task(USE, consi->second->Position(), consi->second));
 			JobManager::Inst()->AddJob(tillJob);
@@ -1322,8 +1443,63 @@ void Game::DeTillFarmPlots() {
 	}
 }
 
+namespace {
+	/* Distance from every tile to the nearest target tile in the same row and in the same
+	   column, capped at 'limit'. Stands in for scanning or probing lines out of each tile. */
+	class AxisDistances {
+		int width, height;
+		std::vector<int> row, column;
+
+	public:
+		AxisDistances(const std::vector<char>& targets, int width, int height, int limit) :
+			width(width), height(height), row(width * height), column(width * height) {
+			ParallelFor(height, [&](size_t y) {
+				Sweep(targets, &row[0], static_cast<int>(y) * width, 1, width, limit);
+			});
+			ParallelFor(width, [&](size_t x) {
+				Sweep(targets, &column[0], static_cast<int>(x), width, height, limit);
+			});
+		}
+
+		//Distance along the row or column, whichever is nearer
+		int operator()(const Coordinate& p) const {
+			int i = p.Y() * width + p.X();
+			return std::min(row[i], column[i]);
+		}
+
+	private:
+		//One forward and one backward pass over the 'count' tiles starting at 'first', 'stride' apart
+		static void Sweep(const std::vector<char>& targets, int* out, int first, int stride, int count, int limit) {
+			int distance = limit;
+			for (int i = 0, idx = first; i < count; ++i, idx += stride) {
+				distance = targets[idx] ? 0 : std::min(distance + 1, limit);
+				out[idx] = distance;
+			}
+			distance = limit;
+			for (int i = count - 1, idx = first + (count - 1) * stride; i >= 0; --i, idx -= stride) {
+				distance = targets[idx] ? 0 : std::min(distance + 1, limit);
+				out[idx] = std::min(out[idx], distance);
+			}
+		}
+	};
+
+	//Marks the tiles lying below the water level
+	std::vector<char> WaterTiles(Map* map) {
+		std::vector<char> water(map->Width() * map->Height());
+		ParallelFor(map->Height(), [&](size_t row) {
+			int y = static_cast<int>(row);
+			for (int x = 0; x < map->Width(); ++x) {
+				water[y * map->Width() + x] = map->heightMap->getValue(x, y) < map->GetWaterlevel();
+			}
+		});
+		return water;
+	}
+}
+
 //First generates a heightmap, then translates that into the corresponding tiles
 //Third places plantlife according to heightmap, and some wildlife as well
+//The per-tile passes run in parallel; whatever randomness they use comes from generators
+//seeded from 'seed' per row or stripe, so a seed always gives the same map
 void Game::GenerateMap(uint32 seed) {
 	Random::Generator random(seed);
 	
@@ -1365,37 +1541,29 @@ void Game::GenerateMap(uint32 seed) {
 	map->heightMap->digBezier(px, py, width, -depth, width, -depth);
 
 	int hills = 0;
-	//infinityCheck is just there to make sure our while loop doesn't become an infinite one
-	//in case no suitable hill sites are found
-	int infinityCheck = 0;
-	while (hills < map->Width()/66 && infinityCheck < 1000) {
-		Coordinate candidate = Random::ChooseInExtent(map->Extent());
-		int riverDistance = 70;
-
-		//We draw four lines from our potential hill site and measure the least distance to a river
-		Direction dirs[4] = { WEST, EAST, NORTH, SOUTH };
-		for (int i = 0; i < 4; ++i) {
-			int distance = 70;
-			Coordinate line = candidate + Coordinate::DirectionToCoordinate(dirs[i]) * distance;
-			for (TCODLine::init(line.X(), line.Y(), candidate.X(), candidate.Y()); !TCODLine::step(line.Xptr(), line.Yptr()); --distance) {
-				if (map->IsInside(line) && map->heightMap->getValue(line.X(), line.Y()) < map->GetWaterlevel())
-					if (distance < riverDistance)
-						riverDistance = distance;
+	{
+		//Hills only raise the ground far away from the river, so these distances stay valid while placing them
+		AxisDistances riverDistance(WaterTiles(map), map->Width(), map->Height(), 70);
+
+		//infinityCheck is just there to make sure our while loop doesn't become an infinite one
+		//in case no suitable hill sites are found
+		int infinityCheck = 0;
+		while (hills < map->Width()/66 && infinityCheck < 1000) {
+			Coordinate candidate = Random::ChooseInExtent(map->Extent());
+
+			if (riverDistance(candidate) > 35) {
+				Coordinate centers[3] = { candidate, random.ChooseInRadius(candidate,7), random.ChooseInRadius(candidate,7) };
+				int heights[3] = { 35, 25, 25 };
+				for (int i = 0; i < 3; ++i) {
+					int height = random.Generate(15, heights[i]);
+					int radius = random.Generate(1,3);
+					map->heightMap->addHill(static_cast<float>(centers[i].X()), static_cast<float>(centers[i].Y()), static_cast<float>(height), static_cast<float>(radius));
+				}
+				++hills;
 			}
-		}
 
-		if (riverDistance > 35) {
-			Coordinate centers[3] = { candidate, random.ChooseInRadius(candidate,7), random.ChooseInRadius(candidate,7) };
-			int heights[3] = { 35, 25, 25 };
-			for (int i = 0; i < 3; ++i) {
-				int height = random.Generate(15, heights[i]);
-				int radius = random.Generate(1,3);
-				map->heightMap->addHill(static_cast<float>(centers[i].X()), static_cast<float>(centers[i].Y()), static_cast<float>(height), static_cast<float>(radius));
-			}
-			++hills;
+			++infinityCheck;
 		}
-
-		++infinityCheck;
 	}
 	
 	{
@@ -1409,58 +1577,42 @@ void Game::GenerateMap(uint32 seed) {
 	float weight[] = {0.33f,0.33f,0.33f};
 	map->heightMap->kernelTransform(3, dx, dy, weight, 0.0f, 1.0f);
 
+	std::vector<char> water = WaterTiles(map);
+	std::vector<char> land(water.size());
+	std::transform(water.begin(), water.end(), land.begin(), std::logical_not<char>());
+	AxisDistances landDistance(land, map->Width(), map->Height(), 4);
+	AxisDistances riverDistance(water, map->Width(), map->Height(), 70);
+
+	//Now take the heightmap values and translate them into tiles, water within 3 tiles of land is a ditch
+	std::vector<TileType> types(water.size());
+	ParallelFor(map->Height(), [&](size_t row) {
+		int y = static_cast<int>(row);
+		for (int x = 0; x < map->Width(); ++x) {
+			int i = y * map->Width() + x;
+			if (water[i]) {
+				types[i] = landDistance(Coordinate(x, y)) <= 3 ? TILEDITCH : TILERIVERBED;
+			} else if (map->heightMap->getValue(x, y) < 4.5f) {
+				types[i] = TILEGRASS;
+			} else {
+				types[i] = TILEROCK;
+			}
+		}
+	});
+	map->ResetTypes(types, random.Generate(1, std::numeric_limits<int>::max()));
 
-	//Now take the heightmap values and translate them into tiles
+	std::vector<Coordinate> river;
 	for (int x = 0; x < map->Width(); ++x) {
 		for (int y = 0; y < map->Height(); ++y) {
-			Coordinate p(x,y);
-			float height = map->heightMap->getValue(x, y);
-			if (height < map->GetWaterlevel()) {
-				bool tileChosen = false;
-				for (int ix = x - 3; ix <= x + 3; ++ix) {
-					Coordinate ip(ix, y);
-					if (map->IsInside(ip) && map->heightMap->getValue(ix, y) >= map->GetWaterlevel()) {
-							map->ResetType(p,TILEDITCH);
-							tileChosen = true;
-							break;
-					}
-				}
-				if (!tileChosen) {
-					for (int iy = y - 3; iy <= y + 3; ++iy) {
-						Coordinate ip(x,iy);
-						if (map->IsInside(ip) &&map->heightMap->getValue(x, iy) >= map->GetWaterlevel()) {
-								map->ResetType(p,TILEDITCH);
-								tileChosen = true;
-								break;
-						}
-					}
-				}
-				if (!tileChosen) map->ResetType(p,TILERIVERBED);
-				CreateWater(p, RIVERDEPTH);
-			} else if (height < 4.5f) {
-				map->ResetType(p,TILEGRASS);
-			} else {
-				map->ResetType(p,TILEROCK);
-			}
+			if (water[y * map->Width() + x]) river.push_back(Coordinate(x, y));
 		}
 	}
+	CreateWater(river, RIVERDEPTH);
 
 	//Create a bog
-	infinityCheck = 0;
+	int infinityCheck = 0;
 	while (infinityCheck < 1000) {
 		Coordinate candidate = random.ChooseInRectangle(zero+30, map->Extent()-30);
-		int riverDistance = 70;
-		Direction dirs[4] = { WEST, EAST, NORTH, SOUTH };
-		for (int i = 0; i < 4; ++i) {
-			int distance = 70;
-			Coordinate line = candidate + Coordinate::DirectionToCoordinate(dirs[i]) * distance;
-			for (TCODLine::init(line.X(), line.Y(), candidate.X(), candidate.Y()); !TCODLine::step(line.Xptr(), line.Yptr()); --distance) {
-				if (map->IsInside(line) && map->heightMap->getValue(line.X(), line.Y()) < map->GetWaterlevel())
-					if (distance < riverDistance)
-						riverDistance = distance;
-			}
-		}
-		if (riverDistance > 30) {
+		if (riverDistance(candidate) > 30) {
 			int lowOffset = random.Generate(-5, 5);
 			int highOffset = random.Generate(-5, 5);
 			for (int xOffset = -25; xOffset < 25; ++xOffset) {
@@ -1476,16 +1628,81 @@ void Game::GenerateMap(uint32 seed) {
 		++infinityCheck;
 	}
 
-	for (int x = 0; x < map->Width(); ++x) {
-		for (int y = 0; y < map->Height(); ++y) {
-			map->Naturify(Coordinate(x,y));
-		}
-	}
+	GenerateNature(random.Generate(1, std::numeric_limits<int>::max()));
 
 	map->RandomizeWind();
 	
 	map->CalculateFlow(px, py);
-	map->UpdateCache();
+	map->RebuildCache();
+}
+
+/* Plants the initial nature objects, the equivalent of Map::Naturify() over a fresh map.
+   The map is split into stripes of rows, every stripe deciding its objects with its own
+   generator. Even stripes go first and odd ones after them, which keeps the stripes that
+   run at the same time from seeing each other's objects. The objects themselves are
+   created afterwards in one go. */
+void Game::GenerateNature(uint32 seed) {
+	Map* map = Map::Inst();
+	const int width = map->Width(), height = map->Height();
+
+	int maxCluster = 1;
+	for (std::vector<NatureObjectPreset>::iterator preseti = NatureObject::Presets.begin(); preseti != NatureObject::Presets.end(); ++preseti) {
+		maxCluster = std::max(maxCluster, preseti->cluster);
+	}
+	//How many rows past its own a stripe reads (counting nearby objects) or writes (placing clusters)
+	const int reach = std::max(2, maxCluster - 1);
+	const int stripeHeight = std::max(16, 2 * reach);
+	const int stripes = (height + stripeHeight - 1) / stripeHeight;
+
+	std::vector<char> occupied(width * height);
+	for (int x = 0; x < width; ++x) {
+		for (int y = 0; y < height; ++y) {
+			Coordinate p(x, y);
+			occupied[y * width + x] = map->GetNatureObject(p) >= 0 || map->GetConstruction(p) >= 0;
+		}
+	}
+
+	std::vector<std::vector<std::pair<Coordinate, int> > > planted(stripes);
+	for (int parity = 0; parity < 2; ++parity) {
+		ParallelFor((stripes + 1 - parity) / 2, [&](size_t i) {
+			int stripe = static_cast<int>(2 * i) + parity;
+			Random::Generator stripeRandom(Random::DeriveSeed(seed, stripe));
+			Random::StreamScope scope(stripeRandom);
+
+			for (int y = stripe * stripeHeight; y < std::min(height, (stripe + 1) * stripeHeight); ++y) {
+				for (int x = 0; x < width; ++x) {
+					Coordinate p(x, y);
+					if (occupied[y * width + x]) continue;
+
+					int natureObjects = 0;
+					Coordinate begin = map->Shrink(p - 2);
+					Coordinate end = map->Shrink(p + 2);
+					for (int iy = begin.Y(); iy <= end.Y(); ++iy) {
+						for (int ix = begin.X(); ix <= end.X(); ++ix) {
+							if (occupied[iy * width + ix]) ++natureObjects;
+						}
+					}
+					if (natureObjects >= (map->GetCorruption(p) < 100 ? 6 : 1)) continue;
+
+					int chosen = ChooseNatureObject(p, natureObjects);
+					if (chosen < 0) continue;
+					for (int clus = 0; clus < NatureObject::Presets[chosen].cluster; ++clus) {
+						Coordinate a = map->Shrink(Random::ChooseInRadius(p, clus));
+						if (!occupied[a.Y() * width + a.X()] && CanGrowNatureObject(a)) {
+							occupied[a.Y() * width + a.X()] = true;
+							planted[stripe].push_back(std::make_pair(a, chosen));
+						}
+					}
+				}
+			}
+		});
+	}
+
+	for (std::vector<std::vector<std::pair<Coordinate, int> > >::iterator stripei = planted.begin(); stripei != planted.end(); ++stripei) {
+		for (std::vector<std::pair<Coordinate, int> >::iterator planti = stripei->begin(); planti != stripei->end(); ++planti) {
+			InsertNatureObject(boost::shared_ptr<NatureObject>(new NatureObject(planti->first, planti->second)));
+		}
+	}
 }
 
 //This is intentional, otherwise designating where to cut down trees would always show red unless you were over a tree
@@ -1501,7 +1718,7 @@ void Game::FellTree(Coordinate a, Coordinate b) {
 				boost::shared_ptr<NatureObject> natObj = Game::Inst()->natureList[natUid];
 				if (natObj && natObj->Tree() && !natObj->Marked()) {
 					natObj->Mark();
-					boost::shared_ptr<Job> fellJob(new Job("Fell tree", MED, 0, true));
+					boost::shared_ptr<Job> fellJob(Job::Create("Fell tree", MED, 0, true));
 					fellJob->Attempts(50);
 					fellJob->ConnectToEntity(natObj);
 					fellJob->DisregardTerritory();
@@ -1539,7 +1756,7 @@ void Game::HarvestWildPlant(Coordinate a, Coordinate b) {
 				boost::shared_ptr<NatureObject> natObj = Game::Inst()->natureList[natUid];
 				if (natObj && natObj->Harvestable() && !natObj->Marked()) {
 					natObj->Mark();
-					boost::shared_ptr<Job> harvestJob(new Job("Harvest wild plant"));
+					boost::shared_ptr<Job> harvestJob(Job::Create("Harvest wild plant"));
 					harvestJob->ConnectToEntity(natObj);
 					harvestJob->DisregardTerritory();
 					harvestJob->tasks.push_back(Task(MOVEADJACENT, natObj->Position(), natObj));
@@ -1636,22 +1853,16 @@ std::string Game::SeasonToString(Season season) {
 void Game::DecayItems() {
 	std::list<int> eraseList;
 	std::list<std::pair<ItemType, Coordinate> > creationList;
-	for (std::map<int,boost::shared_ptr<Item> >::iterator itemit = itemList.begin(); itemit != itemList.end(); ) {
-
-		if (itemit->second == 0) { // Now, how did we get a null pointer in here..
-			itemit = itemList.erase(itemit); // Get it out of the list!
-			if ( itemit == itemList.end() ) break;
-		}
-
-		if (itemit->second->decayCounter > 0) {
-			if (--itemit->second->decayCounter == 0) {
-				for (std::vector<ItemType>::iterator decaylisti = Item::Presets[itemit->second->type].decayList.begin(); decaylisti != Item::Presets[itemit->second->type].decayList.end(); ++decaylisti) {
-					creationList.push_back(std::pair<ItemType, Coordinate>(*decaylisti, itemit->second->Position()));
-				}
-				eraseList.push_back(itemit->first);
+	std::vector<int> rotten;
+	decayTimers.Advance(rotten);
+	for (std::vector<int>::iterator uidi = rotten.begin(); uidi != rotten.end(); ++uidi) {
+		boost::shared_ptr<Item> item = GetItem(*uidi).lock();
+		if (item && item->GetDecay() == 0) { //Items that were rescheduled since aren't due yet
+			for (std::vector<ItemType>::iterator decaylisti = Item::Presets[item->type].decayList.begin(); decaylisti != Item::Presets[item->type].decayList.end(); ++decaylisti) {
+				creationList.push_back(std::pair<ItemType, Coordinate>(*decaylisti, item->Position()));
 			}
+			eraseList.push_back(*uidi);
 		}
-		++itemit;
 	}
 
 	for (std::list<int>::iterator delit = eraseList.begin(); delit != eraseList.end(); ++delit) {
@@ -1679,6 +1890,16 @@ void Game::DecayItems() {
 	}
 }
 
+//Items that decay are due in decayTimers after as many DecayItems() passes as they have decay left
+void Game::ScheduleDecay(boost::shared_ptr<Item> item) {
+	if (item->decayCounter > 0) {
+		item->decayScheduled = decayTimers.Now();
+		decayTimers.Schedule(item->decayCounter, item->Uid());
+	}
+}
+
+boost::uint64_t Game::DecayClock() const { return decayTimers.Now(); }
+
 void Game::CreateFilth(Coordinate pos) {
 	CreateFilth(pos, 1);
 }
@@ -2013,6 +2234,12 @@ boost::weak_ptr<Construction> Game::FindConstructionByTag(ConstructionTag tag, C
 }
 
 void Game::Reset() {
+	FinishBackgroundSave(true);
+
+	instance->npcTimers.Clear();
+	instance->waterTimers.Clear();
+	instance->decayTimers.Clear();
+
 	//TODO: ugly
 	instance->npcList.clear();
 	instance->natureList.clear(); //Ice decays into ice objects and water, so clear this before items and water
@@ -2120,7 +2347,7 @@ void Game::Dig(Coordinate a, Coordinate b) {
 			allowedTypes.insert(TILEBOG);
 			allowedTypes.insert(TILESNOW);
 			if (CheckPlacement(p, Coordinate(1,1), allowedTypes) && !Map::Inst()->GroundMarked(p) && !Map::Inst()->IsLow(p)) {
-				boost::shared_ptr<Job> digJob(new Job("Dig"));
+				boost::shared_ptr<Job> digJob(Job::Create("Dig"));
 				digJob->SetRequiredTool(Item::StringToItemCategory("Shovel"));
 				digJob->MarkGround(p);
 				digJob->Attempts(50);
@@ -2156,7 +2383,8 @@ bool Game::Adjacent(Coordinate a, Coordinate b) {
 	return (std::abs(a.X() - b.X()) < 2 && std::abs(a.Y() - b.Y()) < 2);
 }
 
-void Game::CreateNatureObject(Coordinate pos, int surroundingNatureObjects) {
+//Decides whether a plant grows at pos and which one, returns its preset or -1
+int Game::ChooseNatureObject(const Coordinate& pos, int surroundingNatureObjects) {
 	if (Map::Inst()->IsWalkable(pos) && (Map::Inst()->GetType(pos) == TILEGRASS || Map::Inst()->GetType(pos) == TILESNOW) && Random::Generate(4) < 2) {
 		std::priority_queue<std::pair<int, int> > natureObjectQueue;
 		float height = Map::Inst()->heightMap->getValue(pos.X(),pos.Y());
@@ -2172,7 +2400,7 @@ void Game::CreateNatureObject(Coordinate pos, int surroundingNatureObjects) {
 				natureObjectQueue.push(std::make_pair(Random::Generate(NatureObject::Presets[i].rarity - 1) + Random::Generate(2), i));
 		}
 
-		if (natureObjectQueue.empty()) return;
+		if (natureObjectQueue.empty()) return -1;
 		int chosen = natureObjectQueue.top().second;
 		int rarity = NatureObject::Presets[chosen].rarity;
 		if (std::abs(height - NatureObject::Presets[chosen].minHeight) <= 0.01f ||
@@ -2180,45 +2408,59 @@ void Game::CreateNatureObject(Coordinate pos, int surroundingNatureObjects) {
 		if (std::abs(height - NatureObject::Presets[chosen].minHeight) <= 0.005f ||
 			std::abs(height - NatureObject::Presets[chosen].maxHeight) <= 0.05f) rarity /= 2;
 
-		if (Random::Generate(50) < rarity) {
-			for (int clus = 0; clus < NatureObject::Presets[chosen].cluster; ++clus) {
-				Coordinate a = Map::Inst()->Shrink(Random::ChooseInRadius(pos, clus));
-				if (Map::Inst()->IsWalkable(a) && (Map::Inst()->GetType(a) == TILEGRASS || Map::Inst()->GetType(a) == TILESNOW)
-					&& Map::Inst()->GetNatureObject(a) < 0 && Map::Inst()->GetConstruction(a) < 0)
-				{
-					boost::shared_ptr<NatureObject> natObj(new NatureObject(a, chosen));
-					natureList.insert(std::pair<int, boost::shared_ptr<NatureObject> >(natObj->Uid(), natObj));
-					Map::Inst()->SetNatureObject(a,natObj->Uid());
-					Map::Inst()->SetWalkable(a,NatureObject::Presets[natObj->Type()].walkable);
-					Map::Inst()->SetBuildable(a,false);
-					Map::Inst()->SetBlocksLight(a,!NatureObject::Presets[natObj->Type()].walkable);
-				}
+		if (Random::Generate(50) < rarity) return chosen;
+	}
+	return -1;
+}
+
+bool Game::CanGrowNatureObject(const Coordinate& pos) {
+	return Map::Inst()->IsWalkable(pos) && (Map::Inst()->GetType(pos) == TILEGRASS || Map::Inst()->GetType(pos) == TILESNOW)
+		&& Map::Inst()->GetNatureObject(pos) < 0 && Map::Inst()->GetConstruction(pos) < 0;
+}
+
+void Game::InsertNatureObject(boost::shared_ptr<NatureObject> natObj) {
+	natureList.insert(natureList.end(), std::pair<int, boost::shared_ptr<NatureObject> >(natObj->Uid(), natObj));
+	Map::Inst()->SetNatureObject(natObj->Position(), natObj->Uid());
+	Map::Inst()->SetWalkable(natObj->Position(), NatureObject::Presets[natObj->Type()].walkable);
+	Map::Inst()->SetBuildable(natObj->Position(), false);
+	Map::Inst()->SetBlocksLight(natObj->Position(), !NatureObject::Presets[natObj->Type()].walkable);
+}
+
+void Game::CreateNatureObject(Coordinate pos, int surroundingNatureObjects) {
+	int chosen = ChooseNatureObject(pos, surroundingNatureObjects);
+	if (chosen >= 0) {
+		for (int clus = 0; clus < NatureObject::Presets[chosen].cluster; ++clus) {
+			Coordinate a = Map::Inst()->Shrink(Random::ChooseInRadius(pos, clus));
+			if (CanGrowNatureObject(a)) {
+				InsertNatureObject(boost::shared_ptr<NatureObject>(new NatureObject(a, chosen)));
 			}
 		}
 	}
 }
 
 void Game::CreateNatureObject(Coordinate pos, std::string name) {
+	CreateNatureObjects(std::vector<Coordinate>(1, pos), name);
+}
+
+//Creates the named nature object on every free tile of positions, the preset is only looked up once
+void Game::CreateNatureObjects(const std::vector<Coordinate>& positions, const std::string& name) {
 	unsigned int natureObjectIndex = 0;
 	for (std::vector<NatureObjectPreset>::iterator preseti = NatureObject::Presets.begin(); preseti != NatureObject::Presets.end();
 		++preseti) {
 			if (boost::iequals(preseti->name, name)) break;
 			++natureObjectIndex;
 	}
+	if (natureObjectIndex >= NatureObject::Presets.size()) return;
+	bool ice = boost::iequals(NatureObject::Presets[natureObjectIndex].name, "Ice");
 
-	if (natureObjectIndex < NatureObject::Presets.size() && 
-		boost::iequals(NatureObject::Presets[natureObjectIndex].name, name)) {
-		if (Map::Inst()->IsInside(pos) && Map::Inst()->GetNatureObject(pos) < 0 && Map::Inst()->GetConstruction(pos) < 0) {
+	for (std::vector<Coordinate>::const_iterator pos = positions.begin(); pos != positions.end(); ++pos) {
+		if (Map::Inst()->IsInside(*pos) && Map::Inst()->GetNatureObject(*pos) < 0 && Map::Inst()->GetConstruction(*pos) < 0) {
 			boost::shared_ptr<NatureObject> natObj;
-			if (boost::iequals(NatureObject::Presets[natureObjectIndex].name, "Ice"))
-				natObj.reset(new Ice(pos , natureObjectIndex));
+			if (ice)
+				natObj.reset(new Ice(*pos, natureObjectIndex));
 			else
-				natObj.reset(new NatureObject(pos, natureObjectIndex));
-			natureList.insert(std::pair<int, boost::shared_ptr<NatureObject> >(natObj->Uid(), natObj));
-			Map::Inst()->SetNatureObject(pos,natObj->Uid());
-			Map::Inst()->SetWalkable(pos,NatureObject::Presets[natObj->Type()].walkable);
-			Map::Inst()->SetBuildable(pos,false);
-			Map::Inst()->SetBlocksLight(pos,!NatureObject::Presets[natObj->Type()].walkable);
+				natObj.reset(new NatureObject(*pos, natureObjectIndex));
+			InsertNatureObject(natObj);
 		}
 	}
 }
@@ -2346,7 +2588,7 @@ void Game::CreateDitch(Coordinate pos) {
 }
 
 void Game::StartFire(Coordinate pos) {
-	boost::shared_ptr<Job> fireJob(new Job("Start a fire", HIGH, 0, false));
+	boost::shared_ptr<Job> fireJob(Job::Create("Start a fire", HIGH, 0, false));
 	fireJob->Attempts(2);
 	fireJob->DisregardTerritory();
 	fireJob->tasks.push_back(Task(MOVEADJACENT, pos));
@@ -2440,7 +2682,7 @@ void Game::FillDitch(Coordinate a, Coordinate b) {
 			Coordinate p(x,y);
 			if (Map::Inst()->IsInside(p)) {
 				if (Map::Inst()->GetType(p) == TILEDITCH) {
-					boost::shared_ptr<Job> ditchFillJob(new Job("Fill ditch"));
+					boost::shared_ptr<Job> ditchFillJob(Job::Create("Fill ditch"));
 					ditchFillJob->DisregardTerritory();
 					ditchFillJob->Attempts(2);
 					ditchFillJob->SetRequiredTool(Item::StringToItemCategory("shovel"));
@@ -2565,6 +2807,20 @@ void Game::ProvideMap() {
 	for (std::map<int, boost::shared_ptr<Construction> >::const_iterator consIterator = dynamicConstructionList.begin(); consIterator != dynamicConstructionList.end(); ++consIterator) {
 		consIterator->second->SetMap(Map::Inst());
 	}
+
+	//Per-tile uid sets aren't saved, fill them in one go instead of inserting entity by entity
+	std::vector<std::pair<Coordinate, int> > npcPositions, itemPositions;
+	npcPositions.reserve(npcList.size());
+	for (std::map<int, boost::shared_ptr<NPC> >::const_iterator npcIterator = npcList.begin(); npcIterator != npcList.end(); ++npcIterator) {
+		npcPositions.push_back(std::make_pair(npcIterator->second->Position(), npcIterator->first));
+	}
+	itemPositions.reserve(itemList.size());
+	for (std::map<int,boost::shared_ptr<Item> >::const_iterator itemIterator = itemList.begin(); itemIterator != itemList.end(); ++itemIterator) {
+		if (!itemIterator->second->internal && !itemIterator->second->container.lock()) {
+			itemPositions.push_back(std::make_pair(itemIterator->second->Position(), itemIterator->first));
+		}
+	}
+	Map::Inst()->RebuildEntityLists(npcPositions, itemPositions);
 }
 
 void Game::save(OutputArchive& ar, const unsigned int version) const  {
@@ -2602,10 +2858,13 @@ void Game::save(OutputArchive& ar, const unsigned int version) const  {
 	ar & waterList;
 	ar & filthList;
 	ar & bloodList;
-	ar & fireList;
+	std::list<boost::weak_ptr<FireNode> > fires(fireList.begin(), fireList.end());
+	ar & fires;
 	ar & spellList;
 	ar & age;
 	ar & Stats::instance;
+	ar & npcTimers;
+	ar & waterTimers;
 }
 
 void Game::load(InputArchive& ar, const unsigned int version) {
@@ -2662,6 +2921,10 @@ void Game::load(InputArchive& ar, const unsigned int version) {
 	ar & staticConstructionList;
 	ar & dynamicConstructionList;
 	ar & itemList;
+	decayTimers.Clear();
+	for (std::map<int,boost::shared_ptr<Item> >::iterator itemi = itemList.begin(); itemi != itemList.end(); ++itemi) {
+		ScheduleDecay(itemi->second);
+	}
 	ar & freeItems;
 	ar & flyingItems;
 	ar & stoppedItems;
@@ -2669,10 +2932,26 @@ void Game::load(InputArchive& ar, const unsigned int version) {
 	ar & waterList;
 	ar & filthList;
 	ar & bloodList;
-	ar & fireList;
+	std::list<boost::weak_ptr<FireNode> > fires;
+	ar & fires;
+	fireList.assign(fires.begin(), fires.end());
 	ar & spellList;
 	ar & age;
 	if (version >= 1) {
 		ar & Stats::instance;
 	}
+	if (version >= 2) {
+		ar & npcTimers;
+		ar & waterTimers;
+		waterTimers.ForEach([](const boost::weak_ptr<WaterNode>& water) {
+			if (boost::shared_ptr<WaterNode> node = water.lock()) node->UpdateScheduled(true);
+		});
+	} else {
+		for (std::map<int, boost::shared_ptr<NPC> >::iterator npci = npcList.begin(); npci != npcList.end(); ++npci) {
+			ScheduleNPCTimers(npci->first);
+		}
+		for (std::list<boost::weak_ptr<WaterNode> >::iterator wati = waterList.begin(); wati != waterList.end(); ++wati) {
+			if (boost::shared_ptr<WaterNode> water = wati->lock()) ScheduleWater(water);
+		}
+	}
 }
@@ -0,0 +1,95 @@
+/* Copyright 2010-2011 Ilkka Halila
+This file is part of Goblins' Lot (former Goblin Camp)
+
+Goblin Camp is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Goblin Camp is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
+#include "stdafx.hpp"
+
+#include "GroupPath.hpp"
+
+namespace {
+	//Appends the tiles from start (exclusive) to end (inclusive) onto path
+	bool Search(TCODPath& search, const Coordinate& start, const Coordinate& end, std::vector<Coordinate>& path) {
+		if (start == end) return true;
+		if (!search.compute(start.X(), start.Y(), end.X(), end.Y())) return false;
+		for (int i = 0; i < search.size(); ++i) {
+			Coordinate p;
+			search.get(i, p.Xptr(), p.Yptr());
+			path.push_back(p);
+		}
+		return true;
+	}
+}
+
+GroupPath::GroupPath() : state(PENDING), route() {}
+
+GroupPath::State GroupPath::Enlist() {
+#if GCAMP_USE_THREADS
+	std::lock_guard<std::mutex> lock(stateMutex);
+#endif
+	if (state == PENDING) {
+		state = LEADING;
+		return LEADING;
+	}
+	//Once someone leads, the others wait until it's done
+	return state == LEADING ? PENDING : state;
+}
+
+GroupPath::State GroupPath::GetState() {
+#if GCAMP_USE_THREADS
+	std::lock_guard<std::mutex> lock(stateMutex);
+#endif
+	return state == LEADING ? PENDING : state;
+}
+
+void GroupPath::Publish(const std::vector<Coordinate>* path) {
+#if GCAMP_USE_THREADS
+	std::lock_guard<std::mutex> lock(stateMutex);
+#endif
+	if (state != LEADING) return;
+	if (path && !path->empty()) {
+		route = *path;
+		state = READY;
+	} else {
+		state = FAILED;
+	}
+}
+
+size_t GroupPath::Closest(const Coordinate& p, size_t first) const {
+	size_t closest = first;
+	for (size_t i = first + 1; i < route.size(); ++i) {
+		if (Distance(route[i], p) < Distance(route[closest], p)) closest = i;
+	}
+	return closest;
+}
+
+bool GroupPath::Follow(const Coordinate& start, const Coordinate& target, const Coordinate& extent,
+	const ITCODPathCallback* map, void* walker, std::vector<Coordinate>& path) const {
+	if (route.empty()) return false;
+
+	size_t entry = Closest(start, 0);
+	if (Distance(route[entry], start) > JoinDistance) return false;
+	size_t exit = Closest(target, entry);
+	if (Distance(route[exit], target) > JoinDistance) return false;
+
+	//The map may have changed since the leader searched
+	for (size_t i = entry + 1; i <= exit; ++i) {
+		if (map->getWalkCost(route[i-1].X(), route[i-1].Y(), route[i].X(), route[i].Y(), walker) <= 0.0f) return false;
+	}
+
+	TCODPath search(extent.X(), extent.Y(), map, walker);
+	path.clear();
+	if (!Search(search, start, route[entry], path)) return false;
+	path.insert(path.end(), route.begin() + entry + 1, route.begin() + exit + 1);
+	return Search(search, route[exit], target, path);
+}
@@ -25,6 +25,11 @@ along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
 #endif
 
 #include <boost/serialization/weak_ptr.hpp>
+#include <boost/serialization/map.hpp>
+#include <boost/serialization/set.hpp>
+#include <boost/serialization/list.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/serialization/utility.hpp>
 
 #include "Random.hpp"
 #include "Item.hpp"
@@ -50,6 +55,7 @@ Item::Item(const Coordinate& startPos, ItemType typeval, int owner, std::vector<
 	type(typeval),
 	flammable(false),
 	decayCounter(-1),
+	decayScheduled(0),
 
 	attemptedStore(false),
 	container(boost::weak_ptr<Item>()),
@@ -61,7 +67,6 @@ Item::Item(const Coordinate& startPos, ItemType typeval, int owner, std::vector<
 	//Remember that the components are destroyed after this constructor!
 	if (type >= 0 && type < static_cast<int>(Item::Presets.size())) {
 		name = Item::Presets[type].name;
-		categories = Item::Presets[type].categories;
 		graphic = Item::Presets[type].graphic;
 		color = Item::Presets[type].color;
 		if (Item::Presets[type].decays) decayCounter = Item::Presets[type].decaySpeed;
@@ -77,7 +82,7 @@ Item::Item(const Coordinate& startPos, ItemType typeval, int owner, std::vector<
 
 		//Calculate flammability based on categorical flammability, and then modify it based on components
 		int flame = 0;
-		for (std::set<ItemCategory>::iterator cati = categories.begin(); cati != categories.end(); ++cati) {
+		for (std::set<ItemCategory>::iterator cati = Item::Presets[type].categories.begin(); cati != Item::Presets[type].categories.end(); ++cati) {
 			if (Item::Categories[*cati].flammable) flame += 2;
 			else --flame;
 		}
@@ -138,7 +143,10 @@ void Item::Draw(Coordinate upleft, TCODConsole* console) {
 }
 
 ItemType Item::Type() {return type;}
-bool Item::IsCategory(ItemCategory category) { return (categories.find(category) != categories.end());}
+bool Item::IsCategory(ItemCategory category) const {
+	const boost::dynamic_bitset<>& bits = categoryOverride.empty() ? Item::Presets[type].categoryBits : categoryOverride;
+	return category >= 0 && static_cast<size_t>(category) < bits.size() && bits[category];
+}
 TCODColor Item::Color() {return color;}
 void Item::Color(TCODColor col) {color = col;}
 
@@ -509,6 +517,20 @@ void Item::LoadPresets(std::string filename) {
 	parser.run(filename.c_str(), &itemListener);
 	itemListener.translateNames();
 	UpdateEffectItems();
+	UpdateCategoryBits();
+}
+
+//Gives every preset its categories as a bitset, closed over the parent chain
+void Item::UpdateCategoryBits() {
+	for (std::vector<ItemPreset>::iterator preseti = Presets.begin(); preseti != Presets.end(); ++preseti) {
+		preseti->categoryBits.clear();
+		preseti->categoryBits.resize(Categories.size());
+		for (std::set<ItemCategory>::iterator cati = preseti->categories.begin(); cati != preseti->categories.end(); ++cati) {
+			for (ItemCategory cat = *cati; cat >= 0 && cat < static_cast<int>(Categories.size()) && !preseti->categoryBits[cat]; cat = Categories[cat].parent) {
+				preseti->categoryBits[cat] = true;
+			}
+		}
+	}
 }
 
 void Item::ResolveContainers() {
@@ -584,20 +606,15 @@ void Item::UpdateVelocity() {
 					Coordinate t = flightPath.back().coord;
 
 					if (map->BlocksWater(t) || !map->IsWalkable(t)) { //We've hit an obstacle
-						Attack attack = GetAttack();
 						if (map->GetConstruction(t) > -1) {
-							if (boost::shared_ptr<Construction> construct = Game::Inst()->GetConstruction(map->GetConstruction(t)).lock()) {
-								construct->Damage(&attack);
-							}
+							Game::Inst()->QueueHit(Game::Inst()->GetConstruction(map->GetConstruction(t)), GetAttack());
 						}
 						Impact(velocity);
 						return;
 					}
 					if (map->NPCList(t)->size() > 0) { //Hit a creature
 						if (Random::Generate(std::max(1, flightPath.back().height) - 1) < (signed int)(2 + map->NPCList(t)->size())) {
-							Attack attack = GetAttack();
-							boost::shared_ptr<NPC> npc = Game::Inst()->GetNPC(*map->NPCList(t)->begin());
-							npc->Damage(&attack);
+							Game::Inst()->QueueHit(Game::Inst()->GetNPC(*map->NPCList(t)->begin()), GetAttack());
 
 							Position(flightPath.back().coord);
 							Impact(velocity);
@@ -621,7 +638,41 @@ void Item::UpdateVelocity() {
 
 void Item::SetInternal() { internal = true; }
 
-int Item::GetDecay() const { return decayCounter; }
+int Item::GetDecay() const {
+	if (decayCounter <= 0) return decayCounter;
+	return decayCounter - static_cast<int>(Game::Inst()->DecayClock() - decayScheduled);
+}
+
+/* Reapplies the preset-derived properties for a new type, keeping the uid. Take the item out
+   of its container first and put it back afterwards, so that bulk and stockpile counts follow. */
+void Item::ChangeType(ItemType newType) {
+	type = newType;
+	const ItemPreset& preset = Item::Presets[type];
+	name = preset.name;
+	categoryOverride.clear();
+	graphic = preset.graphic;
+	color = preset.color;
+	attack = preset.attack;
+	for (int i = 0; i < RES_COUNT; ++i) {
+		resistances[i] = preset.resistances[i];
+	}
+	bulk = preset.bulk;
+	condition = preset.condition;
+
+	int flame = 0;
+	for (std::set<ItemCategory>::iterator cati = preset.categories.begin(); cati != preset.categories.end(); ++cati) {
+		if (Item::Categories[*cati].flammable) flame += 2;
+		else --flame;
+	}
+	for (int i = 0; i < (signed int)preset.components.size(); ++i) {
+		if (Item::Categories[preset.components[i]].flammable) flame += 3;
+		else --flame;
+	}
+	flammable = flame > 0;
+
+	decayCounter = preset.decays ? preset.decaySpeed : -1;
+	Game::Inst()->ScheduleDecay(boost::static_pointer_cast<Item>(shared_from_this()));
+}
 
 void Item::Impact(int speedChange) {
 	SetVelocity(0);
@@ -669,15 +720,17 @@ void Item::save(OutputArchive& ar, const unsigned int version) const {
 	ar & color.r;
 	ar & color.g;
 	ar & color.b;
-	int categoryCount = (int)categories.size();
+	const boost::dynamic_bitset<>& bits = categoryOverride.empty() ? Item::Presets[type].categoryBits : categoryOverride;
+	int categoryCount = (int)bits.count();
 	ar & categoryCount;
-	for (std::set<ItemCategory>::iterator cati = categories.begin(); cati != categories.end(); ++cati) {
-		std::string itemCat(Item::ItemCategoryToString(*cati));
+	for (size_t cat = bits.find_first(); cat != boost::dynamic_bitset<>::npos; cat = bits.find_next(cat)) {
+		std::string itemCat(Item::ItemCategoryToString(static_cast<ItemCategory>(cat)));
 		ar & itemCat;
 	}
 	ar & flammable;
 	ar & attemptedStore;
-	ar & decayCounter;
+	int decay = GetDecay();
+	ar & decay;
 	ar & attack;
 	ar & resistances;
 	ar & condition;
@@ -701,16 +754,19 @@ void Item::load(InputArchive& ar, const unsigned int version) {
 	ar & color.b;
 	int categoryCount = 0;
 	ar & categoryCount;
-	categories.clear();
+	boost::dynamic_bitset<> bits(Item::Categories.size());
 	for (int i = 0; i < categoryCount; ++i) {
 		std::string categoryName;
 		ar & categoryName;
 		int categoryType = Item::StringToItemCategory(categoryName);
 		if (categoryType >= 0 && categoryType < static_cast<int>(Item::Categories.size()))
-			categories.insert(categoryType);
+			bits[categoryType] = true;
 	}
-	if (categories.empty())
-		categories.insert(Item::StringToItemCategory("garbage"));
+	if (bits.none())
+		bits[Item::StringToItemCategory("garbage")] = true;
+	//Only keep the categories if the preset's have changed since the item was saved
+	categoryOverride.clear();
+	if (bits != Item::Presets[type].categoryBits) categoryOverride.swap(bits);
 	ar & flammable;
 	if (failedToFindType)
 		flammable = true; //Just so you can get rid of it
@@ -758,6 +814,124 @@ ItemPreset::ItemPreset() : graphic('?'),
 	}
 }
 
+bool ItemPreset::IsCategory(ItemCategory category) const {
+	return category >= 0 && static_cast<size_t>(category) < categoryBits.size() && categoryBits[category];
+}
+
+void ItemCat::save(OutputArchive& ar, const unsigned int version) const {
+	ar & flammable;
+	ar & name;
+	ar & parent;
+}
+
+void ItemCat::load(InputArchive& ar, const unsigned int version) {
+	ar & flammable;
+	ar & name;
+	ar & parent;
+}
+
+//categoryBits aren't stored, Item::LoadPresetCache rebuilds them
+void ItemPreset::save(OutputArchive& ar, const unsigned int version) const {
+	ar & graphic;
+	ar & color.r;
+	ar & color.g;
+	ar & color.b;
+	ar & name;
+	ar & specificCategories;
+	ar & categories;
+	ar & components;
+	ar & nutrition;
+	ar & growth;
+	ar & fruits;
+	ar & organic;
+	ar & container;
+	ar & multiplier;
+	ar & fitsInRaw;
+	ar & containInRaw;
+	ar & constructedInRaw;
+	ar & fitsin;
+	ar & containIn;
+	ar & decays;
+	ar & decaySpeed;
+	ar & decayList;
+	ar & attack;
+	ar & resistances;
+	ar & bulk;
+	ar & condition;
+	ar & fallbackGraphicsSet;
+	ar & graphicsHint;
+	ar & addsEffects;
+	ar & removesEffects;
+}
+
+void ItemPreset::load(InputArchive& ar, const unsigned int version) {
+	ar & graphic;
+	ar & color.r;
+	ar & color.g;
+	ar & color.b;
+	ar & name;
+	ar & specificCategories;
+	ar & categories;
+	ar & components;
+	ar & nutrition;
+	ar & growth;
+	ar & fruits;
+	ar & organic;
+	ar & container;
+	ar & multiplier;
+	ar & fitsInRaw;
+	ar & containInRaw;
+	ar & constructedInRaw;
+	ar & fitsin;
+	ar & containIn;
+	ar & decays;
+	ar & decaySpeed;
+	ar & decayList;
+	ar & attack;
+	ar & resistances;
+	ar & bulk;
+	ar & condition;
+	ar & fallbackGraphicsSet;
+	ar & graphicsHint;
+	ar & addsEffects;
+	ar & removesEffects;
+}
+
+//The item tables as they are after loading every mod, see PresetCache
+void Item::SavePresetCache(OutputArchive& ar) {
+	ar & Categories;
+	ar & ParentCategories;
+	ar & Presets;
+	std::map<std::string, ItemType> typeNames(itemTypeNames.begin(), itemTypeNames.end());
+	ar & typeNames;
+	std::map<std::string, ItemCategory> categoryNames(itemCategoryNames.begin(), itemCategoryNames.end());
+	ar & categoryNames;
+	ar & EffectRemovers;
+	ar & GoodEffectAdders;
+}
+
+void Item::LoadPresetCache(InputArchive& ar) {
+	Categories.clear();
+	ParentCategories.clear();
+	Presets.clear();
+	ar & Categories;
+	ar & ParentCategories;
+	ar & Presets;
+	std::map<std::string, ItemType> typeNames;
+	ar & typeNames;
+	itemTypeNames = boost::unordered_map<std::string, ItemType>(typeNames.begin(), typeNames.end());
+	std::map<std::string, ItemCategory> categoryNames;
+	ar & categoryNames;
+	itemCategoryNames = boost::unordered_map<std::string, ItemCategory>(categoryNames.begin(), categoryNames.end());
+	EffectRemovers.clear();
+	GoodEffectAdders.clear();
+	ar & EffectRemovers;
+	ar & GoodEffectAdders;
+	Game::ItemTypeCount = static_cast<int>(Presets.size());
+	Game::ItemCatCount = static_cast<int>(Categories.size());
+	UpdateCategoryBits();
+}
+
 OrganicItem::OrganicItem(Coordinate pos, ItemType typeVal) : Item(pos, typeVal),
 	nutrition(-1),
 	growth(-1)
@@ -769,6 +943,14 @@ void OrganicItem::Nutrition(int val) { nutrition = val; }
 ItemType OrganicItem::Growth() { return growth; }
 void OrganicItem::Growth(ItemType val) { growth = val; }
 
+//Turns the plant into its next growth stage in place, see Item::ChangeType
+void OrganicItem::Grow() {
+	if (growth < 0) return;
+	ChangeType(growth);
+	nutrition = Item::Presets[Type()].nutrition;
+	growth = Item::Presets[Type()].growth;
+}
+
 void OrganicItem::save(OutputArchive& ar, const unsigned int version) const {
 	ar & boost::serialization::base_object<Item>(*this);
 	ar & nutrition;
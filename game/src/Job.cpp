@@ -32,6 +32,9 @@ along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
 #include <boost/serialization/weak_ptr.hpp>
 #include <boost/serialization/list.hpp>
 #include <boost/serialization/vector.hpp>
+#include <boost/unordered_set.hpp>
+#include <boost/pool/pool_alloc.hpp>
+#include <boost/make_shared.hpp>
 
 #include "Job.hpp"
 #include "Announce.hpp"
@@ -68,7 +71,16 @@ void Task::load(InputArchive& ar, const unsigned int version) {
 	ar & flags;
 }
 
-Job::Job(std::string value, JobPriority pri, int z, bool m) :
+namespace {
+	//The set's nodes never move, so the names can be pointed to
+	boost::unordered_set<std::string> jobNames;
+
+	const std::string* InternJobName(const std::string& name) {
+		return &*jobNames.insert(name).first;
+	}
+}
+
+Job::Job(const std::string& value, JobPriority pri, int z, bool m) :
 	_priority(pri),
 	completion(ONGOING),
 	parent(boost::weak_ptr<Job>()),
@@ -88,12 +100,17 @@ Job::Job(std::string value, JobPriority pri, int z, bool m) :
 	markedGround(undefined),
 	obeyTerritory(true),
 	fireAllowed(false),
-	name(value),
-	tasks(std::vector<Task>()),
+	name(InternJobName(value)),
 	internal(false)
 {
 }
 
+boost::shared_ptr<Job> Job::Create(const std::string& value, JobPriority pri, int z, bool m) {
+	return boost::allocate_shared<Job>(boost::fast_pool_allocator<Job>(), value, pri, z, m);
+}
+
+const std::string& Job::Name() const { return *name; }
+
 Job::~Job() {
 	preReqs.clear();
 	UnreserveEntities();
@@ -245,7 +262,7 @@ void Job::DisregardTerritory() { obeyTerritory = false; }
 
 bool Job::OutsideTerritory() {
 	if (obeyTerritory) {
-		for (std::vector<Task>::iterator task = tasks.begin(); task != tasks.end(); ++task) {
+		for (TaskList::iterator task = tasks.begin(); task != tasks.end(); ++task) {
 			Coordinate coord = task->target;
 			if (!Map::Inst()->IsInside(coord)) {
 				if (task->entity.lock()) {
@@ -268,7 +285,7 @@ void Job::AddMapMarker(MapMarker marker) {
 void Job::AllowFire() { fireAllowed = true; }
 bool Job::InvalidFireAllowance() {
 	if (!fireAllowed) {
-		for (std::vector<Task>::iterator task = tasks.begin(); task != tasks.end(); ++task) {
+		for (TaskList::iterator task = tasks.begin(); task != tasks.end(); ++task) {
 			Coordinate coord = task->target;
 			if (!Map::Inst()->IsInside(coord)) {
 				if (task->entity.lock()) {
@@ -359,8 +376,10 @@ void Job::save(OutputArchive& ar, const unsigned int version) const {
 	ar & reservedContainer;
 	ar & reservedSpace;
 	ar & tool;
-	ar & name;
-	ar & tasks;
+	ar & *name;
+	//Saved as a std::vector, as before
+	const std::vector<Task> savedTasks(tasks.begin(), tasks.end());
+	ar & savedTasks;
 	ar & internal;
 	ar & markedGround;
 	ar & obeyTerritory;
@@ -398,8 +417,12 @@ void Job::load(InputArchive& ar, const unsigned int version) {
 	ar & reservedContainer;
 	ar & reservedSpace;
 	ar & tool;
-	ar & name;
-	ar & tasks;
+	std::string loadedName;
+	ar & loadedName;
+	name = InternJobName(loadedName);
+	std::vector<Task> loadedTasks;
+	ar & loadedTasks;
+	tasks.assign(loadedTasks.begin(), loadedTasks.end());
 	ar & internal;
 	ar & markedGround;
 	ar & obeyTerritory;
@@ -32,8 +32,9 @@ along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
 #include "KuhnMunkres.hpp"
 #include "StockManager.hpp"
 #include "Color.hpp"
+#include "Map.hpp"
 
-JobManager::JobManager() {
+JobManager::JobManager() : jobsByTargetPruned(0) {
 	for (std::vector<ItemCat>::iterator i = Item::Categories.begin(); i != Item::Categories.end(); ++i) {
 		toolJobs.push_back(std::vector<boost::weak_ptr<Job> >());
 	}
@@ -45,6 +46,47 @@ JobManager *JobManager::Inst() {
 	return instance;
 }
 
+void JobManager::Enqueue(JobList& list, boost::shared_ptr<Job> job) {
+	queued[job.get()] = std::make_pair(&list, list.insert(list.end(), job));
+	IndexTargets(job);
+}
+
+JobManager::JobList::iterator JobManager::Dequeue(JobList& list, JobList::iterator jobi) {
+	//The job may have been queued elsewhere already, only forget it if it was queued here
+	boost::unordered_map<Job*, std::pair<JobList*, JobList::iterator> >::iterator position = queued.find(jobi->get());
+	if (position != queued.end() && position->second.second == jobi) queued.erase(position);
+	return list.erase(jobi);
+}
+
+void JobManager::IndexTargets(boost::shared_ptr<Job> job) {
+	for (Job::TaskList::iterator taski = job->tasks.begin(); taski != job->tasks.end(); ++taski) {
+		std::pair<Action, Coordinate> key(taski->action, taski->target);
+		bool indexed = false;
+		for (std::multimap<std::pair<Action, Coordinate>, boost::weak_ptr<Job> >::iterator entry = jobsByTarget.lower_bound(key);
+			entry != jobsByTarget.end() && entry->first == key; ++entry) {
+			if (entry->second.lock() == job) {
+				indexed = true;
+				break;
+			}
+		}
+		if (!indexed) jobsByTarget.insert(std::make_pair(key, boost::weak_ptr<Job>(job)));
+	}
+	if (jobsByTarget.size() > 2 * jobsByTargetPruned + 256) PruneTargets();
+}
+
+//Drops the entries of jobs that are no longer queued
+void JobManager::PruneTargets() {
+	for (std::multimap<std::pair<Action, Coordinate>, boost::weak_ptr<Job> >::iterator entry = jobsByTarget.begin(); entry != jobsByTarget.end();) {
+		boost::shared_ptr<Job> job = entry->second.lock();
+		if (!job || queued.find(job.get()) == queued.end()) {
+			jobsByTarget.erase(entry++);
+		} else {
+			++entry;
+		}
+	}
+	jobsByTargetPruned = jobsByTarget.size();
+}
+
 void JobManager::AddJob(boost::shared_ptr<Job> newJob) {
 	if (!newJob->Attempt() || newJob->OutsideTerritory() || newJob->InvalidFireAllowance()) {
 		failList.push_back(newJob);
@@ -52,11 +94,11 @@ void JobManager::AddJob(boost::shared_ptr<Job> newJob) {
 	}
 
 	if (newJob->PreReqsCompleted()) {
-		availableList[newJob->priority()].push_back(newJob);
+		Enqueue(availableList[newJob->priority()], newJob);
 		return;
 	} else {
 		newJob->Paused(true);
-		waitingList.push_back(newJob);
+		Enqueue(waitingList, newJob);
 	}
 }
 
@@ -65,18 +107,15 @@ void JobManager::CancelJob(boost::weak_ptr<Job> oldJob, std::string msg, TaskRes
 		job->Assign(-1);
 		job->Paused(true);
 
-		//Push job onto waiting list
-		waitingList.push_back(job);
-
 		//Remove job from availabe list
-		for(std::list<boost::shared_ptr<Job> >::iterator jobi = availableList[job->priority()].begin(); 
-			jobi != availableList[job->priority()].end(); ++jobi) {
-				if ((*jobi) == job) {
-					availableList[job->priority()].erase(jobi);
-					break;
-				}
+		boost::unordered_map<Job*, std::pair<JobList*, JobList::iterator> >::iterator position = queued.find(job.get());
+		if (position != queued.end() && position->second.first == &availableList[job->priority()]) {
+			Dequeue(availableList[job->priority()], position->second.second);
 		}
 
+		//Push job onto waiting list
+		Enqueue(waitingList, job);
+
 		//If the job requires a tool, remove it from the toolJobs list
 		if (job->RequiresTool()) {
 			for (std::vector<boost::weak_ptr<Job> >::iterator jobi = toolJobs[job->GetRequiredTool()].begin(); 
@@ -106,7 +145,7 @@ void JobManager::Draw(Coordinate pos, int from, int width, int height, TCODConso
 				if (npc) { 
 					console->print(pos.X(), y, "%c", npc->GetNPCSymbol());
 				}
-				console->print(pos.X() + 2, y, "%s", (*jobi)->name.c_str());
+				console->print(pos.X() + 2, y, "%s", (*jobi)->Name().c_str());
 
 #if DEBUG
 				if (npc) {
@@ -154,7 +193,7 @@ void JobManager::Update() {
 	for (std::list<boost::shared_ptr<Job> >::iterator jobIter = waitingList.begin(); jobIter != waitingList.end(); ) {
 
 		if ((*jobIter)->Removable()) {
-			jobIter = waitingList.erase(jobIter);
+			jobIter = Dequeue(waitingList, jobIter);
 		} else {
 
 			if (!(*jobIter)->PreReqs()->empty() && (*jobIter)->PreReqsCompleted()) {
@@ -163,7 +202,7 @@ void JobManager::Update() {
 
 			if (!(*jobIter)->Paused()) {
 				AddJob(*jobIter);
-				jobIter = waitingList.erase(jobIter);
+				jobIter = Dequeue(waitingList, jobIter);
 			} else {
 				if (!(*jobIter)->Parent().lock() && !(*jobIter)->PreReqs()->empty()) {
 					//Job has unfinished prereqs, itsn't removable and is NOT a prereq itself
@@ -186,7 +225,7 @@ void JobManager::Update() {
 		for (std::list<boost::shared_ptr<Job> >::iterator jobi = availableList[i].begin();
 			jobi != availableList[i].end(); ) {
 				if ((*jobi)->Completed() && (*jobi)->PreReqsCompleted()) {
-					jobi = availableList[i].erase(jobi);
+					jobi = Dequeue(availableList[i], jobi);
 				} else {
 					++jobi;
 				}
@@ -236,19 +275,9 @@ boost::weak_ptr<Job> JobManager::GetJobByListIndex(int index) {
 
 void JobManager::RemoveJob(boost::weak_ptr<Job> wjob) {
 	if (boost::shared_ptr<Job> job = wjob.lock()) {
-		for (int i = 0; i < PRIORITY_COUNT; ++i) {
-			for (std::list<boost::shared_ptr<Job> >::iterator jobi = availableList[i].begin(); jobi != availableList[i].end(); ++jobi) {
-				if (*jobi == job) {
-					jobi = availableList[i].erase(jobi);
-					return;
-				}
-			}
-		}
-		for (std::list<boost::shared_ptr<Job> >::iterator jobi = waitingList.begin(); jobi != waitingList.end(); ++jobi) {
-			if (*jobi == job) {
-				jobi = waitingList.erase(jobi);
-				return;
-			}
+		boost::unordered_map<Job*, std::pair<JobList*, JobList::iterator> >::iterator position = queued.find(job.get());
+		if (position != queued.end()) {
+			Dequeue(*position->second.first, position->second.second);
 		}
 	}
 }
@@ -305,6 +334,14 @@ void JobManager::ClearWaitingNpcs() {
 	menialNPCsWaiting.clear();
 }
 
+namespace {
+	//Jobs that begin by walking somewhere the npc can't get to would only fail
+	bool Unreachable(boost::shared_ptr<NPC> npc, boost::shared_ptr<Job> job) {
+		return !job->tasks.empty() && job->tasks[0].action == MOVE && npc->BoundToWalkableArea()
+			&& !Map::Inst()->Reachable(npc->Position(), job->tasks[0].target);
+	}
+}
+
 void JobManager::AssignJobs() {
 	//It's useless to attempt to assing more tool-required jobs than there are tools 
 	std::vector<int> maxToolJobs(Item::Categories.size());
@@ -345,7 +382,8 @@ void JobManager::AssignJobs() {
 							boost::shared_ptr<Job> job = menialJobsToAssign[y];
 							boost::shared_ptr<NPC> npc = Game::Inst()->GetNPC(menialNPCsWaiting[x]);
 							if(!npc || job->tasks.empty() ||
-								(job->tasks[0].target.X() == 0 && job->tasks[0].target.Y() == 0)) {
+								(job->tasks[0].target.X() == 0 && job->tasks[0].target.Y() == 0) ||
+								Unreachable(npc, job)) {
 								menialMatrix(x, y) = 1;
 							} else if (npc) {
 								menialMatrix(x, y) = 10000 - Distance(job->tasks[0].target, npc->Position());
@@ -367,7 +405,8 @@ void JobManager::AssignJobs() {
 							boost::shared_ptr<Job> job = expertJobsToAssign[y];
 							boost::shared_ptr<NPC> npc = Game::Inst()->GetNPC(expertNPCsWaiting[x]);
 							if(!npc || job->tasks.empty() ||
-							   (job->tasks[0].target.X() == 0 && job->tasks[0].target.Y() == 0)) {
+							   (job->tasks[0].target.X() == 0 && job->tasks[0].target.Y() == 0) ||
+							   Unreachable(npc, job)) {
 								expertMatrix(x, y) = 1;
 							} else {
 								expertMatrix(x, y) = 10000 - Distance(job->tasks[0].target, npc->Position());
@@ -389,7 +428,7 @@ void JobManager::AssignJobs() {
 						int npcNum = menialNPCsWaiting[n];
 						boost::shared_ptr<Job> job = menialJobsToAssign[jobNum];
 						boost::shared_ptr<NPC> npc = Game::Inst()->GetNPC(npcNum);
-						if (job && npc) {
+						if (job && npc && !Unreachable(npc, job)) {
 							job->Assign(npcNum);
 							menialNPCsWaiting.erase(menialNPCsWaiting.begin() + n);
 							n--;
@@ -406,7 +445,7 @@ void JobManager::AssignJobs() {
 						int npcNum = expertNPCsWaiting[n];
 						boost::shared_ptr<Job> job = expertJobsToAssign[jobNum];
 						boost::shared_ptr<NPC> npc = Game::Inst()->GetNPC(npcNum);
-						if (job && npc) {
+						if (job && npc && !Unreachable(npc, job)) {
 							job->Assign(npcNum);
 							expertNPCsWaiting.erase(expertNPCsWaiting.begin() + n);
 							n--;
@@ -423,29 +462,34 @@ void JobManager::AssignJobs() {
 }
 
 void JobManager::RemoveJob(Action action, Coordinate location) {
-	for (int i = 0; i <= PRIORITY_COUNT; ++i) {
-		for (std::list<boost::shared_ptr<Job> >::iterator jobi = (i < PRIORITY_COUNT ? availableList[i].begin() : waitingList.begin()); 
-			jobi != (i < PRIORITY_COUNT ? availableList[i].end() : waitingList.end());) {
-				bool remove = false;
-				for (std::vector<Task>::iterator taski = (*jobi)->tasks.begin(); taski != (*jobi)->tasks.end(); ++taski) {
-					if (taski->action == action && taski->target == location) {
-						remove = true;
-						break;
-					}
-				}
-				if (remove) {
-					(*jobi)->Attempts(0);
-					if ((*jobi)->Assigned() >= 0) {
-						boost::shared_ptr<NPC> npc = Game::Inst()->GetNPC((*jobi)->Assigned());
-						boost::weak_ptr<Job> jobToRemove = *jobi;
-						++jobi; //AbortJob will cancel the job and the invalidate the old iterator
-						if (npc) npc->AbortJob(jobToRemove);
-					} else {
-						jobi = (i < PRIORITY_COUNT ? availableList[i].erase(jobi) : waitingList.erase(jobi));
-					}
-				} else {
-					++jobi;
-				}
+	std::pair<Action, Coordinate> key(action, location);
+	std::vector<boost::shared_ptr<Job> > matches;
+	for (std::multimap<std::pair<Action, Coordinate>, boost::weak_ptr<Job> >::iterator entry = jobsByTarget.lower_bound(key);
+		entry != jobsByTarget.end() && entry->first == key;) {
+		boost::shared_ptr<Job> job = entry->second.lock();
+		if (!job || queued.find(job.get()) == queued.end()) {
+			jobsByTarget.erase(entry++);
+			continue;
+		}
+		//Tasks can change after the job was queued
+		for (Job::TaskList::iterator taski = job->tasks.begin(); taski != job->tasks.end(); ++taski) {
+			if (taski->action == action && taski->target == location) {
+				matches.push_back(job);
+				break;
+			}
+		}
+		++entry;
+	}
+
+	for (std::vector<boost::shared_ptr<Job> >::iterator jobi = matches.begin(); jobi != matches.end(); ++jobi) {
+		boost::shared_ptr<Job> job = *jobi;
+		job->Attempts(0);
+		if (job->Assigned() >= 0) {
+			if (boost::shared_ptr<NPC> npc = Game::Inst()->GetNPC(job->Assigned())) npc->AbortJob(job);
+		} else {
+			//Aborting an earlier match may have moved or removed this one
+			boost::unordered_map<Job*, std::pair<JobList*, JobList::iterator> >::iterator position = queued.find(job.get());
+			if (position != queued.end()) Dequeue(*position->second.first, position->second.second);
 		}
 	}
 }
@@ -482,4 +526,12 @@ void JobManager::load(InputArchive& ar, const unsigned int version) {
 	ar & expertNPCsWaiting;
 	ar & toolJobs;
 	ar & failList;
+
+	for (int i = 0; i <= PRIORITY_COUNT; ++i) {
+		JobList& list = i < PRIORITY_COUNT ? availableList[i] : waitingList;
+		for (JobList::iterator jobi = list.begin(); jobi != list.end(); ++jobi) {
+			queued[jobi->get()] = std::make_pair(&list, jobi);
+			IndexTargets(*jobi);
+		}
+	}
 }
@@ -27,6 +27,9 @@ along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
 #include <boost/serialization/list.hpp>
 #include <boost/serialization/shared_ptr.hpp>
 #include <boost/serialization/utility.hpp>
+#include <boost/serialization/set.hpp>
+#include <boost/serialization/array.hpp>
+#include <boost/cstdint.hpp>
 
 #include "Random.hpp"
 #include "Map.hpp"
@@ -40,27 +43,43 @@ along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
 #include "Weather.hpp"
 #include "GCamp.hpp"
 #include "Color.hpp"
-
-static const int HARDCODED_WIDTH = 500;
-static const int HARDCODED_HEIGHT = 500;
+#include "Parallel.hpp"
+#include "data/Config.hpp"
 
 Map::Map() :
-overlayFlags(0), markerids(0) {
-	tileMap.resize(boost::extents[HARDCODED_WIDTH][HARDCODED_HEIGHT]);
-	cachedTileMap.resize(boost::extents[HARDCODED_WIDTH][HARDCODED_HEIGHT]);
-	heightMap = new TCODHeightMap(HARDCODED_WIDTH,HARDCODED_HEIGHT);
-	extent = Coordinate(HARDCODED_WIDTH, HARDCODED_HEIGHT);
-	for (int i = 0; i < HARDCODED_WIDTH; ++i) {
-		for (int e = 0; e < HARDCODED_HEIGHT; ++e) {
-			tileMap[i][e].ResetType(TILEGRASS);
-			cachedTileMap[i][e].x = i;
-			cachedTileMap[i][e].y = e;
-		}
-	}
+overlayFlags(0), markerids(0), regionsDirty(true), heightMap(0) {
+	//GenerateMap() needs some room for the river, hills and the bog
+	Resize(Coordinate(std::max(200, Config::GetCVar<int>("mapWidth")), std::max(200, Config::GetCVar<int>("mapHeight"))));
 	waterlevel = -0.8f;
 	weather = boost::shared_ptr<Weather>(new Weather(this));
 }
 
+//Makes a blank map of the given size, the chunks along the right and bottom edges may stick out of it
+void Map::Resize(const Coordinate& size) {
+	extent = size;
+	chunkExtent = Coordinate((size.X() + MapChunk::Mask) >> MapChunk::SizeBits, (size.Y() + MapChunk::Mask) >> MapChunk::SizeBits);
+	chunks.clear();
+	dirtyChunks.clear();
+	chunks.reserve(chunkExtent.X() * chunkExtent.Y());
+	for (int cy = 0; cy < chunkExtent.Y(); ++cy) {
+		for (int cx = 0; cx < chunkExtent.X(); ++cx) {
+			boost::shared_ptr<MapChunk> newChunk(new MapChunk());
+			for (int i = 0; i < MapChunk::TileCount; ++i) {
+				newChunk->cache[i].x = (cx << MapChunk::SizeBits) + (i & MapChunk::Mask);
+				newChunk->cache[i].y = (cy << MapChunk::SizeBits) + (i >> MapChunk::SizeBits);
+			}
+			chunks.push_back(newChunk);
+		}
+	}
+	delete heightMap;
+	heightMap = new TCODHeightMap(extent.X(), extent.Y());
+	drinkableWater.Reset(extent);
+	filthTiles.Reset(extent);
+	regions.clear();
+	regionsDirty = true;
+	blockedTiles.clear();
+}
+
 Map::~Map() {
 	delete heightMap;
 }
@@ -115,11 +134,64 @@ bool Map::IsWalkable(const Coordinate& p, void* ptr) const {
 
 void Map::SetWalkable(const Coordinate &p, bool value) {
 	if (Map::IsInside(p)) {
+		bool wasWalkable = tile(p).IsWalkable();
 		tile(p).SetWalkable(value);
-		changedTiles.insert(p);
+		MarkChanged(p);
+		if (wasWalkable != value) {
+			regionsDirty = true;
+			if (!value) blockedTiles.push_back(p);
+		}
+	}
+}
+
+void Map::TakeBlockedTiles(std::vector<Coordinate>& blocked) {
+	blocked.swap(blockedTiles);
+	blockedTiles.clear();
+}
+
+void Map::UpdateRegions() {
+	if (!regionsDirty) return;
+	regionsDirty = false;
+	regions.assign(extent.X() * extent.Y(), -1);
+
+	int label = 0;
+	std::vector<Coordinate> frontier;
+	for (int y = 0; y < extent.Y(); ++y) {
+		for (int x = 0; x < extent.X(); ++x) {
+			if (regions[y * extent.X() + x] >= 0) continue;
+			if (!tile(Coordinate(x, y)).IsWalkable()) {
+				regions[y * extent.X() + x] = 0;
+				continue;
+			}
+			regions[y * extent.X() + x] = ++label;
+			frontier.push_back(Coordinate(x, y));
+			while (!frontier.empty()) {
+				Coordinate p = frontier.back();
+				frontier.pop_back();
+				for (int dy = -1; dy <= 1; ++dy) {
+					for (int dx = -1; dx <= 1; ++dx) {
+						Coordinate neighbour(p.X() + dx, p.Y() + dy);
+						if (!Map::IsInside(neighbour)) continue;
+						int& region = regions[neighbour.Y() * extent.X() + neighbour.X()];
+						if (region >= 0) continue;
+						if (tile(neighbour).IsWalkable()) {
+							region = label;
+							frontier.push_back(neighbour);
+						}
+					}
+				}
+			}
+		}
 	}
 }
 
+bool Map::Reachable(const Coordinate& from, const Coordinate& to) const {
+	if (regionsDirty || !Map::IsInside(from) || !Map::IsInside(to)) return true;
+	int fromRegion = regions[from.Y() * extent.X() + from.X()];
+	int toRegion = regions[to.Y() * extent.X() + to.X()];
+	return fromRegion == 0 || toRegion == 0 || fromRegion == toRegion;
+}
+
 bool Map::IsBuildable(const Coordinate& p) const { 
 	return Map::IsInside(p) && tile(p).IsBuildable();
 }
@@ -137,13 +209,68 @@ TileType Map::GetType(const Coordinate& p) {
 void Map::ResetType(const Coordinate& p, TileType ntype, float tileHeight) { 
 	if (Map::IsInside(p)) {
 		tile(p).ResetType(ntype, tileHeight);
-		changedTiles.insert(p);
+		MarkChanged(p);
 	}
 }
+//Rows are done in parallel, each drawing the tiles' looks from its own generator so that
+//the result doesn't depend on how the rows were spread over the threads
+void Map::ResetTypes(const std::vector<TileType>& types, unsigned int seed) {
+	ParallelFor(extent.Y(), [&](size_t row) {
+		int y = static_cast<int>(row);
+		Random::Generator rowRandom(Random::DeriveSeed(seed, y));
+		Random::StreamScope scope(rowRandom);
+		for (int x = 0; x < extent.X(); ++x) {
+			tile(Coordinate(x, y)).ResetType(types[y * extent.X() + x]);
+		}
+	});
+}
+
 void Map::ChangeType(const Coordinate& p, TileType ntype, float tileHeight) { 
 	if (Map::IsInside(p)) {
 		tile(p).ChangeType(ntype, tileHeight);
-		changedTiles.insert(p);
+		MarkChanged(p);
+	}
+}
+
+//The chunks are done in parallel when there are enough tiles, each drawing the looks from its
+//own generator like ResetTypes() does
+void Map::ChangeTypes(const std::vector<Coordinate>& positions, TileType ntype, unsigned int seed) {
+	std::vector<std::pair<int, Coordinate> > byChunk;
+	byChunk.reserve(positions.size());
+	for (std::vector<Coordinate>::const_iterator p = positions.begin(); p != positions.end(); ++p) {
+		if (Map::IsInside(*p)) byChunk.push_back(std::make_pair(ChunkIndex(*p), *p));
+	}
+	std::stable_sort(byChunk.begin(), byChunk.end(),
+		[](const std::pair<int, Coordinate>& a, const std::pair<int, Coordinate>& b) { return a.first < b.first; });
+
+	std::vector<size_t> groupStarts;
+	for (size_t i = 0; i < byChunk.size(); ++i) {
+		if (i == 0 || byChunk[i].first != byChunk[i - 1].first) groupStarts.push_back(i);
+	}
+	groupStarts.push_back(byChunk.size());
+
+	auto changeChunk = [&](size_t group) {
+		int index = byChunk[groupStarts[group]].first;
+		Random::Generator chunkRandom(Random::DeriveSeed(seed, index));
+		Random::StreamScope scope(chunkRandom);
+		MapChunk& changedChunk = *chunks[index];
+		for (size_t i = groupStarts[group]; i < groupStarts[group + 1]; ++i) {
+			const Coordinate& p = byChunk[i].second;
+			changedChunk.tiles[MapChunk::Index(p)].ChangeType(ntype, heightMap->getValue(p.X(), p.Y()));
+			changedChunk.changed.set(MapChunk::Index(p));
+		}
+	};
+	const size_t groups = groupStarts.size() - 1;
+	if (byChunk.size() >= MapChunk::TileCount * 4) ParallelFor(groups, changeChunk);
+	else for (size_t group = 0; group < groups; ++group) changeChunk(group);
+
+	for (size_t group = 0; group < groups; ++group) {
+		int index = byChunk[groupStarts[group]].first;
+		++chunks[index]->revision;
+		if (!chunks[index]->dirty) {
+			chunks[index]->dirty = true;
+			dirtyChunks.push_back(index);
+		}
 	}
 }
 
@@ -160,7 +287,7 @@ void Map::MoveFrom(const Coordinate& p, int uid) {
 void Map::SetConstruction(const Coordinate& p, int uid) { 
 	if (Map::IsInside(p)) {
 		tile(p).SetConstruction(uid);
-		changedTiles.insert(p);
+		MarkChanged(p);
 	}
 }
 int Map::GetConstruction(const Coordinate& p) const { 
@@ -169,16 +296,28 @@ int Map::GetConstruction(const Coordinate& p) const {
 }
 
 boost::weak_ptr<WaterNode> Map::GetWater(const Coordinate& p) { 
-	if (Map::IsInside(p)) return tile(p).GetWater();
+	if (Map::IsInside(p)) return node(p, &TileNodes::water);
 	return boost::weak_ptr<WaterNode>();
 }
 void Map::SetWater(const Coordinate& p, boost::shared_ptr<WaterNode> value) { 
 	if (Map::IsInside(p)) {
-		tile(p).SetWater(value);
-		changedTiles.insert(p);
+		chunk(p).SetNode(MapChunk::Index(p), &TileNodes::water, value);
+		drinkableWater.Remove(p);
+		if (value && value->IsDrinkable()) drinkableWater.Insert(p);
+		MarkChanged(p);
+	}
+}
+
+void Map::SetDrinkable(const Coordinate& p, const WaterNode* water, bool value) {
+	//Nodes that are not on the map (frozen into ice for example) don't count
+	if (Map::IsInside(p) && node(p, &TileNodes::water).get() == water) {
+		if (value) drinkableWater.Insert(p);
+		else drinkableWater.Remove(p);
 	}
 }
 
+const SpatialIndex& Map::DrinkableWater() const { return drinkableWater; }
+
 bool Map::IsLow(const Coordinate& p) const { 
 	return Map::IsInside(p) && tile(p).IsLow();
 }
@@ -197,11 +336,11 @@ void Map::SetBlocksWater(const Coordinate& p, bool value) {
 
 std::set<int>* Map::NPCList(const Coordinate& p) { 
 	if (Map::IsInside(p)) return &tile(p).npcList; 
-	return &tileMap[0][0].npcList;
+	return &tile(zero).npcList;
 }
 std::set<int>* Map::ItemList(const Coordinate& p) { 
 	if (Map::IsInside(p)) return &tile(p).itemList;
-	return &tileMap[0][0].itemList;
+	return &tile(zero).itemList;
 }
 
 int Map::GetGraphic(const Coordinate& p) const { 
@@ -221,7 +360,7 @@ void Map::ForeColor(const Coordinate& p, TCODColor color) {
 }
 
 TCODColor Map::GetBackColor(const Coordinate& p) const { 
-	if (Map::IsInside(p)) return tile(p).GetBackColor(); 
+	if (Map::IsInside(p)) return tile(p).GetBackColor(node(p, &TileNodes::blood).get()); 
 	return GCampColor::yellow;
 }
 
@@ -236,32 +375,39 @@ int Map::GetNatureObject(const Coordinate& p) const {
 }
 
 boost::weak_ptr<FilthNode> Map::GetFilth(const Coordinate& p) { 
-	if (Map::IsInside(p)) return tile(p).GetFilth(); 
+	if (Map::IsInside(p)) return node(p, &TileNodes::filth); 
 	return boost::weak_ptr<FilthNode>();
 }
 void Map::SetFilth(const Coordinate& p, boost::shared_ptr<FilthNode> value) { 
 	if (Map::IsInside(p)) {
-		tile(p).SetFilth(value);
-		changedTiles.insert(p);
+		chunk(p).SetNode(MapChunk::Index(p), &TileNodes::filth, value);
+		if (value) filthTiles.Insert(p);
+		else filthTiles.Remove(p);
+		MarkChanged(p);
 	}
 }
 
+const SpatialIndex& Map::FilthTiles() const { return filthTiles; }
+
 boost::weak_ptr<BloodNode> Map::GetBlood(const Coordinate& p) { 
-	if (Map::IsInside(p)) return tile(p).GetBlood(); 
+	if (Map::IsInside(p)) return node(p, &TileNodes::blood); 
 	return boost::weak_ptr<BloodNode>();
 }
 void Map::SetBlood(const Coordinate& p, boost::shared_ptr<BloodNode> value) { 
-	if (Map::IsInside(p)) tile(p).SetBlood(value); 
+	if (Map::IsInside(p)) {
+		chunk(p).SetNode(MapChunk::Index(p), &TileNodes::blood, value);
+		++chunk(p).revision;
+	}
 }
 
 boost::weak_ptr<FireNode> Map::GetFire(const Coordinate& p) { 
-	if (Map::IsInside(p)) return tile(p).GetFire(); 
+	if (Map::IsInside(p)) return node(p, &TileNodes::fire); 
 	return boost::weak_ptr<FireNode>();
 }
 void Map::SetFire(const Coordinate& p, boost::shared_ptr<FireNode> value) { 
 	if (Map::IsInside(p)) {
-		tile(p).SetFire(value);
-		changedTiles.insert(p);
+		chunk(p).SetNode(MapChunk::Index(p), &TileNodes::fire, value);
+		MarkChanged(p);
 	}
 }
 
@@ -303,7 +449,7 @@ int Map::GetMoveModifier(const Coordinate& p) {
 	else if (tile(p).GetType() == TILEMUD && !bridge) { //Mud adds 6 if there's no bridge
 		modifier += 6;
 	}
-	if (boost::shared_ptr<WaterNode> water = tile(p).GetWater().lock()) { //Water adds 'depth' without a bridge
+	if (boost::shared_ptr<WaterNode> water = node(p, &TileNodes::water)) { //Water adds 'depth' without a bridge
 		if (!bridge) modifier += water->Depth();
 	}
 
@@ -359,7 +505,7 @@ void Map::Naturify(const Coordinate& p) {
 			Coordinate end  = Map::Shrink(p + 2);
 			for (int ix = begin.X(); ix <= end.X(); ++ix) {
 				for (int iy = begin.Y(); iy <= end.Y(); ++iy) {
-					if (tileMap[ix][iy].natureObject >= 0) ++natureObjects;
+					if (tile(Coordinate(ix, iy)).natureObject >= 0) ++natureObjects;
 				}
 			}
 			if (natureObjects < (tile(p).corruption < 100 ? 6 : 1)) { //Corrupted areas have less flora
@@ -423,7 +569,7 @@ void Map::FindEquivalentMoveTarget(const Coordinate& current, Coordinate& move,
 
 bool Map::IsUnbridgedWater(const Coordinate& p) {
 	if (Map::IsInside(p)) {
-		if (boost::shared_ptr<WaterNode> water = tile(p).water) {
+		if (boost::shared_ptr<WaterNode> water = node(p, &TileNodes::water)) {
 			boost::shared_ptr<Construction> construction = Game::Inst()->GetConstruction(tile(p).construction).lock();
 			if (water->Depth() > 0 && (!construction || !construction->Built() || !construction->HasTag(BRIDGE))) return true;
 		}
@@ -574,15 +720,15 @@ void Map::CalculateFlow(int px[4], int py[4]) {
 		int resultB = Random::Generate(favorB ? 3 : 1);
 		if (resultA == resultB) Random::GenerateBool() ? resultA += 1 : resultB += 1;
 		if (resultA > resultB)
-			tileMap[current.X()][current.Y()].flow = flowDirectionA;
+			tile(current).flow = flowDirectionA;
 		else
-			tileMap[current.X()][current.Y()].flow = flowDirectionB;
+			tile(current).flow = flowDirectionB;
 
 		for (int y = current.Y()-1; y <= current.Y()+1; ++y) {
 			for (int x = current.X()-1; x <= current.X()+1; ++x) {
 				Coordinate pos(x,y);
 				if (IsInside(pos)) {
-					if (touched.find(pos) == touched.end() && tile(pos).water) {
+					if (touched.find(pos) == touched.end() && node(pos, &TileNodes::water)) {
 							int distance = Distance(beginning, pos);
 							touched.insert(pos);
 							unfinished.push(std::pair<int, Coordinate>(std::numeric_limits<int>::max() - distance, pos));
@@ -703,7 +849,7 @@ Direction Map::GetFlow(const Coordinate& p) {
 
 bool Map::IsDangerous(const Coordinate& p, int faction) const {
 	if (Map::IsInside(p)) {
-		if (tile(p).fire) return true;
+		if (node(p, &TileNodes::fire)) return true;
 		return Faction::factions[faction]->IsTrapVisible(p);
 	}
 	return false;
@@ -716,8 +862,11 @@ int Map::GetTerrainMoveCost(const Coordinate& p) const {
 }
 
 void Map::Update() {
-	if (Random::Generate(UPDATES_PER_SECOND * 1) == 0)
-		Naturify(Random::ChooseInExtent(Extent()));
+	if (Random::Generate(UPDATES_PER_SECOND * 1) == 0) {
+		Coordinate p = Random::ChooseInExtent(Extent());
+		if (chunk(p).active) Naturify(p);
+		else ++chunk(p).pendingNaturify;
+	}
 	UpdateMarkers();
 	weather->Update();
 	UpdateCache();
@@ -731,7 +880,7 @@ Coordinate Map::FindRangedAdvantage(const Coordinate& center) {
 			Coordinate p(x,y);
 			if (Map::IsInside(p)
 				&& tile(p).construction >= 0
-				&& !tile(p).fire
+				&& !node(p, &TileNodes::fire)
 				&& Game::Inst()->GetConstruction(tile(p).construction).lock()
 				&& Game::Inst()->GetConstruction(tile(p).construction).lock()->HasTag(RANGEDADVANTAGE)
 				&& tile(p).npcList.empty())
@@ -745,14 +894,25 @@ Coordinate Map::FindRangedAdvantage(const Coordinate& center) {
 	return Coordinate(-1,-1);
 }
 
+void Map::RefreshCachedTile(MapChunk& changedChunk, int index) {
+	changedChunk.cache[index] = changedChunk.tiles[index];
+	changedChunk.cache[index].SetNodes(changedChunk.Nodes(index));
+}
+
+//Only visits the chunks that had tiles change since the last update
 void Map::UpdateCache() {
 #if GCAMP_USE_THREADS
 	std::unique_lock writeLock(cacheMutex);
 #endif
-	for (boost::unordered_set<Coordinate>::iterator tilei = changedTiles.begin(); tilei != changedTiles.end();) {
-		cachedTile(*tilei) = tile(*tilei);
-		tilei = changedTiles.erase(tilei);
+	for (std::vector<int>::iterator chunki = dirtyChunks.begin(); chunki != dirtyChunks.end(); ++chunki) {
+		MapChunk& changedChunk = *chunks[*chunki];
+		for (int i = 0; i < MapChunk::TileCount; ++i) {
+			if (changedChunk.changed[i]) RefreshCachedTile(changedChunk, i);
+		}
+		changedChunk.changed.reset();
+		changedChunk.dirty = false;
 	}
+	dirtyChunks.clear();
 }
 
 bool Map::IsDangerousCache(const Coordinate& p, int faction) const {
@@ -764,43 +924,326 @@ bool Map::IsDangerousCache(const Coordinate& p, int faction) const {
 	return false;
 }
 
+void Map::RebuildCache() {
+#if GCAMP_USE_THREADS
+	std::unique_lock writeLock(cacheMutex);
+#endif
+	ParallelFor(chunks.size(), [&](size_t chunki) {
+		MapChunk& rebuiltChunk = *chunks[chunki];
+		for (int i = 0; i < MapChunk::TileCount; ++i) {
+			RefreshCachedTile(rebuiltChunk, i);
+		}
+		rebuiltChunk.changed.reset();
+		rebuiltChunk.dirty = false;
+	});
+	dirtyChunks.clear();
+	//Called after generating or loading, which set walkability directly
+	regionsDirty = true;
+	blockedTiles.clear();
+}
+
+namespace {
+	bool TileOrder(const std::pair<Coordinate, int>& a, const std::pair<Coordinate, int>& b) {
+		if (a.first.X() != b.first.X()) return a.first.X() < b.first.X();
+		if (a.first.Y() != b.first.Y()) return a.first.Y() < b.first.Y();
+		return a.second < b.second;
+	}
+
+	//Entries have to be sorted with TileOrder, so every uid goes to the end of its set
+	template <typename TileAt, typename Member>
+	void FillEntityLists(TileAt tileAt, const Coordinate& extent,
+		const std::vector<std::pair<Coordinate, int> >& entries, Member member) {
+		for (std::vector<std::pair<Coordinate, int> >::const_iterator entry = entries.begin(); entry != entries.end(); ++entry) {
+			if (entry->first.insideExtent(zero, extent)) {
+				std::set<int>& list = tileAt(entry->first).*member;
+				list.insert(list.end(), entry->second);
+			}
+		}
+	}
+}
+
+void Map::RebuildEntityLists(std::vector<std::pair<Coordinate, int> >& npcs, std::vector<std::pair<Coordinate, int> >& items) {
+	for (int x = 0; x < extent.X(); ++x) {
+		for (int y = 0; y < extent.Y(); ++y) {
+			tile(Coordinate(x, y)).npcList.clear();
+			tile(Coordinate(x, y)).itemList.clear();
+		}
+	}
+	std::sort(npcs.begin(), npcs.end(), TileOrder);
+	std::sort(items.begin(), items.end(), TileOrder);
+	auto tileAt = [this](const Coordinate& p) -> Tile& { return tile(p); };
+	FillEntityLists(tileAt, extent, npcs, &Tile::npcList);
+	FillEntityLists(tileAt, extent, items, &Tile::itemList);
+}
+
 void Map::TileChanged(const Coordinate& p) {
 	if (Map::IsInside(p)) {
-		changedTiles.insert(p);
+		MarkChanged(p);
 	}
 }
 
-void Map::save(OutputArchive& ar, const unsigned int version) const {
-	for (size_t x = 0; x < tileMap.size(); ++x) {
-		for (size_t y = 0; y < tileMap[x].size(); ++y) {
-			ar & tileMap[x][y];
+unsigned int Map::ChunkRevision(const Coordinate& p) const {
+	if (Map::IsInside(p)) return chunk(p).revision;
+	return 0;
+}
+
+Coordinate Map::ChunkOrigin(int index) const {
+	return Coordinate((index % chunkExtent.X()) << MapChunk::SizeBits, (index / chunkExtent.X()) << MapChunk::SizeBits);
+}
+
+bool Map::IsActive(const Coordinate& p) const {
+	return Map::IsInside(p) && chunk(p).active;
+}
+
+void Map::UpdateActivity(const std::vector<Coordinate>& anchors) {
+	std::vector<char> anchored(chunks.size(), 0);
+	for (std::vector<Coordinate>::const_iterator anchor = anchors.begin(); anchor != anchors.end(); ++anchor) {
+		if (Map::IsInside(*anchor)) anchored[ChunkIndex(*anchor)] = 1;
+	}
+
+	std::vector<char> active(chunks.size(), 0);
+	for (int cy = 0; cy < chunkExtent.Y(); ++cy) {
+		for (int cx = 0; cx < chunkExtent.X(); ++cx) {
+			if (!anchored[cy * chunkExtent.X() + cx]) continue;
+			for (int ny = std::max(0, cy - ActivityRadius); ny <= std::min(chunkExtent.Y() - 1, cy + ActivityRadius); ++ny) {
+				for (int nx = std::max(0, cx - ActivityRadius); nx <= std::min(chunkExtent.X() - 1, cx + ActivityRadius); ++nx) {
+					active[ny * chunkExtent.X() + nx] = 1;
+				}
+			}
+		}
+	}
+
+	for (size_t i = 0; i < chunks.size(); ++i) {
+		if (active[i] && !chunks[i]->active) WakeChunk(static_cast<int>(i));
+		else if (!active[i] && chunks[i]->active) SleepChunk(static_cast<int>(i));
+	}
+}
+
+void Map::WakeChunk(int index) {
+	MapChunk& woken = *chunks[index];
+	woken.active = true;
+	Coordinate origin = ChunkOrigin(index);
+	weather->CatchUp(origin, woken);
+
+	//Most of the missed calls would have found their tile overgrown already, so only a few are replayed
+	const int maxNaturifyCatchUp = 16;
+	Coordinate end = Map::Shrink(origin + (MapChunk::Size - 1));
+	for (int i = std::min(woken.pendingNaturify, maxNaturifyCatchUp); i > 0; --i) {
+		Naturify(Random::ChooseInRectangle(origin, end));
+	}
+	woken.pendingNaturify = 0;
+}
+
+void Map::SleepChunk(int index) {
+	chunks[index]->active = false;
+	weather->Synchronize(ChunkOrigin(index), *chunks[index]);
+}
+
+namespace {
+	/* Since version 3 tiles are saved as packed columns: one array per field, holding
+	   that field of every tile. Plain values are written as a single binary block, only
+	   the pointers and uid sets go through the archive one by one, and only for the tiles
+	   that have them. Tiles are reached through 'tileAt' as the map is stored in chunks. */
+	template <typename T, typename TileAt, typename Get>
+	void SaveColumn(OutputArchive& ar, TileAt tileAt, const Coordinate& extent, Get get) {
+		std::vector<T> column;
+		column.reserve(extent.X() * extent.Y());
+		for (int x = 0; x < extent.X(); ++x) {
+			for (int y = 0; y < extent.Y(); ++y) {
+				column.push_back(static_cast<T>(get(tileAt(Coordinate(x, y)))));
+			}
 		}
+		ar & boost::serialization::make_array(column.data(), column.size());
 	}
+
+	template <typename T, typename TileAt, typename Set>
+	void LoadColumn(InputArchive& ar, TileAt tileAt, const Coordinate& extent, Set set) {
+		std::vector<T> column(extent.X() * extent.Y());
+		ar & boost::serialization::make_array(column.data(), column.size());
+		typename std::vector<T>::const_iterator value = column.begin();
+		for (int x = 0; x < extent.X(); ++x) {
+			for (int y = 0; y < extent.Y(); ++y) {
+				set(tileAt(Coordinate(x, y)), *value++);
+			}
+		}
+	}
+
+	//Writes the tile index and the node of every tile that has one, looking only at the chunks with nodes
+	template <typename T>
+	void SaveNodeColumn(OutputArchive& ar, const std::vector<boost::shared_ptr<MapChunk> >& chunks, const Coordinate& chunkExtent,
+		const Coordinate& extent, boost::shared_ptr<T> TileNodes::*field) {
+		std::vector<std::pair<int, boost::shared_ptr<T> > > entries;
+		for (size_t chunki = 0; chunki < chunks.size(); ++chunki) {
+			if (!chunks[chunki]->HasNodes()) continue;
+			Coordinate origin((static_cast<int>(chunki) % chunkExtent.X()) << MapChunk::SizeBits, (static_cast<int>(chunki) / chunkExtent.X()) << MapChunk::SizeBits);
+			for (int i = 0; i < MapChunk::TileCount; ++i) {
+				Coordinate p = origin + Coordinate(i & MapChunk::Mask, i >> MapChunk::SizeBits);
+				boost::shared_ptr<T> value = chunks[chunki]->Node(i, field);
+				if (value && p.insideExtent(zero, extent)) entries.push_back(std::make_pair(p.X() * extent.Y() + p.Y(), value));
+			}
+		}
+		int count = static_cast<int>(entries.size());
+		ar & count;
+		for (typename std::vector<std::pair<int, boost::shared_ptr<T> > >::const_iterator entry = entries.begin(); entry != entries.end(); ++entry) {
+			ar & entry->first;
+			ar & entry->second;
+		}
+	}
+
+	//Reads the (tile index, value) pairs written by SaveNodeColumn, passing them to set(position, value)
+	template <typename T, typename Set>
+	void LoadSparseColumn(InputArchive& ar, const Coordinate& extent, Set set) {
+		int count;
+		ar & count;
+		for (int i = 0; i < count; ++i) {
+			int index;
+			ar & index;
+			if (index < 0 || index >= extent.X() * extent.Y()) {
+				throw std::runtime_error("Invalid tile index in saved map.");
+			}
+			T value;
+			ar & value;
+			set(Coordinate(index / extent.Y(), index % extent.Y()), value);
+		}
+	}
+}
+
+void Map::save(OutputArchive& ar, const unsigned int version) const {
 	const int width = extent.X();
 	const int height = extent.Y();
 	ar & width;
 	ar & height;
+
+	auto tileAt = [this](const Coordinate& p) -> const Tile& { return tile(p); };
+
+	SaveColumn<boost::uint8_t>(ar, tileAt, extent, [](const Tile& t) { return t.type; });
+	SaveColumn<boost::uint8_t>(ar, tileAt, extent, [](const Tile& t) { return t.vis; });
+	SaveColumn<boost::uint8_t>(ar, tileAt, extent, [](const Tile& t) { return t.walkable; });
+	SaveColumn<boost::uint8_t>(ar, tileAt, extent, [](const Tile& t) { return t.buildable; });
+	SaveColumn<int>(ar, tileAt, extent, [](const Tile& t) { return t.moveCost; });
+	SaveColumn<int>(ar, tileAt, extent, [](const Tile& t) { return t.construction; });
+	SaveColumn<boost::uint8_t>(ar, tileAt, extent, [](const Tile& t) { return t.low; });
+	SaveColumn<boost::uint8_t>(ar, tileAt, extent, [](const Tile& t) { return t.blocksWater; });
+	SaveColumn<int>(ar, tileAt, extent, [](const Tile& t) { return t.graphic; });
+	SaveColumn<boost::uint8_t>(ar, tileAt, extent, [](const Tile& t) { return t.foreColor.r; });
+	SaveColumn<boost::uint8_t>(ar, tileAt, extent, [](const Tile& t) { return t.foreColor.g; });
+	SaveColumn<boost::uint8_t>(ar, tileAt, extent, [](const Tile& t) { return t.foreColor.b; });
+	SaveColumn<boost::uint8_t>(ar, tileAt, extent, [](const Tile& t) { return t.originalForeColor.r; });
+	SaveColumn<boost::uint8_t>(ar, tileAt, extent, [](const Tile& t) { return t.originalForeColor.g; });
+	SaveColumn<boost::uint8_t>(ar, tileAt, extent, [](const Tile& t) { return t.originalForeColor.b; });
+	SaveColumn<boost::uint8_t>(ar, tileAt, extent, [](const Tile& t) { return t.backColor.r; });
+	SaveColumn<boost::uint8_t>(ar, tileAt, extent, [](const Tile& t) { return t.backColor.g; });
+	SaveColumn<boost::uint8_t>(ar, tileAt, extent, [](const Tile& t) { return t.backColor.b; });
+	SaveColumn<int>(ar, tileAt, extent, [](const Tile& t) { return t.natureObject; });
+	SaveColumn<boost::uint8_t>(ar, tileAt, extent, [](const Tile& t) { return t.marked; });
+	SaveColumn<int>(ar, tileAt, extent, [](const Tile& t) { return t.walkedOver; });
+	SaveColumn<int>(ar, tileAt, extent, [](const Tile& t) { return t.corruption; });
+	SaveColumn<boost::uint8_t>(ar, tileAt, extent, [](const Tile& t) { return t.territory; });
+	SaveColumn<int>(ar, tileAt, extent, [](const Tile& t) { return t.burnt; });
+	SaveColumn<boost::uint8_t>(ar, tileAt, extent, [](const Tile& t) { return t.flow; });
+
+	SaveNodeColumn(ar, chunks, chunkExtent, extent, &TileNodes::water);
+	SaveNodeColumn(ar, chunks, chunkExtent, extent, &TileNodes::filth);
+	SaveNodeColumn(ar, chunks, chunkExtent, extent, &TileNodes::blood);
+	SaveNodeColumn(ar, chunks, chunkExtent, extent, &TileNodes::fire);
+
 	ar & mapMarkers;
 	ar & markerids;
 	ar & weather;
-	for (size_t x = 0; x < tileMap.size(); ++x) {
-		for (size_t y = 0; y < tileMap[x].size(); ++y) {
-			float heightMapValue = heightMap->getValue(x, y);
-			ar & heightMapValue;
-		}
+	ar & boost::serialization::make_array(heightMap->values, heightMap->w * heightMap->h);
+
+	for (std::vector<boost::shared_ptr<MapChunk> >::const_iterator chunki = chunks.begin(); chunki != chunks.end(); ++chunki) {
+		ar & (*chunki)->active;
+		ar & (*chunki)->pendingNaturify;
+		ar & (*chunki)->weatherPhase;
+		ar & (*chunki)->weatherExposure;
 	}
 }
 
 void Map::load(InputArchive& ar, const unsigned int version) {
-	for (size_t x = 0; x < tileMap.size(); ++x) {
-		for (size_t y = 0; y < tileMap[x].size(); ++y) {
-			ar & tileMap[x][y];
+	int width, height;
+	if (version >= 3) {
+		ar & width;
+		ar & height;
+		if (width < 1 || height < 1) {
+			throw std::runtime_error("Invalid saved map size.");
+		}
+		if (Coordinate(width, height) != extent) Resize(Coordinate(width, height));
+
+		auto tileAt = [this](const Coordinate& p) -> Tile& { return tile(p); };
+
+		LoadColumn<boost::uint8_t>(ar, tileAt, extent, [](Tile& t, boost::uint8_t v) { t.type = static_cast<TileType>(v); });
+		LoadColumn<boost::uint8_t>(ar, tileAt, extent, [](Tile& t, boost::uint8_t v) { t.vis = v != 0; });
+		LoadColumn<boost::uint8_t>(ar, tileAt, extent, [](Tile& t, boost::uint8_t v) { t.walkable = v != 0; });
+		LoadColumn<boost::uint8_t>(ar, tileAt, extent, [](Tile& t, boost::uint8_t v) { t.buildable = v != 0; });
+		LoadColumn<int>(ar, tileAt, extent, [](Tile& t, int v) { t.moveCost = v; });
+		LoadColumn<int>(ar, tileAt, extent, [](Tile& t, int v) { t.construction = v; });
+		LoadColumn<boost::uint8_t>(ar, tileAt, extent, [](Tile& t, boost::uint8_t v) { t.low = v != 0; });
+		LoadColumn<boost::uint8_t>(ar, tileAt, extent, [](Tile& t, boost::uint8_t v) { t.blocksWater = v != 0; });
+		LoadColumn<int>(ar, tileAt, extent, [](Tile& t, int v) { t.graphic = v; });
+		LoadColumn<boost::uint8_t>(ar, tileAt, extent, [](Tile& t, boost::uint8_t v) { t.foreColor.r = v; });
+		LoadColumn<boost::uint8_t>(ar, tileAt, extent, [](Tile& t, boost::uint8_t v) { t.foreColor.g = v; });
+		LoadColumn<boost::uint8_t>(ar, tileAt, extent, [](Tile& t, boost::uint8_t v) { t.foreColor.b = v; });
+		LoadColumn<boost::uint8_t>(ar, tileAt, extent, [](Tile& t, boost::uint8_t v) { t.originalForeColor.r = v; });
+		LoadColumn<boost::uint8_t>(ar, tileAt, extent, [](Tile& t, boost::uint8_t v) { t.originalForeColor.g = v; });
+		LoadColumn<boost::uint8_t>(ar, tileAt, extent, [](Tile& t, boost::uint8_t v) { t.originalForeColor.b = v; });
+		LoadColumn<boost::uint8_t>(ar, tileAt, extent, [](Tile& t, boost::uint8_t v) { t.backColor.r = v; });
+		LoadColumn<boost::uint8_t>(ar, tileAt, extent, [](Tile& t, boost::uint8_t v) { t.backColor.g = v; });
+		LoadColumn<boost::uint8_t>(ar, tileAt, extent, [](Tile& t, boost::uint8_t v) { t.backColor.b = v; });
+		LoadColumn<int>(ar, tileAt, extent, [](Tile& t, int v) { t.natureObject = v; });
+		LoadColumn<boost::uint8_t>(ar, tileAt, extent, [](Tile& t, boost::uint8_t v) { t.marked = v != 0; });
+		LoadColumn<int>(ar, tileAt, extent, [](Tile& t, int v) { t.walkedOver = v; });
+		LoadColumn<int>(ar, tileAt, extent, [](Tile& t, int v) { t.corruption = v; });
+		LoadColumn<boost::uint8_t>(ar, tileAt, extent, [](Tile& t, boost::uint8_t v) { t.territory = v != 0; });
+		LoadColumn<int>(ar, tileAt, extent, [](Tile& t, int v) { t.burnt = v; });
+		LoadColumn<boost::uint8_t>(ar, tileAt, extent, [](Tile& t, boost::uint8_t v) { t.flow = static_cast<Direction>(v); });
+
+		LoadSparseColumn<boost::shared_ptr<WaterNode> >(ar, extent, [this](const Coordinate& p, const boost::shared_ptr<WaterNode>& water) {
+			chunk(p).SetNode(MapChunk::Index(p), &TileNodes::water, water);
+		});
+		if (version == 3) {
+			//The uid sets are rebuilt from the entities by Game::ProvideMap
+			LoadSparseColumn<std::set<int> >(ar, extent, [](const Coordinate&, const std::set<int>&) {});
+			LoadSparseColumn<std::set<int> >(ar, extent, [](const Coordinate&, const std::set<int>&) {});
 		}
+		LoadSparseColumn<boost::shared_ptr<FilthNode> >(ar, extent, [this](const Coordinate& p, const boost::shared_ptr<FilthNode>& filth) {
+			chunk(p).SetNode(MapChunk::Index(p), &TileNodes::filth, filth);
+		});
+		LoadSparseColumn<boost::shared_ptr<BloodNode> >(ar, extent, [this](const Coordinate& p, const boost::shared_ptr<BloodNode>& blood) {
+			chunk(p).SetNode(MapChunk::Index(p), &TileNodes::blood, blood);
+		});
+		LoadSparseColumn<boost::shared_ptr<FireNode> >(ar, extent, [this](const Coordinate& p, const boost::shared_ptr<FireNode>& fire) {
+			chunk(p).SetNode(MapChunk::Index(p), &TileNodes::fire, fire);
+		});
+	} else {
+		//Older saves are all 500x500
+		if (extent != Coordinate(500, 500)) Resize(Coordinate(500, 500));
+		for (int x = 0; x < extent.X(); ++x) {
+			for (int y = 0; y < extent.Y(); ++y) {
+				Coordinate p(x, y);
+				ar & tile(p);
+				chunk(p).SetNode(MapChunk::Index(p), &TileNodes::water, Tile::loadedNodes.water);
+				chunk(p).SetNode(MapChunk::Index(p), &TileNodes::filth, Tile::loadedNodes.filth);
+				chunk(p).SetNode(MapChunk::Index(p), &TileNodes::blood, Tile::loadedNodes.blood);
+				chunk(p).SetNode(MapChunk::Index(p), &TileNodes::fire, Tile::loadedNodes.fire);
+			}
+		}
+		Tile::loadedNodes = TileNodes();
+		ar & width;
+		ar & height;
+		extent = Coordinate(width, height);
 	}
-	int width, height;
-	ar & width;
-	ar & height;
-	extent = Coordinate(width, height);
+
+	//Water drinkability isn't saved, nodes will mark themselves drinkable again on their next update
+	drinkableWater.Reset(extent);
+	filthTiles.Reset(extent);
+	for (int x = 0; x < extent.X(); ++x) {
+		for (int y = 0; y < extent.Y(); ++y) {
+			Coordinate p(x, y);
+			if (chunk(p).HasNodes() && node(p, &TileNodes::filth)) filthTiles.Insert(p);
+		}
+	}
+
 	ar & mapMarkers;
 	ar & markerids;
 	if (version == 0) {
@@ -810,16 +1253,27 @@ void Map::load(InputArchive& ar, const unsigned int version) {
 	if (version >= 1) {
 		ar & weather;
 	}
-	if (version >= 2) {
-		for (size_t x = 0; x < tileMap.size(); ++x) {
-			for (size_t y = 0; y < tileMap[x].size(); ++y) {
+	if (version >= 3) {
+		ar & boost::serialization::make_array(heightMap->values, heightMap->w * heightMap->h);
+	} else if (version >= 2) {
+		for (int x = 0; x < extent.X(); ++x) {
+			for (int y = 0; y < extent.Y(); ++y) {
 				float heightMapValue;
 				ar & heightMapValue;
 				heightMap->setValue(x, y, heightMapValue);
-
-				//Mark every tile as changed so the cached map gets completely updated on load
-				changedTiles.insert(Coordinate(x,y));
 			}
 		}
 	}
+
+	//Older saves start out with every chunk dormant and up to date, Game wakes the ones near the camp
+	if (version >= 5) {
+		for (std::vector<boost::shared_ptr<MapChunk> >::iterator chunki = chunks.begin(); chunki != chunks.end(); ++chunki) {
+			ar & (*chunki)->active;
+			ar & (*chunki)->pendingNaturify;
+			ar & (*chunki)->weatherPhase;
+			ar & (*chunki)->weatherExposure;
+		}
+	}
+
+	//The cached map is rebuilt with RebuildCache() once the entities have been placed
 }
@@ -36,8 +36,11 @@ along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
 #include <boost/serialization/list.hpp>
 #include <boost/serialization/shared_ptr.hpp>
 #include <boost/serialization/set.hpp>
+#include <boost/serialization/map.hpp>
+#include <boost/serialization/vector.hpp>
 
 #include "Random.hpp"
+#include "Replay.hpp"
 #include "NPC.hpp"
 #include "Coordinate.hpp"
 #include "JobManager.hpp"
@@ -46,6 +49,7 @@ along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
 #include "Announce.hpp"
 #include "Logger.hpp"
 #include "Map.hpp"
+#include "GroupPath.hpp"
 #include "StatusEffect.hpp"
 #include "Camp.hpp"
 #include "Stockpile.hpp"
@@ -80,10 +84,14 @@ NPC::NPC(Coordinate pos, boost::function<bool(boost::shared_ptr<NPC>)> findJob,
 	taskIndex(0),
 	orderIndex(0),
 
+	path(),
 	pathIndex(0),
 	nopath(false),
 	findPathWorking(false),
 	pathIsDangerous(false),
+	groupPath(),
+	awaitedGroup(),
+	awaitedTarget(),
 
 	timer(0),
 	nextMove(0),
@@ -145,8 +153,8 @@ NPC::NPC(Coordinate pos, boost::function<bool(boost::shared_ptr<NPC>)> findJob,
 	hunger = hunger - (HUNGER_THRESHOLD / 2) + Random::Generate(HUNGER_THRESHOLD - 1);
 	weariness = weariness - (WEARY_THRESHOLD / 2) + Random::Generate(WEARY_THRESHOLD - 1);
 
-	for (int i = 0; i < STAT_COUNT; ++i) {baseStats[i] = 0; effectiveStats[i] = 0;}
-	for (int i = 0; i < RES_COUNT; ++i) {baseResistances[i] = 0; effectiveResistances[i] = 0;}
+	for (int i = 0; i < STAT_COUNT; ++i) {baseStats[i] = 0; effectiveStats[i] = 0; effectStatMultipliers[i] = 1;}
+	for (int i = 0; i < RES_COUNT; ++i) {baseResistances[i] = 0; effectiveResistances[i] = 0; effectResistanceMultipliers[i] = 1;}
 }
 
 NPC::~NPC() {
@@ -164,7 +172,6 @@ NPC::~NPC() {
 #if GCAMP_USE_THREADS
 	pathMutex.unlock();
 #endif
-	delete path;
 }
 
 void NPC::SetMap(Map* map) {
@@ -174,8 +181,6 @@ void NPC::SetMap(Map* map) {
 		pos += Random::ChooseInRadius(1);
 	}
 	Position(pos,true);
-
-	path = new TCODPath(map->Width(), map->Height(), map, static_cast<void*>(this));
 }
 
 void NPC::Position(const Coordinate& p, bool firstTime) {
@@ -256,14 +261,14 @@ void NPC::HandleThirst() {
 	bool found = false;
 
 	for (std::deque<boost::shared_ptr<Job> >::iterator jobIter = jobs.begin(); jobIter != jobs.end(); ++jobIter) {
-		if ((*jobIter)->name.find("Drink") != std::string::npos) found = true;
+		if ((*jobIter)->Name().find("Drink") != std::string::npos) found = true;
 	}
 	if (!found) {
 		boost::weak_ptr<Item> item = Game::Inst()->FindItemByCategoryFromStockpiles(Item::StringToItemCategory("Drink"), Position());
 		Coordinate waterCoordinate;
 		if (!item.lock()) {waterCoordinate = Game::Inst()->FindWater(Position());}
 		if (item.lock() || waterCoordinate != undefined) { //Found something to drink
-			boost::shared_ptr<Job> newJob(new Job("Drink", MED, 0, !expert));
+			boost::shared_ptr<Job> newJob(Job::Create("Drink", MED, 0, !expert));
 			newJob->internal = true;
 
 			if (item.lock()) {
@@ -288,12 +293,12 @@ void NPC::HandleThirst() {
 void NPC::HandleHunger() {
 	bool found = false;
 
-	if (hunger > 48000 && !jobs.empty() &&  jobs.front()->name.find("Eat") == std::string::npos) { //Starving and doing something else
+	if (hunger > 48000 && !jobs.empty() &&  jobs.front()->Name().find("Eat") == std::string::npos) { //Starving and doing something else
 		TaskFinished(TASKFAILNONFATAL);
 	}
 		
 	for (std::deque<boost::shared_ptr<Job> >::iterator jobIter = jobs.begin(); jobIter != jobs.end(); ++jobIter) {
-		if ((*jobIter)->name.find("Eat") != std::string::npos) found = true;
+		if ((*jobIter)->Name().find("Eat") != std::string::npos) found = true;
 	}
 	if (!found) {
 		boost::weak_ptr<Item> item = Game::Inst()->FindItemByCategoryFromStockpiles(Item::StringToItemCategory("Prepared food"), Position(), MOSTDECAYED);
@@ -309,7 +314,7 @@ void NPC::HandleHunger() {
 				}
 
 				if (weakest) { //Found a creature nearby, eat it
-					boost::shared_ptr<Job> newJob(new Job("Eat", HIGH, 0, !expert));
+					boost::shared_ptr<Job> newJob(Job::Create("Eat", HIGH, 0, !expert));
 					newJob->internal = true;
 					newJob->tasks.push_back(Task(GETANGRY));
 					newJob->tasks.push_back(Task(KILL, weakest->Position(), weakest, 0, 1));
@@ -319,7 +324,7 @@ void NPC::HandleHunger() {
 				}				
 			}
 		} else { //Something to eat!
-			boost::shared_ptr<Job> newJob(new Job("Eat", MED, 0, !expert));
+			boost::shared_ptr<Job> newJob(Job::Create("Eat", MED, 0, !expert));
 			newJob->internal = true;
 
 			newJob->ReserveEntity(item);
@@ -335,12 +340,12 @@ void NPC::HandleHunger() {
 void NPC::HandleWeariness() {
 	bool found = false;
 	for (std::deque<boost::shared_ptr<Job> >::iterator jobIter = jobs.begin(); jobIter != jobs.end(); ++jobIter) {
-		if ((*jobIter)->name.find("Sleep") != std::string::npos) found = true;
-		else if ((*jobIter)->name.find("Get rid of") != std::string::npos) found = true;
+		if ((*jobIter)->Name().find("Sleep") != std::string::npos) found = true;
+		else if ((*jobIter)->Name().find("Get rid of") != std::string::npos) found = true;
 	}
 	if (!found) {
 		boost::weak_ptr<Construction> wbed = Game::Inst()->FindConstructionByTag(BED, Position());
-		boost::shared_ptr<Job> sleepJob(new Job("Sleep"));
+		boost::shared_ptr<Job> sleepJob(Job::Create("Sleep"));
 		sleepJob->internal = true;
 		if (!squad.lock() && mainHand.lock()) { //Only soldiers go to sleep gripping their weapons
 			sleepJob->tasks.push_back(Task(UNWIELD));
@@ -393,12 +398,9 @@ void NPC::Update() {
 		if (hunger >= HUNGER_THRESHOLD) AddEffect(HUNGER);
 		else RemoveEffect(HUNGER);
 
-		if (thirst > THIRST_THRESHOLD && Random::Generate(UPDATES_PER_SECOND * 5 - 1) == 0) {
-			HandleThirst();
-		} else if (thirst > THIRST_THRESHOLD * 2) Kill(GetDeathMsgThirst());
-		if (hunger > HUNGER_THRESHOLD && Random::Generate(UPDATES_PER_SECOND * 5 - 1) == 0) {
-			HandleHunger();
-		} else if (hunger > 72000) Kill(GetDeathMsgHunger());
+		//Looking for food and drink is done by Game::UpdateTimers
+		if (thirst > THIRST_THRESHOLD * 2) Kill(GetDeathMsgThirst());
+		if (hunger > 72000) Kill(GetDeathMsgHunger());
 	}
 
 	if (needsSleep) {
@@ -428,8 +430,6 @@ void NPC::Update() {
 		attacki->Update();
 	}
 
-	if (faction == PLAYERFACTION && Random::Generate(MONTH_LENGTH - 1) == 0) Game::Inst()->CreateFilth(Position());
-
 	if (carried.lock()) {
 		AddEffect(StatusEffect(CARRYING, carried.lock()->GetGraphic(), carried.lock()->Color()));
 	} else RemoveEffect(CARRYING);
@@ -440,11 +440,11 @@ void NPC::Update() {
 			boost::shared_ptr<Spell> spark = Game::Inst()->CreateSpell(Position(), Spell::StringToSpellType("spark"));
 			spark->CalculateFlightPath(Random::ChooseInRadius(Position(), 1), 50, GetHeight());
 		}
-		if (effectiveResistances[FIRE_RES] < 90 && !HasEffect(RAGE) && (jobs.empty() || jobs.front()->name != "Jump into water")) {
+		if (effectiveResistances[FIRE_RES] < 90 && !HasEffect(RAGE) && (jobs.empty() || jobs.front()->Name() != "Jump into water")) {
 			if (Random::Generate(UPDATES_PER_SECOND) == 0) {
 				RemoveEffect(PANIC);
 				while (!jobs.empty()) TaskFinished(TASKFAILFATAL);
-				boost::shared_ptr<Job> jumpJob(new Job("Jump into water"));
+				boost::shared_ptr<Job> jumpJob(Job::Create("Jump into water"));
 				jumpJob->internal = true;
 				Coordinate waterPos = Game::Inst()->FindWater(Position());
 				if (waterPos != undefined) {
@@ -477,16 +477,19 @@ void NPC::UpdateStatusEffects() {
 	
 	if (factionPtr->IsFriendsWith(PLAYERFACTION)) effectiveResistances[DISEASE_RES] = std::max(0, effectiveResistances[DISEASE_RES] - Camp::Inst()->GetDiseaseModifier());
 
-	++statusGraphicCounter;
-	for (std::list<StatusEffect>::iterator statusEffectI = statusEffects.begin(); statusEffectI != statusEffects.end();) {
-		//Apply effects to stats
+	//Apply effects to stats
+	if (!statusEffects.empty()) {
 		for (int i = 0; i < STAT_COUNT; ++i) {
-			effectiveStats[i] = (int)(effectiveStats[i] * statusEffectI->statChanges[i]);
+			effectiveStats[i] = (int)(effectiveStats[i] * effectStatMultipliers[i]);
 		}
 		for (int i = 0; i < RES_COUNT; ++i) {
-			effectiveResistances[i] = (int)(effectiveResistances[i] * statusEffectI->resistanceChanges[i]);
+			effectiveResistances[i] = (int)(effectiveResistances[i] * effectResistanceMultipliers[i]);
 		}
+	}
 
+	++statusGraphicCounter;
+	bool effectExpired = false;
+	for (std::list<StatusEffect>::iterator statusEffectI = statusEffects.begin(); statusEffectI != statusEffects.end();) {
 		if (statusEffectI->damage.second != 0 && --statusEffectI->damage.first <= 0) {
 			statusEffectI->damage.first = UPDATES_PER_SECOND;
 			TCOD_dice_t dice;
@@ -504,7 +507,7 @@ void NPC::UpdateStatusEffects() {
 			statusEffectsChanged = false;
 			bool removalJobFound = false;
 			for (std::deque<boost::shared_ptr<Job> >::iterator jobi = jobs.begin(); jobi != jobs.end(); ++jobi) {
-				if ((*jobi)->name.find("Get rid of") != std::string::npos) {
+				if ((*jobi)->Name().find("Get rid of") != std::string::npos) {
 					removalJobFound = true;
 					break;
 				}
@@ -516,7 +519,7 @@ void NPC::UpdateStatusEffects() {
 						fixItem = Game::Inst()->FindItemByTypeFromStockpiles(fixi->second, Position()).lock();
 				}
 				if (fixItem) {
-					boost::shared_ptr<Job> rEffJob(new Job("Get rid of "+statusEffectI->name));
+					boost::shared_ptr<Job> rEffJob(Job::Create("Get rid of "+statusEffectI->name));
 					rEffJob->internal = true;
 					rEffJob->ReserveEntity(fixItem);
 					rEffJob->tasks.push_back(Task(MOVE, fixItem->Position()));
@@ -549,8 +552,10 @@ void NPC::UpdateStatusEffects() {
 			}
 			statusEffectI = statusEffects.erase(statusEffectI);
 			if (statusEffectIterator == statusEffects.end()) statusEffectIterator = statusEffects.begin();
+			effectExpired = true;
 		} else ++statusEffectI;
 	}
+	if (effectExpired) UpdateEffectCache();
 	
 	if (statusGraphicCounter > 10) {
 		statusGraphicCounter = 0;
@@ -1374,7 +1379,7 @@ CONTINUEEAT:
 		} else {
 			if (HasEffect(DRUNK)) {
 				JobManager::Inst()->NPCNotWaiting(uid);
-				boost::shared_ptr<Job> drunkJob(new Job("Huh?"));
+				boost::shared_ptr<Job> drunkJob(Job::Create("Huh?"));
 				drunkJob->internal = true;
 				run = false;
 				drunkJob->tasks.push_back(Task(MOVENEAR, Position()));
@@ -1383,7 +1388,7 @@ CONTINUEEAT:
 			} else	if (HasEffect(PANIC)) {
 				JobManager::Inst()->NPCNotWaiting(uid);
 				if (jobs.empty() && threatLocation != undefined) {
-					boost::shared_ptr<Job> fleeJob(new Job("Flee"));
+					boost::shared_ptr<Job> fleeJob(Job::Create("Flee"));
 					fleeJob->internal = true;
 					int x = pos.X(), y = pos.Y();
 					int dx = x - threatLocation.X();
@@ -1402,7 +1407,7 @@ CONTINUEEAT:
 				}
 			} else if (!GetSquadJob(boost::static_pointer_cast<NPC>(shared_from_this())) && 
 				!FindJob(boost::static_pointer_cast<NPC>(shared_from_this()))) {
-				boost::shared_ptr<Job> idleJob(new Job("Idle"));
+				boost::shared_ptr<Job> idleJob(Job::Create("Idle"));
 				idleJob->internal = true;
 				if (faction == PLAYERFACTION) {
 					if (Random::Generate(8) < 7) {
@@ -1450,6 +1455,7 @@ TaskResult NPC::Move(TaskResult oldResult) {
 		if (effectiveStats[MOVESPEED]/3 == 0 && effectiveStats[MOVESPEED] != 0) ++nextMove;
 		else nextMove += effectiveStats[MOVESPEED]/3;
 	}
+	if (awaitedGroup) ResumeGroupPath();
 	while (nextMove > 100) {
 		nextMove -= 100;
 #if GCAMP_USE_THREADS
@@ -1458,15 +1464,13 @@ TaskResult NPC::Move(TaskResult oldResult) {
 #endif
 		{
 			if (nopath) {nopath = false; return TASKFAILFATAL;}
-			if (pathIndex < path->size() && pathIndex >= 0) {
+			if (pathIndex < static_cast<int>(path.size()) && pathIndex >= 0) {
 				//Get next move
-				Coordinate move;
-				path->get(pathIndex, move.Xptr(), move.Yptr());
+				Coordinate move = path[pathIndex];
 
-				if (pathIndex != path->size()-1 && map->NPCList(move)->size() > 0) {
+				if (pathIndex != static_cast<int>(path.size())-1 && map->NPCList(move)->size() > 0) {
 					//Our next move target has an npc on it, and it isn't our target
-					Coordinate next;
-					path->get(pathIndex+1, next.Xptr(), next.Yptr());
+					Coordinate next = path[pathIndex+1];
 					/*Find a new target that is adjacent to our current, next, and the next after targets
 					Effectively this makes the npc try and move around another npc, instead of walking onto
 					the same tile and slowing down*/
@@ -1501,43 +1505,136 @@ std::mutex NPC::threadCountMutex;
 #endif
 
 void NPC::findPath(Coordinate target) {
+	//A group route only stands in for the first search after joining it
+	boost::shared_ptr<GroupPath> group, leading;
+	group.swap(groupPath);
+	awaitedGroup.reset();
+	if (group) {
+		GroupPath::State state = group->Enlist();
+		if (state == GroupPath::READY && FollowGroupPath(*group, target)) return;
+		if (state == GroupPath::LEADING) leading = group;
+		else if (state == GroupPath::PENDING) {
+			awaitedGroup = group;
+			awaitedTarget = target;
+		}
+	}
+
 #if GCAMP_USE_THREADS
 	pathMutex.lock();
 #endif
 	findPathWorking = true;
 	pathIsDangerous = false;
 	pathIndex = 0;
-	
-	delete path;
-	path = new TCODPath(map->Width(), map->Height(), map, static_cast<void*>(this));
+	path.clear();
+
+	//Move picks the search back up once the group's leader is done
+	if (awaitedGroup) {
+		nopath = false;
+#if GCAMP_USE_THREADS
+		pathMutex.unlock();
+#endif
+		return;
+	}
+
+	//Walkers can't leave their walkable area, searching all of it would only confirm that
+	if (BoundToWalkableArea() && !map->Reachable(pos, target)) {
+		nopath = true;
+		findPathWorking = false;
+		if (leading) leading->Publish(0);
+#if GCAMP_USE_THREADS
+		pathMutex.unlock();
+#endif
+		return;
+	}
 
 #if GCAMP_USE_THREADS
 	threadCountMutex.lock();
-	if (pathingThreadCount < 12) {
+	//Recorded sessions path synchronously, so that paths are ready on the same tick when replayed
+	if (pathingThreadCount < 12 && !Replay::Active()) {
 		++pathingThreadCount;
 		threadCountMutex.unlock();
 		pathMutex.unlock();
-		std::thread pathThread(boost::bind(tFindPath, path, pos.X(), pos.Y(), target.X(), target.Y(), this, true));
+		std::thread pathThread(boost::bind(tFindPath, pos.X(), pos.Y(), target.X(), target.Y(), this, true, leading));
 		pathThread.detach();
 	} else {
 		threadCountMutex.unlock();
 		pathMutex.unlock();
 #endif
-		tFindPath(path, pos.X(), pos.Y(), target.X(), target.Y(), this, false);
+		tFindPath(pos.X(), pos.Y(), target.X(), target.Y(), this, false, leading);
 #if GCAMP_USE_THREADS
 	}
 #endif
 }
 
+//Some tiles were blocked, if the rest of the path crosses them look for a new way to where it led
+void NPC::CheckPath(const boost::unordered_set<Coordinate>& blocked) {
+	if (HasEffect(FLYING)) return;
+	Coordinate destination;
+	{
+#if GCAMP_USE_THREADS
+		std::unique_lock pathLock(pathMutex, std::try_to_lock);
+		if (!pathLock.owns_lock()) return; //Being computed from the updated map already
+#endif
+		if (findPathWorking || pathIndex < 0 || pathIndex >= static_cast<int>(path.size())) return;
+		bool crossesBlocked = false;
+		for (size_t i = pathIndex; i < path.size() && !crossesBlocked; ++i) {
+			crossesBlocked = blocked.find(path[i]) != blocked.end();
+		}
+		if (!crossesBlocked) return;
+		destination = path.back();
+	}
+	findPath(destination);
+}
+
 bool NPC::IsPathWalkable() {
-	for (int i = 0; i < path->size(); i++) {
-		Coordinate p;
-		path->get(i, p.Xptr(), p.Yptr());
-		if (!map->IsWalkable(p, static_cast<void*>(this))) return false;
+	for (std::vector<Coordinate>::iterator p = path.begin(); p != path.end(); ++p) {
+		if (!map->IsWalkable(*p, static_cast<void*>(this))) return false;
 	}
 	return true;
 }
 
+void NPC::JoinGroupPath(boost::shared_ptr<GroupPath> group) {
+	groupPath = group;
+}
+
+//One dangerous tile = whole path considered dangerous
+void NPC::CheckPathDanger() {
+	pathIsDangerous = false;
+	for (std::vector<Coordinate>::iterator p = path.begin(); p != path.end() && !pathIsDangerous; ++p) {
+		pathIsDangerous = map->IsDangerousCache(*p, faction);
+	}
+}
+
+//Takes a path along the group's route if it passes close enough to us and our target
+bool NPC::FollowGroupPath(const GroupPath& group, const Coordinate& target) {
+	std::vector<Coordinate> followed;
+	{
+#if GCAMP_USE_THREADS
+		std::shared_lock readCacheLock(map->cacheMutex);
+#endif
+		if (!group.Follow(pos, target, map->Extent(), map, static_cast<void*>(this), followed)) return false;
+	}
+
+#if GCAMP_USE_THREADS
+	std::unique_lock pathLock(pathMutex);
+	std::shared_lock readCacheLock(map->cacheMutex);
+#endif
+	path.swap(followed);
+	pathIndex = 0;
+	nopath = false;
+	findPathWorking = false;
+	CheckPathDanger();
+	return true;
+}
+
+void NPC::ResumeGroupPath() {
+	if (awaitedGroup->GetState() == GroupPath::PENDING) return;
+	boost::shared_ptr<GroupPath> group;
+	group.swap(awaitedGroup);
+	if (group->GetState() == GroupPath::READY && FollowGroupPath(*group, awaitedTarget)) return;
+	findPath(awaitedTarget);
+}
+
 void NPC::speed(unsigned int value) {baseStats[MOVESPEED]=value;}
 unsigned int NPC::speed() const {return effectiveStats[MOVESPEED];}
 
@@ -1557,8 +1654,8 @@ void NPC::GetTooltip(int x, int y, Tooltip *tooltip) {
 	Entity::GetTooltip(x, y, tooltip);
 	if(faction == PLAYERFACTION && !jobs.empty()) {
 		boost::shared_ptr<Job> job = jobs.front();
-		if(job->name != "Idle") {
-			tooltip->AddEntry(TooltipEntry((boost::format("  %s") % job->name).str(), GCampColor::grey));
+		if(job->Name() != "Idle") {
+			tooltip->AddEntry(TooltipEntry((boost::format("  %s") % job->Name()).str(), GCampColor::grey));
 		}
 	}
 }
@@ -1640,22 +1737,21 @@ boost::weak_ptr<Entity> NPC::currentEntity() const {
 }
 
 
-void tFindPath(TCODPath *path, int x0, int y0, int x1, int y1, NPC* npc, bool threaded) {
+void tFindPath(int x0, int y0, int x1, int y1, NPC* npc, bool threaded, boost::shared_ptr<GroupPath> leading) {
 #if GCAMP_USE_THREADS
 	std::unique_lock pathLock(npc->pathMutex);
 	std::shared_lock readCacheLock(npc->map->cacheMutex);
 #endif
-	npc->nopath = !path->compute(x0, y0, x1, y1);
+	TCODPath search(npc->map->Width(), npc->map->Height(), npc->map, static_cast<void*>(npc));
+	npc->nopath = !search.compute(x0, y0, x1, y1);
+	npc->path.resize(search.size());
+	for (int i = 0; i < search.size(); ++i) {
+		search.get(i, npc->path[i].Xptr(), npc->path[i].Yptr());
+	}
 
 	//TODO factorize with path walkability test
-	for (int i = 0; i < path->size(); ++i) {
-		Coordinate p;
-		path->get(i, p.Xptr(), p.Yptr());
-		if (npc->map->IsDangerousCache(p, npc->faction)) {
-			npc->pathIsDangerous = true;
-			break;//One dangerous tile = whole path considered dangerous
-		}
-	}
+	npc->CheckPathDanger();
+	if (leading) leading->Publish(npc->nopath ? 0 : &npc->path);
 
 	npc->findPathWorking = false;
 #if GCAMP_USE_THREADS
@@ -1671,7 +1767,7 @@ bool NPC::GetSquadJob(boost::shared_ptr<NPC> npc) {
 	if (boost::shared_ptr<Squad> squad = npc->MemberOf().lock()) {
 		JobManager::Inst()->NPCNotWaiting(npc->uid);
 		npc->aggressive = true;
-		boost::shared_ptr<Job> newJob(new Job("Follow orders"));
+		boost::shared_ptr<Job> newJob(Job::Create("Follow orders"));
 		newJob->internal = true;
 
 		//Priority #1, if the creature can wield a weapon get one if possible
@@ -1747,6 +1843,7 @@ bool NPC::GetSquadJob(boost::shared_ptr<NPC> npc) {
 				}
 
 				if (!newJob->tasks.empty()) {
+					npc->JoinGroupPath(squad->SharedPath(npc->orderIndex));
 					npc->jobs.push_back(newJob);
 					if (Distance(npc->Position(), squad->TargetCoordinate(npc->orderIndex)) < 10) npc->run = false;
 					return true;
@@ -1797,9 +1894,9 @@ void NPC::PlayerNPCReact(boost::shared_ptr<NPC> npc) {
 		surroundingsScanned = true;
 		
 		//NPCs with the CHICKENHEART trait panic more than usual if they see fire
-		if (npc->HasTrait(CHICKENHEART) && npc->seenFire && (npc->jobs.empty() || npc->jobs.front()->name != "Aaaaaaaah!!")) {
+		if (npc->HasTrait(CHICKENHEART) && npc->seenFire && (npc->jobs.empty() || npc->jobs.front()->Name() != "Aaaaaaaah!!")) {
 			while (!npc->jobs.empty()) npc->TaskFinished(TASKFAILNONFATAL, "(FAIL)Chickenheart");
-			boost::shared_ptr<Job> runAroundLikeAHeadlessChickenJob(new Job("Aaaaaaaah!!"));
+			boost::shared_ptr<Job> runAroundLikeAHeadlessChickenJob(Job::Create("Aaaaaaaah!!"));
 			for (int i = 0; i < 30; ++i)
 				runAroundLikeAHeadlessChickenJob->tasks.push_back(Task(MOVE, Random::ChooseInRadius(npc->Position(), 2)));
 			runAroundLikeAHeadlessChickenJob->internal = true;
@@ -1830,7 +1927,7 @@ void NPC::PlayerNPCReact(boost::shared_ptr<NPC> npc) {
 				for (std::list<boost::weak_ptr<NPC> >::iterator npci = npc->nearNpcs.begin(); npci != npc->nearNpcs.end(); ++npci) {
 					if (!npc->factionPtr->IsFriendsWith(npci->lock()->GetFaction())) {
 						JobManager::Inst()->NPCNotWaiting(npc->uid);
-						boost::shared_ptr<Job> killJob(new Job("Kill "+npci->lock()->name));
+						boost::shared_ptr<Job> killJob(Job::Create("Kill "+npci->lock()->name));
 						killJob->internal = true;
 						killJob->tasks.push_back(Task(KILL, npci->lock()->Position(), *npci));
 						while (!npc->jobs.empty()) npc->TaskFinished(TASKFAILNONFATAL, "(FAIL)Kill enemy");
@@ -1865,7 +1962,7 @@ void NPC::AnimalReact(boost::shared_ptr<NPC> animal) {
 					if (!construct->HasTag(PERMANENT) &&
 						(construct->HasTag(WORKSHOP) || 
 						(construct->HasTag(WALL) && Random::Generate(10) == 0))) {
-						boost::shared_ptr<Job> destroyJob(new Job("Destroy "+construct->Name()));
+						boost::shared_ptr<Job> destroyJob(Job::Create("Destroy "+construct->Name()));
 						destroyJob->internal = true;
 						destroyJob->tasks.push_back(Task(MOVEADJACENT, construct->Position(), construct));
 						destroyJob->tasks.push_back(Task(KILL, construct->Position(), construct));
@@ -1879,7 +1976,7 @@ void NPC::AnimalReact(boost::shared_ptr<NPC> animal) {
 			for (std::list<boost::weak_ptr<NPC> >::iterator npci = animal->nearNpcs.begin(); npci != animal->nearNpcs.end(); ++npci) {
 				boost::shared_ptr<NPC> otherNPC = npci->lock();
 				if (otherNPC && !animal->factionPtr->IsFriendsWith(otherNPC->GetFaction())) {
-					boost::shared_ptr<Job> killJob(new Job("Kill "+otherNPC->name));
+					boost::shared_ptr<Job> killJob(Job::Create("Kill "+otherNPC->name));
 					killJob->internal = true;
 					killJob->tasks.push_back(Task(KILL, otherNPC->Position(), *npci));
 					while (!animal->jobs.empty()) animal->TaskFinished(TASKFAILNONFATAL);
@@ -1927,24 +2024,29 @@ void NPC::AddEffect(StatusEffect effect) {
 
 	if (effect.type == FLYING) isFlying = true;
 
-	for (std::list<StatusEffect>::iterator statusEffectI = statusEffects.begin(); statusEffectI != statusEffects.end(); ++statusEffectI) {
-		if (statusEffectI->type == effect.type) {
-			statusEffectI->cooldown = statusEffectI->cooldownDefault;
-			return;
+	if (HasEffect((StatusEffectType)effect.type)) {
+		for (std::list<StatusEffect>::iterator statusEffectI = statusEffects.begin(); statusEffectI != statusEffects.end(); ++statusEffectI) {
+			if (statusEffectI->type == effect.type) {
+				statusEffectI->cooldown = statusEffectI->cooldownDefault;
+				return;
+			}
 		}
 	}
 
 	statusEffects.push_back(effect);
 	statusEffectsChanged = true;
+	UpdateEffectCache();
 }
 
 void NPC::RemoveEffect(StatusEffectType effect) {
 	if (effect == FLYING) isFlying = false;
+	if (!HasEffect(effect)) return;
 
 	for (std::list<StatusEffect>::iterator statusEffectI = statusEffects.begin(); statusEffectI != statusEffects.end(); ++statusEffectI) {
 		if (statusEffectI->type == effect) {
 			if (statusEffectIterator == statusEffectI) ++statusEffectIterator;
 			statusEffects.erase(statusEffectI);
+			UpdateEffectCache();
 			if (statusEffectIterator == statusEffects.end()) statusEffectIterator = statusEffects.begin();
 
 			if (statusEffectIterator != statusEffects.end() && !statusEffectIterator->visible) {
@@ -1966,12 +2068,19 @@ void NPC::RemoveEffect(StatusEffectType effect) {
 }
 
 bool NPC::HasEffect(StatusEffectType effect) const {
+	return effectFlags.test(effect);
+}
+
+void NPC::UpdateEffectCache() {
+	effectFlags.reset();
+	for (int i = 0; i < STAT_COUNT; ++i) effectStatMultipliers[i] = 1;
+	for (int i = 0; i < RES_COUNT; ++i) effectResistanceMultipliers[i] = 1;
+
 	for (std::list<StatusEffect>::const_iterator statusEffectI = statusEffects.begin(); statusEffectI != statusEffects.end(); ++statusEffectI) {
-		if (statusEffectI->type == effect) {
-			return true;
-		}
+		effectFlags.set(statusEffectI->type);
+		for (int i = 0; i < STAT_COUNT; ++i) effectStatMultipliers[i] *= statusEffectI->statChanges[i];
+		for (int i = 0; i < RES_COUNT; ++i) effectResistanceMultipliers[i] *= statusEffectI->resistanceChanges[i];
 	}
-	return false;
 }
 
 std::list<StatusEffect>* NPC::StatusEffects() { return &statusEffects; }
@@ -1983,6 +2092,7 @@ void NPC::AbortCurrentJob(bool remove_job) {
 }
 
 void NPC::Hit(boost::weak_ptr<Entity> target, bool careful) {
+	Random::StreamScope combatStream(Random::CombatStream);
 	if (target.lock()) {
 		boost::shared_ptr<NPC> npc = boost::dynamic_pointer_cast<NPC>(target.lock());
 		boost::shared_ptr<Construction> construction = boost::dynamic_pointer_cast<Construction>(target.lock());
@@ -2025,6 +2135,7 @@ void NPC::Hit(boost::weak_ptr<Entity> target, bool careful) {
 }
 
 void NPC::FireProjectile(boost::weak_ptr<Entity> target) {
+	Random::StreamScope combatStream(Random::CombatStream);
 	if (boost::shared_ptr<Entity> targetEntity = target.lock()) {
 		for (std::list<Attack>::iterator attacki = attacks.begin(); attacki != attacks.end(); ++attacki) {
 			if (attacki->Type() == DAMAGE_WIELDED) {
@@ -2065,6 +2176,7 @@ void NPC::CastOffensiveSpell(boost::weak_ptr<Entity> target) {
 
 
 void NPC::Damage(Attack* attack, boost::weak_ptr<NPC> aggr) {
+	Random::StreamScope combatStream(Random::CombatStream);
 	Resistance res;
 
 	switch (attack->Type()) {
@@ -2118,7 +2230,7 @@ void NPC::Damage(Attack* attack, boost::weak_ptr<NPC> aggr) {
 			AddEffect(BURNING);
 		}
 		if (aggr.lock()) aggressor = aggr;
-		if (!jobs.empty() && boost::iequals(jobs.front()->name, "Sleep")) {
+		if (!jobs.empty() && boost::iequals(jobs.front()->Name(), "Sleep")) {
 			TaskFinished(TASKFAILFATAL);
 		}
 	}
@@ -2410,7 +2522,7 @@ void NPC::FindNewWeapon() {
 	ItemCategory weaponCategory = squad.lock() ? squad.lock()->Weapon() : Item::StringToItemCategory("Weapon");
 	boost::weak_ptr<Item> newWeapon = Game::Inst()->FindItemByCategoryFromStockpiles(weaponCategory, Position(), BETTERTHAN, weaponValue);
 	if (boost::shared_ptr<Item> weapon = newWeapon.lock()) {
-		boost::shared_ptr<Job> weaponJob(new Job("Grab weapon"));
+		boost::shared_ptr<Job> weaponJob(Job::Create("Grab weapon"));
 		weaponJob->internal = true;
 		weaponJob->ReserveEntity(weapon);
 		weaponJob->tasks.push_back(Task(MOVE, weapon->Position()));
@@ -2428,7 +2540,7 @@ void NPC::FindNewArmor() {
 	ItemCategory armorCategory = squad.lock() ? squad.lock()->Armor() : Item::StringToItemCategory("Armor");
 	boost::weak_ptr<Item> newArmor = Game::Inst()->FindItemByCategoryFromStockpiles(armorCategory, Position(), BETTERTHAN, armorValue);
 	if (boost::shared_ptr<Item> arm = newArmor.lock()) {
-		boost::shared_ptr<Job> armorJob(new Job("Grab armor"));
+		boost::shared_ptr<Job> armorJob(Job::Create("Grab armor"));
 		armorJob->internal = true;
 		armorJob->ReserveEntity(arm);
 		armorJob->tasks.push_back(Task(MOVE, arm->Position()));
@@ -2559,6 +2671,81 @@ NPCPreset::NPCPreset(std::string typeNameVal) :
 	group.nb_faces = 1;
 }
 
+void NPCPreset::save(OutputArchive& ar, const unsigned int version) const {
+	ar & typeName;
+	ar & name;
+	ar & plural;
+	ar & color.r;
+	ar & color.g;
+	ar & color.b;
+	ar & graphic;
+	ar & expert;
+	ar & health;
+	ar & ai;
+	ar & needsNutrition;
+	ar & needsSleep;
+	ar & generateName;
+	ar & stats;
+	ar & resistances;
+	ar & spawnAsGroup;
+	ar & group.nb_rolls;
+	ar & group.nb_faces;
+	ar & group.multiplier;
+	ar & group.addsub;
+	ar & attacks;
+	ar & tags;
+	ar & tier;
+	ar & deathItem;
+	ar & fallbackGraphicsSet;
+	ar & graphicsHint;
+	ar & possibleEquipment;
+	ar & faction;
+}
+
+void NPCPreset::load(InputArchive& ar, const unsigned int version) {
+	ar & typeName;
+	ar & name;
+	ar & plural;
+	ar & color.r;
+	ar & color.g;
+	ar & color.b;
+	ar & graphic;
+	ar & expert;
+	ar & health;
+	ar & ai;
+	ar & needsNutrition;
+	ar & needsSleep;
+	ar & generateName;
+	ar & stats;
+	ar & resistances;
+	ar & spawnAsGroup;
+	ar & group.nb_rolls;
+	ar & group.nb_faces;
+	ar & group.multiplier;
+	ar & group.addsub;
+	ar & attacks;
+	ar & tags;
+	ar & tier;
+	ar & deathItem;
+	ar & fallbackGraphicsSet;
+	ar & graphicsHint;
+	ar & possibleEquipment;
+	ar & faction;
+}
+
+//The creature tables as they are after loading every mod, see PresetCache
+void NPC::SavePresetCache(OutputArchive& ar) {
+	ar & Presets;
+	ar & NPCTypeNames;
+}
+
+void NPC::LoadPresetCache(InputArchive& ar) {
+	Presets.clear();
+	NPCTypeNames.clear();
+	ar & Presets;
+	ar & NPCTypeNames;
+}
+
 int NPC::GetHealth() const { return health; }
 int NPC::GetMaxHealth() const { return maxHealth; }
 
@@ -2577,6 +2764,10 @@ void NPC::AbortJob(boost::weak_ptr<Job> wjob) {
 
 bool NPC::IsTunneler() const { return isTunneler; }
 
+bool NPC::BoundToWalkableArea() const {
+	return !HasEffect(FLYING) && HasHands() && !IsTunneler();
+}
+
 void NPC::ScanSurroundings(bool onlyHostiles) {
 	/* The algorithm performs in the following, slightly wrong, way:
 
@@ -2705,7 +2896,7 @@ void NPC::GoBerserk() {
 
 	if (!nearNpcs.empty()) {
 		boost::shared_ptr<NPC> creature = boost::next(nearNpcs.begin(), Random::ChooseIndex(nearNpcs))->lock();
-		boost::shared_ptr<Job> berserkJob(new Job("Berserk!"));
+		boost::shared_ptr<Job> berserkJob(Job::Create("Berserk!"));
 		berserkJob->internal = true;
 		berserkJob->tasks.push_back(Task(KILL, creature->Position(), creature));
 		jobs.push_back(berserkJob);
@@ -2741,7 +2932,7 @@ void NPC::UpdateHealth() {
 	if (faction == PLAYERFACTION && health < maxHealth / 2 && !HasEffect(HEALING)) {
 		bool healJobFound = false;
 		for (std::deque<boost::shared_ptr<Job> >::iterator jobi = jobs.begin(); jobi != jobs.end(); ++jobi) {
-			if ((*jobi)->name.find("Heal") != std::string::npos) {
+			if ((*jobi)->Name().find("Heal") != std::string::npos) {
 				healJobFound = true;
 				break;
 			}
@@ -2754,7 +2945,7 @@ void NPC::UpdateHealth() {
 					healItem = Game::Inst()->FindItemByTypeFromStockpiles(fixi->second, Position()).lock();
 			}
 			if (healItem) {
-				boost::shared_ptr<Job> healJob(new Job("Heal"));
+				boost::shared_ptr<Job> healJob(Job::Create("Heal"));
 				healJob->internal = true;
 				healJob->ReserveEntity(healItem);
 				healJob->tasks.push_back(Task(MOVE, healItem->Position()));
@@ -2836,7 +3027,7 @@ void NPC::ValidateCurrentJob() {
 				break;
 
 			case POUR:
-				if (!boost::iequals(jobs.front()->name, "Dump filth")) { //Filth dumping is the one time we want to pour liquid onto an unmarked tile
+				if (!boost::iequals(jobs.front()->Name(), "Dump filth")) { //Filth dumping is the one time we want to pour liquid onto an unmarked tile
 					if (!jobs.front()->tasks[i].entity.lock() && !map->GroundMarked(jobs.front()->tasks[i].target)) {
 						TaskFinished(TASKFAILFATAL, "(POUR)Target does not exist");
 						return;
@@ -3215,6 +3406,7 @@ void NPC::load(InputArchive& ar, const unsigned int version) {
 	ar & weariness;
 	ar & thinkSpeed;
 	ar & statusEffects;
+	UpdateEffectCache();
 	ar & health;
 	if (failedToFindType) health = 0;
 	ar & maxHealth;
@@ -16,12 +16,20 @@ You should have received a copy of the GNU General Public License
 along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
 #include "stdafx.hpp"
 
+#include <boost/version.hpp>
+#if BOOST_VERSION/100 == 1074
+/* https://stackoverflow.com/questions/65179639/monero-bigsur-update-no-member-named-library-version-type-in-namespace-boos*/
+#include <boost/serialization/library_version_type.hpp>
+#endif
+
 #ifdef DEBUG
 #include <iostream>
 #endif
 
 #include <boost/algorithm/string.hpp>
 #include <boost/serialization/shared_ptr.hpp>
+#include <boost/serialization/list.hpp>
+#include <boost/serialization/vector.hpp>
 
 #include "NatureObject.hpp"
 #include "Map.hpp"
@@ -48,8 +56,58 @@ NatureObjectPreset::NatureObjectPreset() :
 	graphicsHint(-1)
 {}
 
+void NatureObjectPreset::save(OutputArchive& ar, const unsigned int version) const {
+	ar & name;
+	ar & graphic;
+	ar & color.r;
+	ar & color.g;
+	ar & color.b;
+	ar & components;
+	ar & rarity;
+	ar & cluster;
+	ar & condition;
+	ar & tree;
+	ar & harvestable;
+	ar & walkable;
+	ar & minHeight;
+	ar & maxHeight;
+	ar & evil;
+	ar & fallbackGraphicsSet;
+	ar & graphicsHint;
+}
+
+void NatureObjectPreset::load(InputArchive& ar, const unsigned int version) {
+	ar & name;
+	ar & graphic;
+	ar & color.r;
+	ar & color.g;
+	ar & color.b;
+	ar & components;
+	ar & rarity;
+	ar & cluster;
+	ar & condition;
+	ar & tree;
+	ar & harvestable;
+	ar & walkable;
+	ar & minHeight;
+	ar & maxHeight;
+	ar & evil;
+	ar & fallbackGraphicsSet;
+	ar & graphicsHint;
+}
+
 std::vector<NatureObjectPreset> NatureObject::Presets = std::vector<NatureObjectPreset>();
 
+//The wild plant tables as they are after loading every mod, see PresetCache
+void NatureObject::SavePresetCache(OutputArchive& ar) {
+	ar & Presets;
+}
+
+void NatureObject::LoadPresetCache(InputArchive& ar) {
+	Presets.clear();
+	ar & Presets;
+}
+
 NatureObject::NatureObject(Coordinate pos, NatureObjectType typeVal) : Entity(),
 	type(typeVal),
 	marked(false),
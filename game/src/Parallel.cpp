@@ -0,0 +1,54 @@
+/* Copyright 2010-2011 Ilkka Halila
+This file is part of Goblins' Lot (former Goblin Camp)
+
+Goblin Camp is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Goblin Camp is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
+#include "stdafx.hpp"
+
+#include <vector>
+#include <algorithm>
+#if GCAMP_USE_THREADS
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#endif
+
+#include "Parallel.hpp"
+
+void ParallelFor(size_t count, const boost::function<void(size_t)>& job) {
+#if GCAMP_USE_THREADS
+	std::atomic<size_t> next(0);
+	std::exception_ptr error;
+	std::mutex errorMutex;
+
+	size_t workers = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), count));
+	std::vector<std::thread> threads;
+	for (size_t i = 0; i < workers; ++i) {
+		threads.push_back(std::thread([&]() {
+			for (size_t idx = next++; idx < count; idx = next++) {
+				try {
+					job(idx);
+				} catch (...) {
+					std::lock_guard<std::mutex> lock(errorMutex);
+					if (!error) error = std::current_exception();
+				}
+			}
+		}));
+	}
+	for (size_t i = 0; i < threads.size(); ++i) threads[i].join();
+	if (error) std::rethrow_exception(error);
+#else
+	for (size_t idx = 0; idx < count; ++idx) job(idx);
+#endif
+}
@@ -17,19 +17,25 @@ along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
 #include "stdafx.hpp"
 
 #include <boost/random.hpp>
+#include <boost/scoped_ptr.hpp>
 #include <ctime>
 #include <cmath>
 #include <algorithm>
+#if GCAMP_USE_THREADS
+#include <atomic>
+#include <thread>
+#endif
 
 #include "Random.hpp"
 #include "Logger.hpp"
 
 namespace Globals {
 	/**
-		The global pseudo-random number generator.
+		The global pseudo-random number generators, one per \ref Random::StreamType.
 		Seeded in \ref Random::Init.
 	*/
-	Random::Generator generator;
+	Random::Generator streams[Random::StreamCount];
+	unsigned int masterSeed = 0;
 }
 
 namespace {
@@ -44,7 +50,50 @@ namespace {
 	*/
 	template <typename G, typename D>
 	inline typename D::result_type InternalGenerate(G& generator, D distribution) {
-		return boost::variate_generator<G&, D>(generator, distribution)();
+		return distribution(generator);
+	}
+	
+	/**
+		Derives the seed of a stream from the master seed.
+		
+		\param[in] master Master seed.
+		\param[in] index  Stream index.
+		\returns          Nonzero seed value.
+	*/
+	unsigned int StreamSeed(unsigned int master, unsigned int index) {
+		boost::uint64_t z = (static_cast<boost::uint64_t>(master) << 32) + index + 1;
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		z ^= z >> 31;
+		unsigned int seed = static_cast<unsigned int>(z ^ (z >> 32));
+		return seed ? seed : 1;
+	}
+	
+	/**
+		Stream selected with \ref Random::StreamScope in this thread, if any.
+	*/
+	thread_local Random::Generator* current = 0;
+	
+#if GCAMP_USE_THREADS
+	std::thread::id mainThread;
+	std::atomic<unsigned int> threadStreamCount(0);
+	thread_local boost::scoped_ptr<Random::Generator> threadStream;
+#endif
+	
+	/**
+		Returns the generator the Random:: functions should use in this thread.
+	*/
+	Random::Generator& Current() {
+		if (current) return *current;
+#if GCAMP_USE_THREADS
+		if (std::this_thread::get_id() != mainThread) {
+			if (!threadStream) {
+				threadStream.reset(new Random::Generator(StreamSeed(Globals::masterSeed, Random::StreamCount + threadStreamCount++)));
+			}
+			return *threadStream;
+		}
+#endif
+		return Globals::streams[Random::DefaultStream];
 	}
 	
 	/**
@@ -128,9 +177,9 @@ namespace Random {
 	
 	/**
 		\class Generator
-			An interface to seed and use Mersenne Twister-based PNRG.
+			An interface to seed and use xoshiro128**-based PNRG.
 			
-			\see Globals::generator
+			\see Globals::streams
 	*/
 	
 	/**
@@ -146,11 +195,11 @@ namespace Random {
 	/**
 		(Re-)seeds the generator.
 		
-		\param[in] seed New seed to use. If 0, then reuses seed from the global generator.
+		\param[in] seed New seed to use. If 0, then reuses seed from the default stream.
 	*/
 	void Generator::SetSeed(unsigned int seed) {
 		if (seed == 0) {
-			seed = Globals::generator.seed;
+			seed = Globals::streams[DefaultStream].seed;
 		}
 		this->seed = seed;
 		generator.seed(this->seed);
@@ -173,7 +222,7 @@ namespace Random {
 		\returns         A random number from specified range.
 	*/
 	int Generator::Generate(int start, int end) {
-		return InternalGenerate(generator, boost::uniform_int<>(start, end));
+		return InternalGenerate(generator, boost::random::uniform_int_distribution<>(start, end));
 	}
 	
 	/**
@@ -192,7 +241,23 @@ namespace Random {
 		\returns A random number from range [0, 1].
 	*/
 	double Generator::Generate() {
-		return InternalGenerate(generator, boost::uniform_01<>());
+		return InternalGenerate(generator, boost::random::uniform_01<>());
+	}
+	
+	/**
+		Generates the number of ticks until an event that has a 1 in period
+		chance of happening every tick happens, using geometric distribution.
+		Sampling this once replaces rolling Generate(period - 1) == 0 every tick.
+		
+		\param[in] period The average amount of ticks between events.
+		\returns          A random number, at least 1.
+	*/
+	int Generator::Geometric(int period) {
+		if (period <= 1) return 1;
+		double u = 1.0 - Generate(); // (0, 1]
+		if (u <= 0.0) return 1;
+		double ticks = std::floor(std::log(u) / std::log(1.0 - 1.0 / period)) + 1.0;
+		return static_cast<int>(std::min(ticks, 1e9));
 	}
 	
 	/**
@@ -265,53 +330,115 @@ namespace Random {
 		Initialises the PRNG.
 	*/
 	void Init() {
+#if GCAMP_USE_THREADS
+		mainThread = std::this_thread::get_id();
+#endif
 		unsigned int seed = GetStandardSeed();
 		LOG("Seeding global random generator with " << seed);
-		Globals::generator.SetSeed(seed);
+		Seed(seed);
+	}
+	
+	/**
+		Reseeds every stream, the same master seed always gives the same streams.
+		Thread streams created afterwards are derived from it as well.
+		
+		\param[in] master Master seed.
+	*/
+	void Seed(unsigned int master) {
+		Globals::masterSeed = master;
+		for (unsigned int i = 0; i < StreamCount; ++i) {
+			Globals::streams[i].SetSeed(StreamSeed(master, i));
+		}
+	}
+	
+	/**
+		Returns the seed last given to \ref Seed.
+	*/
+	unsigned int MasterSeed() {
+		return Globals::masterSeed;
+	}
+	
+	/**
+		Derives a seed for one part of a job split over several generators, so that
+		each part draws the same numbers however the parts are scheduled.
+		
+		\param[in] seed  Seed of the whole job.
+		\param[in] index Index of the part.
+		\returns         Nonzero seed value.
+	*/
+	unsigned int DeriveSeed(unsigned int seed, unsigned int index) {
+		return StreamSeed(seed, index);
+	}
+	
+	/**
+		Returns a named stream.
+		
+		\param[in] stream Which stream.
+		\returns          The stream generator.
+	*/
+	Generator& Stream(StreamType stream) {
+		return Globals::streams[stream];
+	}
+	
+	StreamScope::StreamScope(StreamType stream) : previous(current) {
+		current = &Globals::streams[stream];
+	}
+	
+	StreamScope::StreamScope(Generator& generator) : previous(current) {
+		current = &generator;
+	}
+	
+	StreamScope::~StreamScope() {
+		current = previous;
 	}
 	
 	/** \copydoc Generator::Generate(int, int) */
 	int Generate(int start, int end) {
-		return Globals::generator.Generate(start, end);
+		return Current().Generate(start, end);
 	}
 	
 	/** \copydoc Generator::Generate(int) */
 	int Generate(int end) {
-		return Globals::generator.Generate(end);
+		return Current().Generate(end);
 	}
 	
 	/** \copydoc Generator::Generate() */
 	double Generate() {
-		return Globals::generator.Generate();
+		return Current().Generate();
+	}
+	
+	/** \copydoc Generator::Geometric */
+	int Geometric(int period) {
+		return Current().Geometric(period);
 	}
 	
 	/** \copydoc Generator::GenerateBool */
 	bool GenerateBool() {
-		return Globals::generator.GenerateBool();
+		return Current().GenerateBool();
 	}
 	
 	/** \copydoc Generator::Sign */
 	short Sign() {
-		return Globals::generator.Sign();
+		return Current().Sign();
 	}
 
 	/** \copydoc Generator::ChooseInExtent */
 	Coordinate ChooseInExtent(const Coordinate& zero, const Coordinate& extent) {
-		return Globals::generator.ChooseInExtent(zero, extent);
+		return Current().ChooseInExtent(zero, extent);
 	}
 	Coordinate ChooseInExtent(const Coordinate& extent) {
-		return Globals::generator.ChooseInExtent(extent);
+		return Current().ChooseInExtent(extent);
 	}
 	/** \copydoc Generator::ChooseInRadius */
 	Coordinate ChooseInRadius(const Coordinate& origin, int radius) {
-		return Globals::generator.ChooseInRadius(origin, radius);
+		return Current().ChooseInRadius(origin, radius);
 	}
 	Coordinate ChooseInRadius(int radius) {
-		return Globals::generator.ChooseInRadius(radius);
+		return Current().ChooseInRadius(radius);
 	}
 	/** \copydoc Generator::ChooseInRectangle */
 	Coordinate ChooseInRectangle(const Coordinate& low, const Coordinate& high) {
-		return Globals::generator.ChooseInRectangle(low, high);
+		return Current().ChooseInRectangle(low, high);
 	}
 
 	/**
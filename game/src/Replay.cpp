@@ -0,0 +1,160 @@
+/* Copyright 2010-2011 Ilkka Halila
+This file is part of Goblins' Lot (former Goblin Camp)
+
+Goblin Camp is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Goblin Camp is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
+#include "stdafx.hpp"
+
+#include <fstream>
+#include <ctime>
+#include <cstring>
+
+#include "Replay.hpp"
+#include "Random.hpp"
+#include "Logger.hpp"
+
+/* Replay file format, plain text:
+     GCREPLAY 1
+     seed <new game seed>
+   then one line per frame that had input:
+     k <frame> <vk> <c> <pressed> <lalt> <lctrl> <ralt> <rctrl> <shift>
+     m <frame> <x> <y> <dx> <dy> <cx> <cy> <dcx> <dcy> <buttons>
+   where buttons packs lbutton, rbutton, mbutton, their _pressed flags, wheel_up and
+   wheel_down, one bit each in that order. */
+namespace {
+	enum Mode { ModeOff, ModeRecording, ModePlaying };
+
+	Mode mode = ModeOff;
+	std::ofstream output;
+	std::ifstream input;
+	unsigned long frame = 0;
+
+	//Next recorded line when playing back
+	char nextType = 0;
+	unsigned long nextFrame = 0;
+	TCOD_mouse_t lastMouse;
+
+	int PackButtons(const TCOD_mouse_t& mouse) {
+		return mouse.lbutton | mouse.rbutton << 1 | mouse.mbutton << 2 |
+			mouse.lbutton_pressed << 3 | mouse.rbutton_pressed << 4 | mouse.mbutton_pressed << 5 |
+			mouse.wheel_up << 6 | mouse.wheel_down << 7;
+	}
+
+	void UnpackButtons(TCOD_mouse_t& mouse, int buttons) {
+		mouse.lbutton         = (buttons & 1) != 0;
+		mouse.rbutton         = (buttons & 2) != 0;
+		mouse.mbutton         = (buttons & 4) != 0;
+		mouse.lbutton_pressed = (buttons & 8) != 0;
+		mouse.rbutton_pressed = (buttons & 16) != 0;
+		mouse.mbutton_pressed = (buttons & 32) != 0;
+		mouse.wheel_up        = (buttons & 64) != 0;
+		mouse.wheel_down      = (buttons & 128) != 0;
+	}
+
+	void ReadNext() {
+		if (!(input >> nextType >> nextFrame)) {
+			LOG("Replay finished at frame " << frame);
+			nextType = 0;
+			mode = ModeOff;
+		}
+	}
+}
+
+namespace Replay {
+	bool Record(const std::string& filename) {
+		output.open(filename.c_str());
+		if (!output) {
+			LOG("Cannot open replay file " << filename << " for writing");
+			return false;
+		}
+		output << "GCREPLAY 1\n";
+		mode = ModeRecording;
+		return true;
+	}
+
+	bool Play(const std::string& filename) {
+		input.open(filename.c_str());
+		std::string magic;
+		int version = 0;
+		if (!(input >> magic >> version) || magic != "GCREPLAY" || version != 1) {
+			LOG("Cannot read replay file " << filename);
+			return false;
+		}
+		std::memset(&lastMouse, 0, sizeof lastMouse);
+		mode = ModePlaying;
+		return true;
+	}
+
+	bool Active() { return mode != ModeOff; }
+	bool Playing() { return mode == ModePlaying; }
+
+	unsigned int NewGameSeed() {
+		unsigned int seed = static_cast<unsigned int>(time(NULL));
+		if (mode == ModePlaying) {
+			std::string key;
+			if (!(input >> key >> seed) || key != "seed") {
+				LOG("Replay file has no seed, stopping playback");
+				mode = ModeOff;
+			} else {
+				frame = 0;
+				ReadNext();
+			}
+		} else if (mode == ModeRecording) {
+			output << "seed " << seed << '\n';
+			frame = 0;
+		}
+		return seed;
+	}
+
+	void Frame() {
+		++frame;
+	}
+
+	void Key(TCOD_key_t& key) {
+		if (mode == ModeRecording) {
+			if (key.vk != TCODK_NONE) {
+				output << "k " << frame << ' ' << key.vk << ' ' << static_cast<int>(key.c) << ' ' << key.pressed << ' '
+					<< key.lalt << ' ' << key.lctrl << ' ' << key.ralt << ' ' << key.rctrl << ' ' << key.shift << '\n';
+			}
+		} else if (mode == ModePlaying) {
+			std::memset(&key, 0, sizeof key);
+			key.vk = TCODK_NONE;
+			if (nextType == 'k' && nextFrame == frame) {
+				int vk, c;
+				input >> vk >> c >> key.pressed >> key.lalt >> key.lctrl >> key.ralt >> key.rctrl >> key.shift;
+				key.vk = static_cast<TCOD_keycode_t>(vk);
+				key.c = static_cast<char>(c);
+				ReadNext();
+			}
+		}
+	}
+
+	void Mouse(TCOD_mouse_t& mouse) {
+		if (mode == ModeRecording) {
+			if (frame == 1 || std::memcmp(&mouse, &lastMouse, sizeof mouse) != 0) {
+				output << "m " << frame << ' ' << mouse.x << ' ' << mouse.y << ' ' << mouse.dx << ' ' << mouse.dy << ' '
+					<< mouse.cx << ' ' << mouse.cy << ' ' << mouse.dcx << ' ' << mouse.dcy << ' ' << PackButtons(mouse) << '\n';
+				lastMouse = mouse;
+			}
+		} else if (mode == ModePlaying) {
+			if (nextType == 'm' && nextFrame == frame) {
+				int buttons;
+				input >> lastMouse.x >> lastMouse.y >> lastMouse.dx >> lastMouse.dy
+					>> lastMouse.cx >> lastMouse.cy >> lastMouse.dcx >> lastMouse.dcy >> buttons;
+				UnpackButtons(lastMouse, buttons);
+				ReadNext();
+			}
+			mouse = lastMouse;
+		}
+	}
+}
@@ -0,0 +1,57 @@
+/* Copyright 2010-2011 Ilkka Halila
+This file is part of Goblins' Lot (former Goblin Camp)
+
+Goblin Camp is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Goblin Camp is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
+#include "stdafx.hpp"
+
+#include "SpatialIndex.hpp"
+
+SpatialIndex::SpatialIndex(int cellSize) : cellSize(cellSize), cells(0, 0), count(0) {
+}
+
+void SpatialIndex::Reset(const Coordinate& extent) {
+	cells = Coordinate((extent.X() + cellSize - 1) / cellSize, (extent.Y() + cellSize - 1) / cellSize);
+	grid.clear();
+	grid.resize(cells.X() * cells.Y());
+	count = 0;
+}
+
+void SpatialIndex::Insert(const Coordinate& p) {
+	if (!p.insideExtent(zero, cells * cellSize)) return;
+	std::vector<Coordinate>& cell = Cell(p);
+	if (std::find(cell.begin(), cell.end(), p) == cell.end()) {
+		cell.push_back(p);
+		++count;
+	}
+}
+
+void SpatialIndex::Remove(const Coordinate& p) {
+	if (!p.insideExtent(zero, cells * cellSize)) return;
+	std::vector<Coordinate>& cell = Cell(p);
+	std::vector<Coordinate>::iterator posi = std::find(cell.begin(), cell.end(), p);
+	if (posi != cell.end()) {
+		*posi = cell.back();
+		cell.pop_back();
+		--count;
+	}
+}
+
+bool SpatialIndex::Contains(const Coordinate& p) const {
+	if (!p.insideExtent(zero, cells * cellSize)) return false;
+	const std::vector<Coordinate>& cell = Cell(p.X() / cellSize, p.Y() / cellSize);
+	return std::find(cell.begin(), cell.end(), p) != cell.end();
+}
+
+size_t SpatialIndex::Size() const { return count; }
+bool SpatialIndex::Empty() const { return count == 0; }
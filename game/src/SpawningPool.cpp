@@ -90,7 +90,7 @@ void SpawningPool::Update() {
 		if (jobCount < 4) {
 			if (dumpFilth && Random::Generate(UPDATES_PER_SECOND * 4) == 0) {
 				if (Game::Inst()->filthList.size() > 0) {
-					boost::shared_ptr<Job> filthDumpJob(new Job("Dump filth", MED));
+					boost::shared_ptr<Job> filthDumpJob(Job::Create("Dump filth", MED));
 					filthDumpJob->SetRequiredTool(Item::StringToItemCategory("Bucket"));
 					filthDumpJob->Attempts(1);
 					Coordinate filthLocation = Game::Inst()->FindFilth(Position());
@@ -109,7 +109,7 @@ void SpawningPool::Update() {
 			}
 			if (dumpCorpses && StockManager::Inst()->CategoryQuantity(Item::StringToItemCategory("Corpse")) > 0 &&
 				Random::Generate(UPDATES_PER_SECOND * 4) == 0) {
-					boost::shared_ptr<Job> corpseDumpJob(new Job("Dump corpse", MED));
+					boost::shared_ptr<Job> corpseDumpJob(Job::Create("Dump corpse", MED));
 					corpseDumpJob->tasks.push_back(Task(FIND, Position(), boost::weak_ptr<Entity>(), Item::StringToItemCategory("Corpse")));
 					corpseDumpJob->tasks.push_back(Task(MOVE));
 					corpseDumpJob->tasks.push_back(Task(TAKE));
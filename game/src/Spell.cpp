@@ -24,6 +24,8 @@ along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
 
 #include <boost/algorithm/string.hpp>
 #include <boost/serialization/list.hpp>
+#include <boost/serialization/map.hpp>
+#include <boost/serialization/vector.hpp>
 
 #include "Spell.hpp"
 #include "Game.hpp"
@@ -44,6 +46,47 @@ name(vname),
 	graphicsHint(-1)
 {}
 
+void SpellPreset::save(OutputArchive& ar, const unsigned int version) const {
+	ar & name;
+	ar & attacks;
+	ar & immaterial;
+	ar & graphic;
+	ar & speed;
+	ar & color.r;
+	ar & color.g;
+	ar & color.b;
+	ar & fallbackGraphicsSet;
+	ar & graphicsHint;
+}
+
+void SpellPreset::load(InputArchive& ar, const unsigned int version) {
+	ar & name;
+	ar & attacks;
+	ar & immaterial;
+	ar & graphic;
+	ar & speed;
+	ar & color.r;
+	ar & color.g;
+	ar & color.b;
+	ar & fallbackGraphicsSet;
+	ar & graphicsHint;
+}
+
+//The spell tables as they are after loading every mod, see PresetCache
+void Spell::SavePresetCache(OutputArchive& ar) {
+	ar & Presets;
+	std::map<std::string, SpellType> names(spellTypeNames.begin(), spellTypeNames.end());
+	ar & names;
+}
+
+void Spell::LoadPresetCache(InputArchive& ar) {
+	Presets.clear();
+	ar & Presets;
+	std::map<std::string, SpellType> names;
+	ar & names;
+	spellTypeNames = boost::unordered_map<std::string, SpellType>(names.begin(), names.end());
+}
+
 Spell::Spell(const Coordinate& pos, int vtype) : Entity(),
 	type(vtype), dead(false), immaterial(false)
 {
@@ -104,10 +147,9 @@ void Spell::UpdateVelocity() {
 					if (!immaterial) {
 						if (Map::Inst()->BlocksWater(t) || !Map::Inst()->IsWalkable(t)) { //We've hit an obstacle
 							if (Map::Inst()->GetConstruction(t) > -1) {
-								if (boost::shared_ptr<Construction> construct = Game::Inst()->GetConstruction(Map::Inst()->GetConstruction(t)).lock()) {
-									for (std::list<Attack>::iterator attacki = attacks.begin(); attacki != attacks.end(); ++attacki) {
-										construct->Damage(&*attacki);
-									}
+								boost::weak_ptr<Construction> construct = Game::Inst()->GetConstruction(Map::Inst()->GetConstruction(t));
+								for (std::list<Attack>::iterator attacki = attacks.begin(); attacki != attacks.end(); ++attacki) {
+									Game::Inst()->QueueHit(construct, *attacki);
 								}
 							}
 							for (std::list<Attack>::iterator attacki = attacks.begin(); attacki != attacks.end(); ++attacki) {
@@ -124,9 +166,9 @@ void Spell::UpdateVelocity() {
 						if (Map::Inst()->NPCList(t)->size() > 0) { //Hit a creature
 							if (Random::Generate(std::max(1, flightPath.back().height) - 1) < (signed int)(2 + Map::Inst()->NPCList(t)->size())) {
 
-								boost::shared_ptr<NPC> npc = Game::Inst()->GetNPC(*Map::Inst()->NPCList(t)->begin());
+								boost::weak_ptr<NPC> npc = Game::Inst()->GetNPC(*Map::Inst()->NPCList(t)->begin());
 								for (std::list<Attack>::iterator attacki = attacks.begin(); attacki != attacks.end(); ++attacki) {
-									npc->Damage(&*attacki);
+									Game::Inst()->QueueHit(npc, *attacki);
 								}
 
 								Position(flightPath.back().coord);
@@ -32,6 +32,7 @@ along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
 
 #include "Squad.hpp"
 #include "Game.hpp"
+#include "GroupPath.hpp"
 
 Squad::Squad(std::string nameValue, int memberValue, int pri) :
 	name(nameValue),
@@ -83,12 +84,14 @@ void Squad::AddOrder(Order newOrder) {
 	orders.push_back(newOrder);
 	targetCoordinates.push_back(Coordinate(-1,-1));
 	targetEntities.push_back(boost::weak_ptr<Entity>());
+	groupPaths.push_back(boost::shared_ptr<GroupPath>());
 }
 
 void Squad::ClearOrders() {
 	orders.clear();
 	targetCoordinates.clear();
 	targetEntities.clear();
+	groupPaths.clear();
 	generalOrder = NOORDER;
 }
 
@@ -97,7 +100,20 @@ Coordinate Squad::TargetCoordinate(int index) {
 		return targetCoordinates[index];
 	} else return Coordinate(-1,-1);
 }
-void Squad::AddTargetCoordinate(Coordinate newTarget) {targetCoordinates.back() = newTarget;}
+void Squad::AddTargetCoordinate(Coordinate newTarget) {
+	targetCoordinates.back() = newTarget;
+	groupPaths.back().reset();
+}
+
+//Members heading for the same order's target share one route there
+boost::shared_ptr<GroupPath> Squad::SharedPath(int index) {
+	if (index < 0 || index >= static_cast<int>(orders.size())) return boost::shared_ptr<GroupPath>();
+	if (groupPaths.size() != orders.size()) groupPaths.resize(orders.size());
+	if (!groupPaths[index] || groupPaths[index]->GetState() == GroupPath::FAILED) {
+		groupPaths[index].reset(new GroupPath());
+	}
+	return groupPaths[index];
+}
 
 boost::weak_ptr<Entity> Squad::TargetEntity(int index) {
 	if (index >= 0 && index < static_cast<int>(targetEntities.size())) {
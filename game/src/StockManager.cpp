@@ -112,13 +112,13 @@ void StockManager::Init() {
 			}
 
 			//Anything not in the Misc. category can be shown in the stock manager dialog
-			if (Item::Presets[itemIndex].categories.find(Item::StringToItemCategory("Misc.")) == Item::Presets[itemIndex].categories.end())
+			if (!Item::Presets[itemIndex].IsCategory(Item::StringToItemCategory("Misc.")))
 				  producables.insert(item);
 		}
 
 		//Flag all inorganic materials for dumping (except seeds which are technically not organic)
 		if (!Item::Presets[itemIndex].organic &&
-			Item::Presets[itemIndex].categories.find(Item::StringToItemCategory("Seed")) == Item::Presets[itemIndex].categories.end())
+			!Item::Presets[itemIndex].IsCategory(Item::StringToItemCategory("Seed")))
 			dumpables.insert(item);
 	}
 }
@@ -148,7 +148,7 @@ void StockManager::Update() {
 									}
 							}
 							if (componentInTree) {
-								boost::shared_ptr<Job> fellJob(new Job("Fell tree", MED, 0, true));
+								boost::shared_ptr<Job> fellJob(Job::Create("Fell tree", MED, 0, true));
 								fellJob->Attempts(50);
 								fellJob->ConnectToEntity(*treei);
 								fellJob->DisregardTerritory();
@@ -170,7 +170,7 @@ void StockManager::Update() {
 						for (int i = bogIronJobs.size(); i < std::max(1, (int)(designatedBog.size() / 100)) && difference > 0; ++i) {
 							unsigned cIndex = Random::ChooseIndex(designatedBog);
 							Coordinate coord = *boost::next(designatedBog.begin(), cIndex);
-							boost::shared_ptr<Job> ironJob(new Job("Gather bog iron", MED, 0, true));
+							boost::shared_ptr<Job> ironJob(Job::Create("Gather bog iron", MED, 0, true));
 							ironJob->DisregardTerritory();
 							ironJob->tasks.push_back(Task(MOVE, coord));
 							ironJob->tasks.push_back(Task(BOGIRON));
@@ -185,7 +185,7 @@ void StockManager::Update() {
 					if (difference > 0) {
 						Coordinate waterLocation = Game::Inst()->FindWater(Camp::Inst()->Center());
 						if (waterLocation.X() >= 0 && waterLocation.Y() >= 0) {
-							boost::shared_ptr<Job> barrelWaterJob(new Job("Fill barrel", MED, 0, true));
+							boost::shared_ptr<Job> barrelWaterJob(Job::Create("Fill barrel", MED, 0, true));
 							barrelWaterJob->DisregardTerritory();
 							barrelWaterJob->tasks.push_back(Task(FIND, waterLocation, boost::weak_ptr<Entity>(), Item::StringToItemCategory("Barrel"), EMPTY));
 							barrelWaterJob->tasks.push_back(Task(MOVE));
@@ -235,7 +235,7 @@ void StockManager::Update() {
 			//The item is eligible for dumping and we have a surplus
 			if (Random::Generate(59) == 0) {
 				if (boost::shared_ptr<SpawningPool> spawningPool = Camp::Inst()->spawningPool.lock()) {
-					boost::shared_ptr<Job> dumpJob(new Job("Dump "+Item::ItemTypeToString(type), LOW));
+					boost::shared_ptr<Job> dumpJob(Job::Create("Dump "+Item::ItemTypeToString(type), LOW));
 					boost::shared_ptr<Item> item = Game::Inst()->FindItemByTypeFromStockpiles(type, spawningPool->Position()).lock();
 					if (item) {
 						dumpJob->Attempts(1);
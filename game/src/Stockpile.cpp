@@ -38,13 +38,14 @@ Stockpile::Stockpile(ConstructionType type, int newSymbol, Coordinate target) :
 	Construction(type, target),
 	symbol(newSymbol),
 	a(target),
-	b(target)
+	b(target),
+	spots(1),
+	spotCount(0)
 {
 	condition = maxCondition;
-	reserved.insert(std::pair<Coordinate,bool>(target,false));
 	Container *container = new Container(target, -1, 1000, -1);
 	container->AddListener(this);
-	containers.insert(std::pair<Coordinate,boost::shared_ptr<Container> >(target, boost::shared_ptr<Container>(container)));
+	AddSpot(target, boost::shared_ptr<Container>(container));
 
 	for (int i = 0; i < Game::ItemCatCount; ++i) {
 		amount.insert(std::pair<ItemCategory, int>(i,0));
@@ -62,9 +63,10 @@ Stockpile::Stockpile(ConstructionType type, int newSymbol, Coordinate target) :
 
 Stockpile::~Stockpile() {
 	//Loop through all the containers
-	for (std::map<Coordinate, boost::shared_ptr<Container> >::iterator conti = containers.begin(); conti != containers.end(); ++conti) {
+	for (std::vector<Spot>::iterator spoti = spots.begin(); spoti != spots.end(); ++spoti) {
+		if (!spoti->container) continue;
 		//Loop through all the items in the containers
-		for (std::set<boost::weak_ptr<Item> >::iterator itemi = conti->second->begin(); itemi != conti->second->end(); ++itemi) {
+		for (std::set<boost::weak_ptr<Item> >::iterator itemi = spoti->container->begin(); itemi != spoti->container->end(); ++itemi) {
 			//If the item is also a container, remove 'this' as a listener
 			if (itemi->lock() && itemi->lock()->IsCategory(Item::StringToItemCategory("Container"))) {
 				if (boost::dynamic_pointer_cast<Container>(itemi->lock())) {
@@ -89,7 +91,40 @@ Stockpile::~Stockpile() {
 
 void Stockpile::SetMap(Map* map) {
 	Construction::SetMap(map);
-	colors.insert(std::pair<Coordinate, TCODColor>(pos, TCODColor::lerp(color, map->GetColor(pos), 0.75f)));
+	if (Spot* spot = GetSpot(pos)) spot->color = TCODColor::lerp(color, map->GetColor(pos), 0.75f);
+}
+
+//Returns the spot at p, or 0 if p lies outside the bounding box
+Stockpile::Spot* Stockpile::GetSpot(const Coordinate& p) {
+	if (p.X() < a.X() || p.X() > b.X() || p.Y() < a.Y() || p.Y() > b.Y()) return 0;
+	return &spots[(p.Y() - a.Y()) * (b.X() - a.X() + 1) + (p.X() - a.X())];
+}
+
+Coordinate Stockpile::SpotPosition(size_t index) const {
+	int width = b.X() - a.X() + 1;
+	return Coordinate(a.X() + static_cast<int>(index) % width, a.Y() + static_cast<int>(index) / width);
+}
+
+//Lays the spots out over the box low..high, which has to contain every spot that has a container
+void Stockpile::Reshape(const Coordinate& low, const Coordinate& high) {
+	int width = high.X() - low.X() + 1;
+	std::vector<Spot> reshaped(width * (high.Y() - low.Y() + 1));
+	for (size_t i = 0; i < spots.size(); ++i) {
+		if (spots[i].container) {
+			Coordinate p = SpotPosition(i);
+			reshaped[(p.Y() - low.Y()) * width + (p.X() - low.X())] = spots[i];
+		}
+	}
+	spots.swap(reshaped);
+	a = low;
+	b = high;
+}
+
+void Stockpile::AddSpot(const Coordinate& p, boost::shared_ptr<Container> container) {
+	Spot* spot = GetSpot(p);
+	if (!spot->container) ++spotCount;
+	*spot = Spot();
+	spot->container = container;
 }
 
 int Stockpile::Build() {return 1;}
@@ -104,10 +139,10 @@ boost::weak_ptr<Item> Stockpile::FindItemByCategory(ItemCategory cat, int flags,
 	int itemsFound = 0; /*This keeps track of how many items we've found of the right category,
 						we can use this to know when we've searched through all of the items*/
 
-	for (std::map<Coordinate, boost::shared_ptr<Container> >::iterator conti = containers.begin(); 
-		conti != containers.end() && itemsFound < amount[cat]; ++conti) {
-		if (conti->second && !conti->second->empty()) {
-			boost::weak_ptr<Item> witem = *conti->second->begin();
+	for (std::vector<Spot>::iterator spoti = spots.begin(); 
+		spoti != spots.end() && itemsFound < amount[cat]; ++spoti) {
+		if (spoti->container && !spoti->container->empty()) {
+			boost::weak_ptr<Item> witem = *spoti->container->begin();
 			if (boost::shared_ptr<Item> item = witem.lock()) {
 				if (item->IsCategory(cat) && !item->Reserved()) {
 					//The item is the one we want, check that it fullfills all the requisite flags
@@ -205,10 +240,10 @@ boost::weak_ptr<Item> Stockpile::FindItemByType(ItemType typeValue, int flags, i
 																	 category. This'll give us an inaccurate
 																	 count, but it'll still make this faster*/
 
-	for (std::map<Coordinate, boost::shared_ptr<Container> >::iterator conti = containers.begin(); 
-		conti != containers.end() && itemsFound < amount[cat]; ++conti) {
-		if (!conti->second->empty()) {
-			boost::weak_ptr<Item> witem = *conti->second->begin();
+	for (std::vector<Spot>::iterator spoti = spots.begin(); 
+		spoti != spots.end() && itemsFound < amount[cat]; ++spoti) {
+		if (spoti->container && !spoti->container->empty()) {
+			boost::weak_ptr<Item> witem = *spoti->container->begin();
 			if (boost::shared_ptr<Item> item = witem.lock()) {
 				if (item->Type() == typeValue && !item->Reserved()) {
 					++itemsFound;
@@ -293,6 +328,9 @@ int Stockpile::Expand(Coordinate from, Coordinate to) {
 	//stockpile, add it. Do this max(width,height) times.
 	int expansion = 0;
 	int repeats = std::max(to.X() - from.X(), to.Y() - from.Y());
+	//Make room for the whole area up front, and shrink back to the tiles actually added afterwards
+	Coordinate low = a, high = b;
+	Reshape(Coordinate::min(a, from), Coordinate::max(b, to));
 	for (int repeatCount = 0; repeatCount <= repeats; ++repeatCount) {
 		for (int ix = from.X(); ix <= to.X(); ++ix) {
 			for (int iy = from.Y(); iy <= to.Y(); ++iy) {
@@ -307,21 +345,19 @@ int Stockpile::Expand(Coordinate from, Coordinate to) {
 					map->SetTerritory(p,true);
 					
 					//Update corner values to contain p
-					a = Coordinate::min(a, p);
-					b = Coordinate::max(b, p);
+					low = Coordinate::min(low, p);
+					high = Coordinate::max(high, p);
 
-					reserved.insert(std::pair<Coordinate,bool>(p,false));
 					boost::shared_ptr<Container> container = boost::shared_ptr<Container>(new Container(p, -1, 1000, -1));
 					container->AddListener(this);
-					containers.insert(std::pair<Coordinate,boost::shared_ptr<Container> >(p, container));
-					
-					//Update color
-					colors.insert(std::pair<Coordinate, TCODColor>(p, TCODColor::lerp(color, map->GetColor(p), 0.75f)));
+					AddSpot(p, container);
+					GetSpot(p)->color = TCODColor::lerp(color, map->GetColor(p), 0.75f);
 					++expansion;
 				}
 			}
 		}
 	}
+	Reshape(low, high);
 	return expansion;
 }
 
@@ -342,11 +378,12 @@ void Stockpile::Draw(Coordinate upleft, TCODConsole* console) {
 							console->setCharBackground(screenx, screeny, TCODColor(gray, gray, gray));
 						}
 
-						console->setCharForeground(screenx, screeny, colors[p]);
+						Spot* spot = GetSpot(p);
+						console->setCharForeground(screenx, screeny, spot->color);
 						console->setChar(screenx, screeny, (graphic[1]));
 
-						if (!containers[p]->empty()) {
-							boost::weak_ptr<Item> item = *containers[p]->begin();
+						if (spot->container && !spot->container->empty()) {
+							boost::weak_ptr<Item> item = *spot->container->begin();
 							if (item.lock()) {
 								item.lock()->Draw(upleft, console);
 								TCODColor bgColor = console->getCharBackground(screenx, screeny);
@@ -396,11 +433,14 @@ bool Stockpile::Full(ItemType itemType) {
 		for (int iy = a.Y() - 1; iy <= b.Y() + 1; ++iy) {
 			Coordinate p(ix,iy);
 			if (map->GetConstruction(p) == uid) {
+				Spot* spot = GetSpot(p);
+				if (!spot || !spot->container) continue;
+
 				//If theres a free space then it obviously is not full
-				if (containers[p]->empty() && !reserved[p]) return false;
+				if (spot->container->empty() && !spot->reserved) return false;
 
 				//Check if a container exists for this ItemCategory that isn't full
-				boost::weak_ptr<Item> item = containers[p]->GetFirstItem();
+				boost::weak_ptr<Item> item = spot->container->GetFirstItem();
 				if (item.lock() && item.lock()->IsCategory(Item::StringToItemCategory("Container"))) {
 					boost::shared_ptr<Container> container = boost::static_pointer_cast<Container>(item.lock());
 					if (type != -1 && container->IsCategory(Item::Presets[itemType].fitsin) && 
@@ -417,22 +457,17 @@ bool Stockpile::Full(ItemType itemType) {
 
 //New pile system: A free position is an existing empty space, or if there are none then we create one adjacent
 Coordinate Stockpile::FreePosition() {
-	if (containers.size() > 0) {
+	if (spotCount > 0) {
 		//First attempt to find a random position
-		for (int i = 0; i < std::max(1, (signed int)containers.size()/4); ++i) {
-			std::map<Coordinate, boost::shared_ptr<Container> >::iterator conti = boost::next(containers.begin(), Random::ChooseIndex(containers));
-			if (conti != containers.end() && conti->second && conti->second->empty() && !reserved[conti->first]) 
-				return conti->first;
+		for (int i = 0; i < std::max(1, spotCount/4); ++i) {
+			size_t index = Random::ChooseIndex(spots);
+			if (spots[index].container && spots[index].container->empty() && !spots[index].reserved) 
+				return SpotPosition(index);
 		}
 		//If that fails still iterate through each position because a free position _should_ exist
-		for (int ix = a.X(); ix <= b.X(); ++ix) {
-			for (int iy = a.Y(); iy <= b.Y(); ++iy) {
-				Coordinate p(ix,iy);
-				if (map->GetConstruction(p) == uid) {
-					if (containers[p]->empty() && !reserved[p])
-						return p;
-				}
-			}
+		for (size_t index = 0; index < spots.size(); ++index) {
+			if (spots[index].container && spots[index].container->empty() && !spots[index].reserved)
+				return SpotPosition(index);
 		}
 	}
 
@@ -461,7 +496,7 @@ Coordinate Stockpile::FreePosition() {
 }
 
 void Stockpile::ReserveSpot(Coordinate pos, bool val, ItemType type) { 
-	reserved[pos] = val;
+	if (Spot* spot = GetSpot(pos)) spot->reserved = val;
 
 	/*Update amounts based on reserves if limits exist for the item
 	This is necessary to stop too many stockpilation jobs being queued up
@@ -484,7 +519,8 @@ void Stockpile::ReserveSpot(Coordinate pos, bool val, ItemType type) {
 }
 
 boost::weak_ptr<Container> Stockpile::Storage(Coordinate pos) {
-	return containers[pos];
+	Spot* spot = GetSpot(pos);
+	return spot ? spot->container : boost::shared_ptr<Container>();
 }
 
 void Stockpile::SwitchAllowed(ItemCategory cat, bool childrenAlso, bool countParentsOnly) {
@@ -524,8 +560,8 @@ void Stockpile::SetAllAllowed(bool nallowed) {
 
 void Stockpile::ItemAdded(boost::weak_ptr<Item> witem) {
 	if (boost::shared_ptr<Item> item = witem.lock()) {
-		std::set<ItemCategory> categories = Item::Presets[item->Type()].categories;
-		for(std::set<ItemCategory>::iterator it = categories.begin(); it != categories.end(); it++) {
+		const std::set<ItemCategory>& categories = Item::Presets[item->Type()].categories;
+		for(std::set<ItemCategory>::const_iterator it = categories.begin(); it != categories.end(); it++) {
 			amount[*it] = amount[*it] + 1;
 		}
 
@@ -585,8 +621,8 @@ void Stockpile::ItemRemoved(boost::weak_ptr<Item> witem) {
 		if (Item::Presets[item->Type()].fitsin >= 0)
 			--demand[Item::Presets[item->Type()].fitsin];
 
-		std::set<ItemCategory> categories = Item::Presets[item->Type()].categories;
-		for(std::set<ItemCategory>::iterator it = categories.begin(); it != categories.end(); it++) {
+		const std::set<ItemCategory>& categories = Item::Presets[item->Type()].categories;
+		for(std::set<ItemCategory>::const_iterator it = categories.begin(); it != categories.end(); it++) {
 			amount[*it] = amount[*it] - 1;
 		}
 	}
@@ -599,9 +635,10 @@ struct AmountCompare {
 };
 
 void Stockpile::GetTooltip(int x, int y, Tooltip *tooltip) {
-	if (containers.find(Coordinate(x,y)) != containers.end()) {
-		if(!containers[Coordinate(x, y)]->empty()) {
-			boost::weak_ptr<Item> item = containers[Coordinate(x, y)]->GetFirstItem();
+	Spot* spot = GetSpot(Coordinate(x, y));
+	if (spot && spot->container) {
+		if(!spot->container->empty()) {
+			boost::weak_ptr<Item> item = spot->container->GetFirstItem();
 			if(item.lock()) {
 				item.lock()->GetTooltip(x, y, tooltip);
 			}
@@ -646,9 +683,8 @@ Coordinate Stockpile::Center() {
 }
 
 void Stockpile::TranslateInternalContainerListeners() {
-	for (std::map<Coordinate, boost::shared_ptr<Container> >::iterator it = containers.begin();
-		it != containers.end(); ++it) {
-			it->second->TranslateContainerListeners();
+	for (std::vector<Spot>::iterator spoti = spots.begin(); spoti != spots.end(); ++spoti) {
+		if (spoti->container) spoti->container->TranslateContainerListeners();
 	}
 }
 
@@ -677,9 +713,10 @@ void Stockpile::Erase(const Coordinate& p) {
 	if (map->GetConstruction(p) == uid) {
 		map->SetConstruction(p, -1);
 		map->SetBuildable(p, true);
-		reserved.erase(p);
-		containers.erase(p);
-		colors.erase(p);
+		if (Spot* spot = GetSpot(p)) {
+			if (spot->container) --spotCount;
+			*spot = Spot();
+		}
 	}
 	
 }
@@ -696,7 +733,7 @@ void Stockpile::Dismantle(const Coordinate& p) {
 			}
 		} else {
 			Stockpile::Erase(p);
-			if (containers.empty()) Game::Inst()->RemoveConstruction(boost::static_pointer_cast<Construction>(shared_from_this()));
+			if (spotCount == 0) Game::Inst()->RemoveConstruction(boost::static_pointer_cast<Construction>(shared_from_this()));
 		}
 	}
 }
@@ -714,14 +751,13 @@ int Stockpile::GetAmount(ItemCategory category) {
 
 //Checks if new containers exist to hold items not in containers
 void Stockpile::Reorganize() {
-	for (std::map<Coordinate, boost::shared_ptr<Container> >::const_iterator space = containers.begin();
-		space != containers.end(); ++space) {
-			if (!space->second->empty()) {
-				if (boost::shared_ptr<Item> item = space->second->GetFirstItem().lock()) {
+	for (std::vector<Spot>::const_iterator space = spots.begin(); space != spots.end(); ++space) {
+			if (space->container && !space->container->empty()) {
+				if (boost::shared_ptr<Item> item = space->container->GetFirstItem().lock()) {
 					if (Item::Presets[item->Type()].fitsin >= 0) {
 						if (boost::shared_ptr<Item> container = 
 							FindItemByCategory(Item::Presets[item->Type()].fitsin, NOTFULL).lock()) {
-								boost::shared_ptr<Job> reorgJob(new Job("Reorganize stockpile", LOW));
+								boost::shared_ptr<Job> reorgJob(Job::Create("Reorganize stockpile", LOW));
 								reorgJob->Attempts(1);
 								reorgJob->ReserveSpace(boost::static_pointer_cast<Container>(container));
 								reorgJob->tasks.push_back(Task(MOVE, item->Position()));
@@ -744,15 +780,25 @@ void Stockpile::save(OutputArchive& ar, const unsigned int version) const {
 	ar & capacity;
 	ar & amount;
 	ar & allowed;
+	//Saved as maps keyed by position, as before the spots were kept in a grid
+	std::map<Coordinate, bool> reserved;
+	std::map<Coordinate, boost::shared_ptr<Container> > containers;
+	for (size_t i = 0; i < spots.size(); ++i) {
+		if (spots[i].container) {
+			reserved.insert(std::make_pair(SpotPosition(i), spots[i].reserved));
+			containers.insert(std::make_pair(SpotPosition(i), spots[i].container));
+		}
+	}
 	ar & reserved;
 	ar & containers;
-	int colorCount = colors.size();
+	int colorCount = static_cast<int>(containers.size());
 	ar & colorCount;
-	for (std::map<Coordinate, TCODColor>::const_iterator it = colors.begin(); it != colors.end(); ++it) {
+	for (std::map<Coordinate, boost::shared_ptr<Container> >::const_iterator it = containers.begin(); it != containers.end(); ++it) {
+		const TCODColor& spotColor = spots[(it->first.Y() - a.Y()) * (b.X() - a.X() + 1) + (it->first.X() - a.X())].color;
 		ar & it->first;
-		ar & it->second.r;
-		ar & it->second.g;
-		ar & it->second.b;
+		ar & spotColor.r;
+		ar & spotColor.g;
+		ar & spotColor.b;
 	}
 	ar & limits;
 	ar & demand;
@@ -767,8 +813,21 @@ void Stockpile::load(InputArchive& ar, const unsigned int version) {
 	ar & capacity;
 	ar & amount;
 	ar & allowed;
+	std::map<Coordinate, bool> reserved;
+	std::map<Coordinate, boost::shared_ptr<Container> > containers;
 	ar & reserved;
 	ar & containers;
+
+	//Convert the per-position maps into the grid
+	spots.assign((b.X() - a.X() + 1) * (b.Y() - a.Y() + 1), Spot());
+	spotCount = 0;
+	for (std::map<Coordinate, boost::shared_ptr<Container> >::iterator it = containers.begin(); it != containers.end(); ++it) {
+		if (GetSpot(it->first) && it->second) {
+			AddSpot(it->first, it->second);
+			GetSpot(it->first)->reserved = reserved[it->first];
+		}
+	}
+
 	int colorCount;
 	ar & colorCount;
 	for (int i = 0; i < colorCount; ++i) {
@@ -778,7 +837,7 @@ void Stockpile::load(InputArchive& ar, const unsigned int version) {
 		ar & r;
 		ar & g;
 		ar & b;
-		colors.insert(std::pair<Coordinate, TCODColor>(pos, TCODColor(r, g, b)));
+		if (Spot* spot = GetSpot(pos)) spot->color = TCODColor(r, g, b);
 	}
 	ar & limits;
 	if (version >= 1) {
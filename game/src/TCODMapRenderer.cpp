@@ -140,7 +140,7 @@ void TCODMapRenderer::DrawMap(Map* map, float focusX, float focusY, int viewport
 
 
 	InternalDrawMapItems("NPCs",                  Game::Inst()->npcList, upleft, &minimap);
-	for (std::list<boost::weak_ptr<FireNode> >::iterator firei = Game::Inst()->fireList.begin(); firei != Game::Inst()->fireList.end(); ++firei) {
+	for (std::vector<boost::weak_ptr<FireNode> >::iterator firei = Game::Inst()->fireList.begin(); firei != Game::Inst()->fireList.end(); ++firei) {
 		if (firei->lock()) firei->lock()->Draw(upleft, &minimap);
 	}
 	for (std::list<boost::shared_ptr<Spell> >::iterator spelli = Game::Inst()->spellList.begin(); spelli != Game::Inst()->spellList.end(); ++spelli) {
@@ -43,6 +43,8 @@ along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
 #include "Trap.hpp"
 #include "Color.hpp"
 
+TileNodes Tile::loadedNodes;
+
 Tile::Tile(TileType newType, int newCost) :
 	vis(true),
 	walkable(true),
@@ -51,7 +53,6 @@ Tile::Tile(TileType newType, int newCost) :
 	construction(-1),
 	low(false),
 	blocksWater(false),
-	water(boost::shared_ptr<WaterNode>()),
 	graphic('.'),
 	foreColor(GCampColor::white),
 	originalForeColor(GCampColor::white),
@@ -59,9 +60,6 @@ Tile::Tile(TileType newType, int newCost) :
 	natureObject(-1),
 	npcList(std::set<int>()),
 	itemList(std::set<int>()),
-	filth(boost::shared_ptr<FilthNode>()),
-	blood(boost::shared_ptr<BloodNode>()),
-	fire(boost::shared_ptr<FireNode>()),
 	marked(false),
 	walkedOver(0),
 	corruption(0),
@@ -226,9 +224,6 @@ void Tile::MoveTo(int uid) {
 void Tile::SetConstruction(int uid) { construction = uid; }
 int Tile::GetConstruction() const { return construction; }
 
-boost::weak_ptr<WaterNode> Tile::GetWater() const {return boost::weak_ptr<WaterNode>(water);}
-void Tile::SetWater(boost::shared_ptr<WaterNode> value) {water = value;}
-
 bool Tile::IsLow() const {return low;}
 void Tile::SetLow(bool value) {low = value;}
 
@@ -236,7 +231,7 @@ int Tile::GetGraphic() const { return graphic; }
 TCODColor Tile::GetForeColor() const { 
 	return foreColor;
 }
-TCODColor Tile::GetBackColor() const {
+TCODColor Tile::GetBackColor(BloodNode* blood) const {
 	if (!blood && !marked) return backColor;
 	TCODColor result = backColor;
 	if (blood)
@@ -249,15 +244,6 @@ TCODColor Tile::GetBackColor() const {
 void Tile::SetNatureObject(int val) { natureObject = val; }
 int Tile::GetNatureObject() const { return natureObject; }
 
-boost::weak_ptr<FilthNode> Tile::GetFilth() const {return boost::weak_ptr<FilthNode>(filth);}
-void Tile::SetFilth(boost::shared_ptr<FilthNode> value) {filth = value;}
-
-boost::weak_ptr<BloodNode> Tile::GetBlood() const {return boost::weak_ptr<BloodNode>(blood);}
-void Tile::SetBlood(boost::shared_ptr<BloodNode> value) {blood = value;}
-
-boost::weak_ptr<FireNode> Tile::GetFire() const {return boost::weak_ptr<FireNode>(fire);}
-void Tile::SetFire(boost::shared_ptr<FireNode> value) { fire = value; }
-
 void Tile::Mark() { marked = true; }
 void Tile::Unmark() { marked = false; }
 
@@ -322,7 +308,9 @@ void Tile::Burn(int magnitude) {
 	}
 }
 
+//Map has saved tiles as columns since its version 3, this is only the counterpart of load()
 void Tile::save(OutputArchive& ar, const unsigned int version) const {
+	TileNodes nodes;
 	ar & type;
 	ar & vis;
 	ar & walkable;
@@ -331,7 +319,7 @@ void Tile::save(OutputArchive& ar, const unsigned int version) const {
 	ar & construction;
 	ar & low;
 	ar & blocksWater;
-	ar & water;
+	ar & nodes.water;
 	ar & graphic;
 	ar & foreColor.r;
 	ar & foreColor.g;
@@ -345,14 +333,14 @@ void Tile::save(OutputArchive& ar, const unsigned int version) const {
 	ar & natureObject;
 	ar & npcList;
 	ar & itemList;
-	ar & filth;
-	ar & blood;
+	ar & nodes.filth;
+	ar & nodes.blood;
 	ar & marked;
 	ar & walkedOver;
 	ar & corruption;
 	ar & territory;
 	ar & burnt;
-	ar & fire;
+	ar & nodes.fire;
 	ar & flow;
 }
 
@@ -365,7 +353,7 @@ void Tile::load(InputArchive& ar, const unsigned int version) {
 	ar & construction;
 	ar & low;
 	ar & blocksWater;
-	ar & water;
+	ar & loadedNodes.water;
 	ar & graphic;
 	ar & foreColor.r;
 	ar & foreColor.g;
@@ -379,14 +367,14 @@ void Tile::load(InputArchive& ar, const unsigned int version) {
 	ar & natureObject;
 	ar & npcList;
 	ar & itemList;
-	ar & filth;
-	ar & blood;
+	ar & loadedNodes.filth;
+	ar & loadedNodes.blood;
 	ar & marked;
 	ar & walkedOver;
 	ar & corruption;
 	ar & territory;
 	ar & burnt;
-	ar & fire;
+	ar & loadedNodes.fire;
 	ar & flow;
 }
 
@@ -412,15 +400,16 @@ CacheTile& CacheTile::operator=(const Tile& tile) {
 		moveSpeedModifier = 0;
 	}
 
-	if (tile.water) waterDepth = tile.water->Depth();
-	else waterDepth = 0;
-
 	npcCount = tile.npcList.size();
-	fire = bool(tile.fire);
 
 	return *this;
 }
 
+void CacheTile::SetNodes(const TileNodes* nodes) {
+	waterDepth = (nodes && nodes->water) ? nodes->water->Depth() : 0;
+	fire = nodes && nodes->fire;
+}
+
 int CacheTile::GetMoveCost(void* ptr) const {
 	int cost = GetMoveCost();
 
@@ -67,7 +67,7 @@ int Trap::Use() {
 void Trap::SpawnRepairJob() {
 	Construction::SpawnRepairJob();
 	if (!ready && !reloadJob.lock()) { //Spawn reload job if one doesn't already exist
-		boost::shared_ptr<Job> reload(new Job("Reset "+name));
+		boost::shared_ptr<Job> reload(Job::Create("Reset "+name));
 		reload->tasks.push_back(Task(MOVEADJACENT, Position(), shared_from_this()));
 		reload->tasks.push_back(Task(USE, Position(), shared_from_this()));
 		reload->DisregardTerritory();
@@ -24,6 +24,7 @@ along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
 #include <boost/lambda/lambda.hpp>
 
 #include "Random.hpp"
+#include "Replay.hpp"
 #include "UI.hpp"
 #include "Announce.hpp"
 #include "Game.hpp"
@@ -92,6 +93,7 @@ void UI::HandleKeyboard() {
 
 	//TODO: This isn't pretty, but it works.
 	key = TCODConsole::checkForKeypress(TCOD_KEY_PRESSED);
+	Replay::Key(key);
 	if (key.vk != TCODK_NONE && (!currentMenu || !(currentMenu->Update(-1, -1, false, key) & KEYRESPOND))) {
 		if (!textMode) {
 			if (key.c == keyMap["Exit"]) {
@@ -256,6 +258,7 @@ void UI::HandleMouse() {
 	if (TCODConsole::isWindowClosed()) Game::Inst()->Exit();
 
 	TCOD_mouse_t newMouseInput = TCODMouse::getStatus();
+	Replay::Mouse(newMouseInput);
 	if (newMouseInput.x != oldMouseInput.x || newMouseInput.y != oldMouseInput.y) {
 		mouseInput = newMouseInput;
 		drawCursor = false;
@@ -917,7 +920,7 @@ void UI::ChooseCreateItem() {
 	Menu *ItemChoiceMenu = new Menu(std::vector<MenuChoice>(), "Item");
 	ItemChoiceMenu->AddChoice(MenuChoice("None", boost::lambda::var(item) = -1));
 	for (unsigned int i = 0; i < Item::Presets.size(); ++i) {
-		if (Item::Presets[i].categories.find(category) != Item::Presets[i].categories.end())
+		if (Item::Presets[i].IsCategory(category))
 			ItemChoiceMenu->AddChoice(MenuChoice(Item::Presets[i].name, boost::lambda::var(item) = i));
 	}
 	ItemChoiceMenu->ShowModal();
@@ -42,6 +42,6 @@ NPCDialog::NPCDialog(): UIContainer(std::vector<Drawable*>(), 0, 0, Game::Inst()
 void NPCDialog::DrawNPC(std::pair<int, boost::shared_ptr<NPC> > npci, int i, int x, int y, int width, bool selected, TCODConsole* console) {
 	console->print(x, y, "NPC: %d", npci.second->Uid());
 	console->print(x+11, y, "%s: %s",
-				   npci.second->currentJob().lock() ? npci.second->currentJob().lock()->name.c_str() : "No job",
+				   npci.second->currentJob().lock() ? npci.second->currentJob().lock()->Name().c_str() : "No job",
 				   npci.second->currentTask() ? Job::ActionToString(npci.second->currentTask()->action).c_str() : "No task");
 }
@@ -36,7 +36,9 @@ WaterNode::WaterNode(const Coordinate& pos, int vdepth, int time) :
 	inertCounter(0), inert(false),
 	timeFromRiverBed(time),
 	filth(0),
-	coastal(false)
+	coastal(false),
+	drinkable(false),
+	updateScheduled(false)
 {
 	UpdateGraphic();
 }
@@ -64,11 +66,11 @@ void WaterNode::Y(int y) {
 }
 
 //Returns true if this WaterNode should be destroyed
-bool WaterNode::Update() {
+bool WaterNode::Update(int steps) {
 	double divided;
 
 	if (inert) {
-		++inertCounter;
+		inertCounter += steps;
 	}
 
 	if (!inert || inertCounter > (UPDATES_PER_SECOND*1)) {
@@ -82,8 +84,12 @@ bool WaterNode::Update() {
 
 		if (depth > 1) {
 
-			if (timeFromRiverBed == 0 && Random::Generate(100) == 0) depth -= 1; //Evaporation
-			if (timeFromRiverBed > 0 && depth < RIVERDEPTH) depth += 10; //Water rushing from the river
+			if (timeFromRiverBed == 0) { //Evaporation
+				for (int i = 0; i < steps && depth > 1; ++i) {
+					if (Random::Generate(100) == 0) depth -= 1;
+				}
+			}
+			if (timeFromRiverBed > 0 && depth < RIVERDEPTH) depth += 10 * steps; //Water rushing from the river
 
 			std::vector<boost::weak_ptr<WaterNode> > waterList;
 			std::vector<Coordinate> coordList;
@@ -135,7 +141,7 @@ bool WaterNode::Update() {
 				}
 			}
 
-			if (timeFromRiverBed > 0) --timeFromRiverBed;
+			if (timeFromRiverBed > 0) timeFromRiverBed = std::max(0, timeFromRiverBed - steps);
 			divided = ((double)depthSum/waterList.size());
 
 			boost::shared_ptr<Item> item;
@@ -162,6 +168,7 @@ bool WaterNode::Update() {
 					water->depth = (int)divided;
 					water->timeFromRiverBed = timeFromRiverBed;
 					water->UpdateGraphic();
+					water->UpdateDrinkable();
 
 					//So much filth it'll go anywhere
 					if (filth > 10 && Random::Generate(3) == 0) { filth -= 5; water->filth += 5; }
@@ -290,15 +297,18 @@ bool WaterNode::Update() {
 			if (onlyLowTiles) {
 				depth = 1; //All of the water has flown to a low tile
 			}
+			UpdateDrinkable();
 
 		} else {
 			int soakage = 500;
 			TileType type = Map::Inst()->GetType(pos);
 			if (type == TILEGRASS) soakage = 10;
 			else if (type == TILEBOG) soakage = 0;
-			if (Random::Generate(soakage) == 0) {
-				depth = 0;
-				return true; //Water has evaporated
+			for (int i = 0; i < steps; ++i) {
+				if (Random::Generate(soakage) == 0) {
+					depth = 0;
+					return true; //Water has evaporated
+				}
 			}
 		}
 		return false;
@@ -314,6 +324,7 @@ void WaterNode::Depth(int newDepth) {
 	if (depth <= 20 && newDepth <= 20 && depth != newDepth) Map::Inst()->TileChanged(pos);
 	depth = newDepth;
 	UpdateGraphic();
+	UpdateDrinkable();
 }
 
 void WaterNode::UpdateGraphic() {
@@ -355,6 +366,18 @@ TCODColor WaterNode::GetColor()
 }
 
 bool WaterNode::IsCoastal() { return coastal; }
+bool WaterNode::IsDrinkable() const { return drinkable; }
+
+bool WaterNode::UpdateScheduled() const { return updateScheduled; }
+void WaterNode::UpdateScheduled(bool value) { updateScheduled = value; }
+
+void WaterNode::UpdateDrinkable() {
+	bool nowDrinkable = coastal && depth > DRINKABLE_WATER_DEPTH;
+	if (nowDrinkable != drinkable) {
+		drinkable = nowDrinkable;
+		Map::Inst()->SetDrinkable(pos, this, drinkable);
+	}
+}
 
 void WaterNode::save(OutputArchive& ar, const unsigned int version) const {
 	const int x = pos.X();
@@ -15,7 +15,11 @@ You should have received a copy of the GNU General Public License
 along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
 #include "stdafx.hpp"
 
+#include <cmath>
+#include <climits>
+
 #include "Weather.hpp"
+#include "MapChunk.hpp"
 #include "Random.hpp"
 #include "Game.hpp"
 #include "GCamp.hpp"
@@ -24,7 +28,13 @@ Weather::Weather(Map* vmap) : map(vmap), windDirection(NORTH),
 	prevailingWindDirection(NORTH), currentWeather(NORMALWEATHER), 
 	tileChange(false),
 	changeAll(false), tileChangeRate(0), changePosition(0),
-	currentSeason(-1) {
+	currentTemperature(0), currentSeason(-1),
+	phase(0), exposure(0.0), previousExposure(0.0) {
+}
+
+namespace {
+	//Enough to change practically every tile, for the seasons that sweep the whole map
+	const double SweepExposure = 20.0;
 }
 
 Direction Weather::GetWindDirection() { return windDirection; }
@@ -75,13 +85,17 @@ std::string Weather::GetWindAbbreviation() {
 }
 
 void Weather::Update() {
+	Random::StreamScope weatherStream(Random::WeatherStream);
 	if (Random::Generate(MONTH_LENGTH) == 0) ShiftWind();
 	if (Random::Generate(MONTH_LENGTH) == 0) {
 		if (Random::Generate(2) < 2) {
 			currentWeather = NORMALWEATHER;
 		} else currentWeather = RAIN;
 	}
-	if (!tileChange && currentTemperature >= 0 && currentWeather == RAIN) Game::Inst()->CreateWater(Coordinate(Random::Generate(map->Width()-1),Random::Generate(map->Height()-1)),1);
+	if (!tileChange && currentTemperature >= 0 && currentWeather == RAIN) {
+		Coordinate drop(Random::Generate(map->Width()-1), Random::Generate(map->Height()-1));
+		if (map->IsActive(drop)) Game::Inst()->CreateWater(drop, 1); //It would soak in unseen anyway
+	}
 
 	if (Game::Inst()->CurrentSeason() != static_cast<Season>(currentSeason)) {
 		currentSeason = static_cast<int>(Game::Inst()->CurrentSeason());
@@ -89,46 +103,23 @@ void Weather::Update() {
 	}
 
 	if (tileChange) {
-		TileType tile = currentTemperature > 0 ? TILEGRASS : TILESNOW;
+		std::vector<Coordinate> changes;
 		if (!changeAll) {
+			exposure += static_cast<double>(tileChangeRate) / (map->Width() * map->Height());
 			for (int i = 0; i < tileChangeRate; ++i) {
 				Coordinate r = Random::ChooseInExtent(map->Extent());
-				if (map->GetType(r) == TILEGRASS || map->GetType(r) == TILESNOW) {
-					map->ChangeType(r, static_cast<TileType>(tile), map->heightMap->getValue(r.X(), r.Y()));
-				}
-				if (currentTemperature < 0) {
-					if (map->GetWater(r).lock() && map->GetWater(r).lock()->IsCoastal()) {
-						Game::Inst()->CreateNatureObject(Coordinate(r), "Ice");
-					}
-				} else if (currentTemperature > 0) {
-					if (map->GetNatureObject(r) >= 0) {
-						if (Game::Inst()->natureList[map->GetNatureObject(r)]->IsIce()) {
-							Game::Inst()->RemoveNatureObject(Game::Inst()->natureList[map->GetNatureObject(r)]);
-						}
-					}
-				}
+				if (map->IsActive(r)) changes.push_back(r);
 			}
 			if (tileChangeRate < 300 && Random::Generate(200) == 0) ++tileChangeRate;
 		} else {
 			for (int i = 0; i < tileChangeRate; ++i) {
-				for (int x = 0; x < 500; ++x) {
-					Coordinate p(x, changePosition);
-					if (map->GetType(p) == TILEGRASS || map->GetType(p) == TILESNOW) {
-						map->ChangeType(p, static_cast<TileType>(tile), map->heightMap->getValue(p.X(),p.Y()));
+				//Row spans of the active chunks
+				for (int x = 0; x < map->Width(); x += MapChunk::Size) {
+					Coordinate begin(x, changePosition);
+					if (!map->IsActive(begin)) continue;
+					for (int spanX = x; spanX < std::min(x + MapChunk::Size, map->Width()); ++spanX) {
+						changes.push_back(Coordinate(spanX, changePosition));
 					}
-
-					if (currentTemperature < 0) {
-						if (map->GetWater(p).lock() && map->GetWater(p).lock()->IsCoastal()) {
-							Game::Inst()->CreateNatureObject(p, "Ice");
-						}
-					} else if (currentTemperature > 0) {
-						if (map->GetNatureObject(p) >= 0) {
-							if (Game::Inst()->natureList[map->GetNatureObject(p)]->IsIce()) {
-								Game::Inst()->RemoveNatureObject(Game::Inst()->natureList[map->GetNatureObject(p)]);
-							}
-						}
-					}
-
 				}
 				++changePosition;
 				if (changePosition >= map->Height()) {
@@ -138,7 +129,73 @@ void Weather::Update() {
 				}
 			}
 		}
+		ChangeTiles(changes, currentTemperature);
+	}
+}
+
+/* Changes grass and snow to the season's tile type and freezes or melts coastal water. The tiles
+   are sorted out first so that the map is retyped, and Ice created, in one go per kind of change */
+void Weather::ChangeTiles(const std::vector<Coordinate>& positions, int temperature) {
+	TileType type = temperature > 0 ? TILEGRASS : TILESNOW;
+	std::vector<Coordinate> retyped, frozen;
+	std::vector<int> melted;
+	for (std::vector<Coordinate>::const_iterator p = positions.begin(); p != positions.end(); ++p) {
+		TileType current = map->GetType(*p);
+		if ((current == TILEGRASS || current == TILESNOW) && current != type) retyped.push_back(*p);
+
+		if (temperature < 0) {
+			if (boost::shared_ptr<WaterNode> water = map->GetWater(*p).lock()) {
+				if (water->IsCoastal() && map->GetNatureObject(*p) < 0) frozen.push_back(*p);
+			}
+		} else if (temperature > 0) {
+			int natureObject = map->GetNatureObject(*p);
+			if (natureObject >= 0) {
+				std::map<int, boost::shared_ptr<NatureObject> >::iterator nature = Game::Inst()->natureList.find(natureObject);
+				if (nature != Game::Inst()->natureList.end() && nature->second->IsIce()) melted.push_back(natureObject);
+			}
+		}
+	}
+
+	if (!retyped.empty()) map->ChangeTypes(retyped, type, Random::Generate(1, INT_MAX));
+	if (!frozen.empty()) Game::Inst()->CreateNatureObjects(frozen, "Ice");
+	for (std::vector<int>::iterator uid = melted.begin(); uid != melted.end(); ++uid) {
+		std::map<int, boost::shared_ptr<NatureObject> >::iterator nature = Game::Inst()->natureList.find(*uid);
+		if (nature != Game::Inst()->natureList.end()) Game::Inst()->RemoveNatureObject(nature->second);
+	}
+}
+
+//Each tile of the chunk would have been picked a Poisson distributed amount of times, with 'missed' as the mean
+void Weather::CatchUpTiles(const Coordinate& origin, double missed, int temperature) {
+	if (missed <= 0.0) return;
+	double probability = 1.0 - std::exp(-missed);
+	Coordinate end = map->Shrink(origin + (MapChunk::Size - 1));
+	std::vector<Coordinate> changes;
+	for (int y = origin.Y(); y <= end.Y(); ++y) {
+		for (int x = origin.X(); x <= end.X(); ++x) {
+			if (Random::Generate() < probability) changes.push_back(Coordinate(x, y));
+		}
 	}
+	ChangeTiles(changes, temperature);
+}
+
+void Weather::CatchUp(const Coordinate& origin, MapChunk& chunk) {
+	Random::StreamScope weatherStream(Random::WeatherStream);
+	if (chunk.weatherPhase != phase) {
+		//Anything older than the previous phase was undone by it
+		double missed = previousExposure - (chunk.weatherPhase == phase - 1 ? chunk.weatherExposure : 0.0);
+		CatchUpTiles(origin, missed, -currentTemperature);
+		chunk.weatherExposure = 0.0;
+	}
+	CatchUpTiles(origin, exposure - chunk.weatherExposure, currentTemperature);
+	chunk.weatherPhase = phase;
+	chunk.weatherExposure = exposure;
+}
+
+void Weather::Synchronize(const Coordinate& origin, MapChunk& chunk) {
+	chunk.weatherPhase = phase;
+	chunk.weatherExposure = exposure;
+	//The sweep hasn't got this far yet, so the chunk hasn't had it
+	if (tileChange && changeAll && origin.Y() + MapChunk::Size > changePosition) chunk.weatherExposure -= SweepExposure;
 }
 
 void Weather::ChangeWeather(WeatherType newWeather) {
@@ -146,6 +203,7 @@ void Weather::ChangeWeather(WeatherType newWeather) {
 }
 
 void Weather::SeasonChange() {
+	int previousTemperature = currentTemperature;
 	tileChange = false;
 	changeAll = false;
 
@@ -203,6 +261,13 @@ void Weather::SeasonChange() {
 		currentTemperature = 1;
 		break;
 	}
+
+	if (tileChange && (currentTemperature > 0) != (previousTemperature > 0)) {
+		previousExposure = exposure;
+		exposure = 0.0;
+		++phase;
+	}
+	if (changeAll) exposure += SweepExposure;
 }
 
 void Weather::ApplySeasonalEffects() {
@@ -219,6 +284,9 @@ void Weather::save(OutputArchive& ar, const unsigned int version) const {
 	ar & tileChangeRate;
 	ar & changePosition;
 	ar & currentTemperature;
+	ar & phase;
+	ar & exposure;
+	ar & previousExposure;
 }
 
 void Weather::load(InputArchive& ar, const unsigned int version) {
@@ -231,4 +299,9 @@ void Weather::load(InputArchive& ar, const unsigned int version) {
 	ar & tileChangeRate;
 	ar & changePosition;
 	ar & currentTemperature;
+	if (version >= 1) {
+		ar & phase;
+		ar & exposure;
+		ar & previousExposure;
+	}
 }
@@ -84,6 +84,8 @@ namespace Config {
 			("tutorial",     "1")
 			("riverWidth",   "30")
 			("riverDepth",   "5")
+			("mapWidth",     "500")
+			("mapHeight",    "500")
 			("halfRendering","0")
 			("compressSaves","0")
 			("translucentUI","0")
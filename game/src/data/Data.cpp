@@ -272,6 +272,29 @@ namespace Data {
 		return result;
 	}
 	
+	/**
+		Saves current game to a given file without blocking the game. The game is
+		serialised right away, compressing and writing the file happens in the
+		background, and the outcome is announced once it's done.
+		
+		\see Game::SaveGameInBackground
+		
+		\param[in] save Save filename.
+		\returns        Boolean indicating whether the save was started.
+	*/
+	bool AutoSave(const std::string& save) {
+		std::string file = SanitizeFilename(save);
+		
+		if (file.size() == 0) {
+			file = "_";
+		}
+		
+		file = (Paths::Get(Paths::Saves) / file).string() + ".sav";
+		
+		LOG_FUNC("Autosaving game to " << file, "AutoSave");
+		return Game::Inst()->SaveGameInBackground(file);
+	}
+	
 	/**
 		Executes the user's configuration file.
 	*/
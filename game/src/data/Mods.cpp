@@ -16,6 +16,8 @@ along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
 #include "stdafx.hpp"
 
 #include <string>
+#include <vector>
+#include <boost/next_prior.hpp>
 #include <boost/assert.hpp>
 #include <libtcod.hpp>
 #include <boost/filesystem.hpp>
@@ -27,10 +29,12 @@ namespace fs = boost::filesystem;
 #include "Logger.hpp"
 #include "data/Mods.hpp"
 #include "data/Paths.hpp"
+#include "data/PresetCache.hpp"
 #include "Construction.hpp"
 #include "Item.hpp"
 #include "NatureObject.hpp"
 #include "NPC.hpp"
+#include "Spell.hpp"
 #include "scripting/Engine.hpp"
 #include "Faction.hpp"
 
@@ -78,6 +82,23 @@ namespace {
 		TCODNamegen::parse(fn.c_str());
 	}
 	
+	/**
+		Data files that fill in the preset tables, in the order they are loaded.
+		Everything they load can come from PresetCache instead.
+	*/
+	const struct {
+		const char *filename;
+		void (*loadFunc)(std::string);
+	} presetFiles[] = {
+		{ "spells",        Spell::LoadPresets },
+		{ "items",         Item::LoadPresets },
+		{ "constructions", Construction::LoadPresets },
+		{ "wildplants",    NatureObject::LoadPresets },
+		{ "creatures",     NPC::LoadPresets },
+		{ "factions",      Faction::LoadPresets }
+	};
+	const size_t presetFileCount = sizeof(presetFiles) / sizeof(presetFiles[0]);
+	
 	/**
 		Loads given data file with given function.
 		
@@ -127,10 +148,11 @@ namespace {
 		Loads given mod and inserts it's metadata into loadedMods.
 		NB: Currently there is no way to unload a mod.
 		
-		\param[in] dir      Mod's directory.
-		\param[in] required Passed down to \ref LoadFile for every data file of the mod.
+		\param[in] dir         Mod's directory.
+		\param[in] required    Passed down to \ref LoadFile for every data file of the mod.
+		\param[in] loadPresets If false, the preset data files are skipped (they came from the cache).
 	*/
-	void LoadMod(const fs::path& dir, bool required = false) {
+	void LoadMod(const fs::path& dir, bool required = false, bool loadPresets = true) {
 		std::string mod = dir.filename().string();
 		
 		LOG_FUNC("Trying to load mod '" << mod << "' from " << dir.string(), "LoadMod");
@@ -144,13 +166,10 @@ namespace {
 		}
 		
 		try {
-			LoadFile("spells",        dir, Spell::LoadPresets, required);
-			LoadFile("items",         dir, Item::LoadPresets, required);
-			LoadFile("constructions", dir, Construction::LoadPresets, required);
-			LoadFile("wildplants",    dir, NatureObject::LoadPresets, required);
-			LoadFile("names",         dir, LoadNames, required);
-			LoadFile("creatures",     dir, NPC::LoadPresets, required);
-			LoadFile("factions",      dir, Faction::LoadPresets, required);
+			LoadFile("names", dir, LoadNames, required);
+			for (size_t i = 0; loadPresets && i < presetFileCount; ++i) {
+				LoadFile(presetFiles[i].filename, dir, presetFiles[i].loadFunc, required);
+			}
 		} catch (const std::runtime_error& e) {
 			LOG_FUNC("Failed to load mod due to std::runtime_error: " << e.what(), "LoadMod");
 			if (required) Game::Inst()->ErrorScreen();
@@ -195,22 +214,54 @@ namespace Mods {
 	}
 	
 	/**
-		Loads global mod and then tries to load user mods.
+		Lists the preset data files of given mods, in the order they would be loaded.
+		
+		\param[in] mods Mod directories in load order.
+		\returns        Paths to the data files that exist.
+	*/
+	std::vector<fs::path> PresetFiles(const std::vector<fs::path>& mods) {
+		std::vector<fs::path> files;
+		for (std::vector<fs::path>::const_iterator dir = mods.begin(); dir != mods.end(); ++dir) {
+			for (size_t i = 0; i < presetFileCount; ++i) {
+				fs::path file = *dir / (std::string(presetFiles[i].filename) + ".dat");
+				if (fs::exists(file)) files.push_back(file);
+			}
+		}
+		return files;
+	}
+	
+	/**
+		Loads global mod and then tries to load user mods. The preset tables come from
+		PresetCache when none of the data files changed since it was written.
 	*/
 	void Load() {
+		std::vector<fs::path> mods;
+		mods.push_back(Paths::Get(Paths::GlobalData) / "lib" / "gcamp_core");
+		for (fs::directory_iterator it(Paths::Get(Paths::Mods)), end; it != end; ++it) {
+			if (!fs::is_directory(it->status())) continue;
+			
+			mods.push_back(it->path());
+		}
+		
+		fs::path cacheFile = Paths::Get(Paths::Personal) / "presets.cache";
+		boost::uint64_t cacheKey = PresetCache::Key(PresetFiles(mods));
+		bool cached = PresetCache::Load(cacheFile, cacheKey);
+		
 		// load core data
-		LoadMod(Paths::Get(Paths::GlobalData) / "lib" / "gcamp_core", true);
+		LoadMod(mods.front(), true, !cached);
 		Globals::loadedMods.begin()->mod = "Goblins' Lot";
 		
 		// load user mods
-		for (fs::directory_iterator it(Paths::Get(Paths::Mods)), end; it != end; ++it) {
-			if (!fs::is_directory(it->status())) continue;
-			
-			LoadMod(it->path());
+		for (std::vector<fs::path>::iterator dir = boost::next(mods.begin()); dir != mods.end(); ++dir) {
+			LoadMod(*dir, false, !cached);
 		}
 		
-		// now resolve containers and products
-		Item::ResolveContainers();
-		Construction::ResolveProducts();
+		if (!cached) {
+			// now resolve containers and products
+			Item::ResolveContainers();
+			Construction::ResolveProducts();
+			
+			PresetCache::Save(cacheFile, cacheKey);
+		}
 	}
 }
@@ -0,0 +1,247 @@
+/* Copyright 2010-2011 Ilkka Halila
+This file is part of Goblins' Lot (former Goblin Camp)
+
+Goblin Camp is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Goblin Camp is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
+#include "stdafx.hpp"
+
+#include <fstream>
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <boost/version.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/stream.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+
+namespace fs = boost::filesystem;
+namespace io = boost::iostreams;
+
+#include "Logger.hpp"
+#include "Version.hpp"
+#include "data/PresetCache.hpp"
+#include "data/Serialization.hpp"
+#include "Construction.hpp"
+#include "Item.hpp"
+#include "NatureObject.hpp"
+#include "NPC.hpp"
+#include "Spell.hpp"
+#include "Faction.hpp"
+
+// The cache holds the preset tables as they are after every mod has been loaded, so that
+// startup doesn't have to run the data file parsers and resolve names when nothing changed.
+//
+// File format (native byte order, the cache never leaves the machine that wrote it):
+//   - magic constant (uint32_t), reversed fourcc 'GCPC'
+//   - cache format version (uint32_t), see cacheFormatConst
+//   - key (uint64_t), see PresetCache::Key
+//   - payload size (uint64_t)
+//   - payload hash (uint64_t, FNV-1a)
+//   - payload, a binary archive written by WriteTables
+//
+// Any mismatch means the cache is stale or damaged, and the caller falls back to the
+// text parsers.
+
+namespace {
+	const boost::uint32_t cacheMagicConst = 0x43504347;
+	// Increment whenever the cached tables or any preset's save/load change.
+	const boost::uint32_t cacheFormatConst = 1;
+
+	const boost::uint64_t fnvOffsetBasis = 14695981039346656037ULL;
+	const boost::uint64_t fnvPrime = 1099511628211ULL;
+
+	void Hash(boost::uint64_t& hash, const char* data, size_t size) {
+		for (size_t i = 0; i < size; ++i) {
+			hash ^= static_cast<unsigned char>(data[i]);
+			hash *= fnvPrime;
+		}
+	}
+
+	void Hash(boost::uint64_t& hash, const std::string& str) {
+		// Include the terminator, so that consecutive strings can't run into each other
+		Hash(hash, str.c_str(), str.size() + 1);
+	}
+
+	template <typename T>
+	void Hash(boost::uint64_t& hash, T value) {
+		Hash(hash, reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	// Order matters: this is the order the tables were filled in by Mods::Load
+	void WriteTables(OutputArchive& ar) {
+		Spell::SavePresetCache(ar);
+		Item::SavePresetCache(ar);
+		Construction::SavePresetCache(ar);
+		NatureObject::SavePresetCache(ar);
+		Faction::SavePresetCache(ar);
+		NPC::SavePresetCache(ar);
+	}
+
+	void ReadTables(InputArchive& ar) {
+		Spell::LoadPresetCache(ar);
+		Item::LoadPresetCache(ar);
+		Construction::LoadPresetCache(ar);
+		NatureObject::LoadPresetCache(ar);
+		Faction::LoadPresetCache(ar);
+		NPC::LoadPresetCache(ar);
+	}
+
+	void WritePayload(std::vector<char>& payload) {
+		io::filtering_ostream stream(io::back_inserter(payload));
+		OutputArchive oarch(stream);
+		WriteTables(oarch);
+		stream.flush();
+	}
+
+	void ReadPayload(const std::vector<char>& payload) {
+		io::stream<io::array_source> stream(payload.data(), payload.size());
+		InputArchive iarch(stream);
+		ReadTables(iarch);
+	}
+
+	template <typename T>
+	void Write(std::ostream& stream, T value) {
+		stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	template <typename T>
+	T Read(std::istream& stream) {
+		T value = 0;
+		stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+		return value;
+	}
+}
+
+/**
+	Binary cache of the preset tables filled in by the data file parsers.
+*/
+namespace PresetCache {
+	/**
+		Computes the key a cache must have to be valid for the given data files.
+
+		\param[in] files The data files contributing to the preset tables, in load order.
+		\returns         Hash of the game version, cache format, and the names and contents of the files.
+	*/
+	boost::uint64_t Key(const std::vector<fs::path>& files) {
+		boost::uint64_t hash = fnvOffsetBasis;
+		Hash(hash, std::string(Globals::gameVersion));
+		Hash(hash, cacheFormatConst);
+		Hash(hash, static_cast<boost::uint32_t>(BOOST_VERSION));
+
+		std::vector<char> contents;
+		for (std::vector<fs::path>::const_iterator file = files.begin(); file != files.end(); ++file) {
+			std::ifstream stream(file->string().c_str(), std::ios::binary);
+			contents.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+
+			Hash(hash, file->string());
+			Hash(hash, static_cast<boost::uint64_t>(contents.size()));
+			Hash(hash, contents.data(), contents.size());
+		}
+		return hash;
+	}
+
+	/**
+		Replaces the preset tables with the ones in the cache file, if it's valid for the given key.
+		The tables are left untouched if it isn't.
+
+		\param[in] cacheFile Full path to the cache file.
+		\param[in] key       Key computed by \ref Key for the data files that would be loaded.
+		\returns             Whether the tables were loaded.
+	*/
+	bool Load(const fs::path& cacheFile, boost::uint64_t key) {
+		if (!fs::exists(cacheFile)) {
+			LOG("No preset cache.");
+			return false;
+		}
+
+		std::vector<char> payload;
+		try {
+			std::ifstream stream(cacheFile.string().c_str(), std::ios::binary);
+			if (Read<boost::uint32_t>(stream) != cacheMagicConst ||
+				Read<boost::uint32_t>(stream) != cacheFormatConst ||
+				Read<boost::uint64_t>(stream) != key) {
+				LOG("Preset cache is stale.");
+				return false;
+			}
+
+			payload.resize(static_cast<size_t>(Read<boost::uint64_t>(stream)));
+			boost::uint64_t payloadHash = Read<boost::uint64_t>(stream);
+			stream.read(payload.data(), payload.size());
+
+			boost::uint64_t hash = fnvOffsetBasis;
+			Hash(hash, payload.data(), payload.size());
+			if (!stream || hash != payloadHash) {
+				LOG("Preset cache is damaged.");
+				return false;
+			}
+		} catch (const std::exception& e) {
+			LOG("std::exception while reading the preset cache: " << e.what());
+			return false;
+		}
+
+		// Keep the current tables around in case the payload doesn't deserialise
+		std::vector<char> previous;
+		WritePayload(previous);
+		try {
+			ReadPayload(payload);
+		} catch (const std::exception& e) {
+			LOG("std::exception while loading the preset cache: " << e.what());
+			ReadPayload(previous);
+			return false;
+		}
+
+		LOG("Loaded presets from " << cacheFile.string());
+		return true;
+	}
+
+	/**
+		Writes the current preset tables into the cache file.
+
+		\param[in] cacheFile Full path to the cache file.
+		\param[in] key       Key computed by \ref Key for the data files that were loaded.
+		\returns             Whether the cache was written.
+	*/
+	bool Save(const fs::path& cacheFile, boost::uint64_t key) {
+		try {
+			std::vector<char> payload;
+			WritePayload(payload);
+
+			boost::uint64_t hash = fnvOffsetBasis;
+			Hash(hash, payload.data(), payload.size());
+
+			// Write next to the cache and swap it in, so that an interrupted write can't leave a damaged cache
+			fs::path tmpFile = cacheFile;
+			tmpFile += ".tmp";
+			{
+				std::ofstream stream(tmpFile.string().c_str(), std::ios::binary);
+				stream.exceptions(std::ios::failbit | std::ios::badbit);
+				Write<boost::uint32_t>(stream, cacheMagicConst);
+				Write<boost::uint32_t>(stream, cacheFormatConst);
+				Write<boost::uint64_t>(stream, key);
+				Write<boost::uint64_t>(stream, payload.size());
+				Write<boost::uint64_t>(stream, hash);
+				stream.write(payload.data(), payload.size());
+			}
+			fs::rename(tmpFile, cacheFile);
+		} catch (const std::exception& e) {
+			LOG("std::exception while writing the preset cache: " << e.what());
+			return false;
+		}
+
+		LOG("Wrote preset cache to " << cacheFile.string());
+		return true;
+	}
+}
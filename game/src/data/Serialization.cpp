@@ -25,15 +25,33 @@ and I couldn't come up with a coherent answer just by googling. */
 
 #include <boost/bind.hpp>
 #include <boost/format.hpp>
+#include <boost/function.hpp>
 #include <fstream>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
 #include <boost/cstdint.hpp>
+#if GCAMP_USE_THREADS
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <thread>
+#endif
 
 #include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/stream.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
 #include <boost/iostreams/filter/zlib.hpp>
 
 namespace io = boost::iostreams;
 
 #include "Logger.hpp"
+#include "Announce.hpp"
+#include "Parallel.hpp"
 #include "data/Config.hpp"
 #include "data/Serialization.hpp"
 
@@ -43,6 +61,7 @@ namespace io = boost::iostreams;
 #include "Camp.hpp"
 #include "StockManager.hpp"
 #include "Map.hpp"
+#include "scripting/Event.hpp"
 
 // IMPORTANT
 // Implementing class versioning properly is an effort towards backward compatibility for saves,
@@ -73,7 +92,7 @@ namespace io = boost::iostreams;
 //        This value represents overall file format, as defined here.
 //        It should be incremented when file format changes so much that maintaining backward 
 //        compatibility is not possible or feasible. Parser MUST NOT attempt any further decoding
-//        if file format version is different than build's fileFormatConst.
+//        if file format version is neither fileFormatConst nor legacyFileFormatConst.
 //        
 //        File format version of 0xFF is reserved for experimental file formats,
 //        and should never be used in production branches.
@@ -85,18 +104,35 @@ namespace io = boost::iostreams;
 //           0x01 = zlib deflate
 //        Other values are invalid and MUST be rejected.
 //    - 0x00 (uint8_t,  reserved, little endian)
+//    - section count (uint16_t, little endian)
 //    - 0x00 (uint32_t, reserved, little endian)
+//    - total uncompressed payload size (uint64_t, little endian)
 //    - 0x00 (uint64_t, reserved, little endian)
 //    - 0x00 (uint64_t, reserved, little endian)
-//    - 0x00 (uint64_t, reserved, little endian)
-//    - actual serialised payload, defined and processed by Boost.Serialization machinery
+//    - section table, for each section:
+//        - section kind (uint8_t, see SectionKind)
+//        - uncompressed size (uint64_t, little endian)
+//        - stored size (uint64_t, little endian)
+//    - the sections, one after another
+//
+//  Every section is compressed on its own, so they are compressed and decompressed
+//  in parallel. Concatenated uncompressed sections form the actual serialised payload,
+//  defined and processed by Boost.Serialization machinery. It is a single archive, because
+//  objects are shared between Game, JobManager, Camp, StockManager and Map.
+//
+//  Legacy file format version 0x01 has all the reserved fields set to zero, no section
+//  table, and the payload written as one (optionally zlib compressed) stream.
 
 // Magic constant: reversed fourcc 'GCMP'
 // (so you can see it actually spelled like this when hex-viewing the save).
 const boost::uint32_t saveMagicConst = 0x47434d50;
 
 // File format version (8-bit, because it should not change too often).
-const boost::uint8_t fileFormatConst = 0x01;
+const boost::uint8_t fileFormatConst = 0x02;
+const boost::uint8_t legacyFileFormatConst = 0x01;
+
+// Big parts of the payload are split so that no section is larger than this.
+const size_t maxSectionSize = 4 * 1024 * 1024;
 
 //
 // Save/load entry points
@@ -146,19 +182,130 @@ namespace {
 	void WriteUInt<boost::uint8_t>(std::ostream& stream, boost::uint8_t value) {
 		stream.put(static_cast<char>(value));
 	}
-	
-	void WritePayload(io::filtering_ostream& ofs) {
-		boost::archive::binary_oarchive oarch(ofs);
-		oarch << Entity::uids;
-		oarch << *Game::Inst();
-		oarch << *JobManager::Inst();
-		oarch << *Camp::Inst();
-		oarch << *StockManager::Inst();
-		oarch << *Map::Inst();
+
+	enum SectionKind {
+		SectionGame,
+		SectionJobs,
+		SectionCamp,
+		SectionStock,
+		SectionMap
+	};
+
+	struct Section {
+		boost::uint8_t kind;
+		boost::uint64_t offset; // in the uncompressed payload
+		boost::uint64_t size;
+		std::vector<char> stored;
+	};
+
+	void CompressSection(const std::vector<char>& payload, std::vector<Section>& sections, size_t idx) {
+		Section& section = sections[idx];
+		section.stored.reserve(section.size / 2);
+		io::filtering_ostream stream;
+		io::zlib_params params(6); // level
+		stream.push(io::zlib_compressor(params));
+		stream.push(io::back_inserter(section.stored));
+		stream.write(&payload[section.offset], section.size);
+		stream.reset(); // flushes the compressor
 	}
-	
-	void ReadPayload(io::filtering_istream& ifs) {
-		boost::archive::binary_iarchive iarch(ifs);
+
+	void DecompressSection(std::vector<char>& payload, const std::vector<Section>& sections, size_t idx) {
+		const Section& section = sections[idx];
+		io::filtering_istream stream;
+		stream.push(io::zlib_decompressor());
+		stream.push(io::array_source(section.stored.data(), section.stored.size()));
+		stream.read(&payload[section.offset], section.size);
+		if (static_cast<boost::uint64_t>(stream.gcount()) != section.size) {
+			throw std::runtime_error("Truncated section.");
+		}
+	}
+
+	// Serialises everything into memory, noting where each part of the payload starts
+	void WritePayload(std::vector<char>& payload, std::vector<Section>& sections) {
+		io::filtering_ostream stream(io::back_inserter(payload));
+		boost::archive::binary_oarchive oarch(stream);
+
+		boost::uint64_t start = 0;
+		for (int kind = SectionGame; kind <= SectionMap; ++kind) {
+			switch (kind) {
+			case SectionGame:
+				oarch << Entity::uids;
+				oarch << *Game::Inst();
+				break;
+			case SectionJobs:  oarch << *JobManager::Inst();   break;
+			case SectionCamp:  oarch << *Camp::Inst();         break;
+			case SectionStock: oarch << *StockManager::Inst(); break;
+			case SectionMap:   oarch << *Map::Inst();          break;
+			}
+			stream.flush();
+
+			// Split big parts into several sections
+			for (boost::uint64_t end = payload.size(); start < end;) {
+				Section section;
+				section.kind = static_cast<boost::uint8_t>(kind);
+				section.offset = start;
+				section.size = std::min<boost::uint64_t>(end - start, maxSectionSize);
+				sections.push_back(section);
+				start += section.size;
+			}
+		}
+	}
+
+	// Compresses and writes out a payload produced by WritePayload, doesn't touch the game state
+	void WriteSections(const std::string& filename, bool compress, const std::vector<char>& payload, std::vector<Section>& sections) {
+		if (compress) {
+			ParallelFor(sections.size(), boost::bind(&CompressSection, boost::cref(payload), boost::ref(sections), _1));
+		}
+
+		std::ofstream rawStream(filename.c_str(), std::ios::binary);
+		rawStream.exceptions(std::ios::failbit | std::ios::badbit);
+
+		// Write the file header
+		WriteUInt<boost::uint32_t>(rawStream, saveMagicConst);
+		WriteUInt<boost::uint8_t> (rawStream, fileFormatConst);
+		// compression flag
+		WriteUInt<boost::uint8_t> (rawStream, (compress ? 0x01 : 0x00));
+		WriteUInt<boost::uint8_t> (rawStream, 0x00U);
+		WriteUInt<boost::uint16_t>(rawStream, static_cast<boost::uint16_t>(sections.size()));
+		WriteUInt<boost::uint32_t>(rawStream, 0x00UL);
+		WriteUInt<boost::uint64_t>(rawStream, payload.size());
+		WriteUInt<boost::uint64_t>(rawStream, 0x00ULL);
+		WriteUInt<boost::uint64_t>(rawStream, 0x00ULL);
+
+		// Section table
+		for (size_t i = 0; i < sections.size(); ++i) {
+			WriteUInt<boost::uint8_t> (rawStream, sections[i].kind);
+			WriteUInt<boost::uint64_t>(rawStream, sections[i].size);
+			WriteUInt<boost::uint64_t>(rawStream, compress ? sections[i].stored.size() : sections[i].size);
+		}
+
+		for (size_t i = 0; i < sections.size(); ++i) {
+			if (compress) rawStream.write(sections[i].stored.data(), sections[i].stored.size());
+			else rawStream.write(&payload[sections[i].offset], sections[i].size);
+		}
+	}
+
+	void WriteSaveFile(const std::string& filename, bool compress) {
+		std::vector<char> payload;
+		std::vector<Section> sections;
+		WritePayload(payload, sections);
+		WriteSections(filename, compress, payload, sections);
+	}
+
+	// Save running in the background, see Game::SaveGameInBackground
+	struct BackgroundSave {
+		std::string filename;
+		bool pending;
+#if GCAMP_USE_THREADS
+		std::future<void> done;
+#else
+		bool failed;
+#endif
+		BackgroundSave() : pending(false) {}
+	} backgroundSave;
+
+	void ReadPayload(std::istream& stream) {
+		boost::archive::binary_iarchive iarch(stream);
 		iarch >> Entity::uids;
 		iarch >> *Game::Inst();
 		iarch >> *JobManager::Inst();
@@ -166,38 +313,172 @@ namespace {
 		iarch >> *StockManager::Inst();
 		iarch >> *Map::Inst();
 	}
+
+	/* Decompresses sections on worker threads, in file order, while the payload is being
+	   deserialised. Reader() blocks only when it reaches a section that isn't done yet. */
+	class SectionDecompressor {
+		std::vector<char>& payload;
+		const std::vector<Section>& sections;
+#if GCAMP_USE_THREADS
+		std::atomic<size_t> next;
+		std::atomic<bool> abort;
+		std::vector<char> ready;
+		std::exception_ptr error;
+		std::mutex mutex;
+		std::condition_variable readyCondition;
+		std::vector<std::thread> workers;
+
+		void Work() {
+			for (size_t idx = next++; idx < sections.size() && !abort; idx = next++) {
+				std::exception_ptr sectionError;
+				try {
+					DecompressSection(payload, sections, idx);
+				} catch (...) {
+					sectionError = std::current_exception();
+				}
+				std::lock_guard<std::mutex> lock(mutex);
+				if (sectionError && !error) error = sectionError;
+				ready[idx] = 1;
+				readyCondition.notify_all();
+			}
+		}
+#else
+		size_t done;
+#endif
+
+	public:
+		SectionDecompressor(std::vector<char>& payload, const std::vector<Section>& sections) :
+			payload(payload), sections(sections)
+#if GCAMP_USE_THREADS
+			, next(0), abort(false), ready(sections.size(), 0) {
+			size_t count = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), sections.size()));
+			for (size_t i = 0; i < count; ++i) {
+				workers.push_back(std::thread(&SectionDecompressor::Work, this));
+			}
+		}
+#else
+			, done(0) {}
+#endif
+
+		~SectionDecompressor() {
+#if GCAMP_USE_THREADS
+			abort = true;
+			for (size_t i = 0; i < workers.size(); ++i) workers[i].join();
+#endif
+		}
+
+		// Blocks until the section is in the payload
+		void WaitFor(size_t idx) {
+#if GCAMP_USE_THREADS
+			std::unique_lock<std::mutex> lock(mutex);
+			readyCondition.wait(lock, [&]() { return ready[idx] != 0 || error; });
+			if (error) std::rethrow_exception(error);
+#else
+			for (; done <= idx; ++done) DecompressSection(payload, sections, done);
+#endif
+		}
+
+		// Boost.Iostreams source reading the payload as sections become available
+		class Reader {
+			SectionDecompressor* decompressor;
+			boost::uint64_t position;
+			size_t section;
+		public:
+			typedef char char_type;
+			typedef io::source_tag category;
+
+			explicit Reader(SectionDecompressor* decompressor) : decompressor(decompressor), position(0), section(0) {}
+
+			std::streamsize read(char* s, std::streamsize n) {
+				const std::vector<Section>& sections = decompressor->sections;
+				while (section < sections.size() && position >= sections[section].offset + sections[section].size) ++section;
+				if (section >= sections.size()) return -1;
+
+				decompressor->WaitFor(section);
+				boost::uint64_t available = sections[section].offset + sections[section].size - position;
+				std::streamsize count = static_cast<std::streamsize>(std::min<boost::uint64_t>(available, n));
+				std::copy(&decompressor->payload[position], &decompressor->payload[position] + count, s);
+				position += count;
+				return count;
+			}
+		};
+	};
+
+	void ReadSections(std::istream& rawStream, bool compressed, boost::uint16_t sectionCount, boost::uint64_t payloadSize) {
+		std::vector<Section> sections(sectionCount);
+		boost::uint64_t offset = 0;
+		for (size_t i = 0; i < sections.size(); ++i) {
+			sections[i].kind   = ReadUInt<boost::uint8_t>(rawStream);
+			sections[i].size   = ReadUInt<boost::uint64_t>(rawStream);
+			sections[i].stored.resize(ReadUInt<boost::uint64_t>(rawStream));
+			sections[i].offset = offset;
+			offset += sections[i].size;
+			if (!compressed && sections[i].stored.size() != sections[i].size) {
+				throw std::runtime_error("Invalid section size.");
+			}
+		}
+		if (offset != payloadSize) {
+			throw std::runtime_error("Section table doesn't match payload size.");
+		}
+
+		std::vector<char> payload(payloadSize);
+		for (size_t i = 0; i < sections.size(); ++i) {
+			if (compressed) rawStream.read(sections[i].stored.data(), sections[i].stored.size());
+			else rawStream.read(&payload[sections[i].offset], sections[i].size);
+			if (!rawStream) throw std::runtime_error("Unexpected end of file.");
+		}
+
+		if (compressed) {
+			SectionDecompressor decompressor(payload, sections);
+			SectionDecompressor::Reader reader(&decompressor);
+			io::stream<SectionDecompressor::Reader> stream(reader);
+			ReadPayload(stream);
+		} else {
+			io::stream<io::array_source> stream(payload.data(), payload.size());
+			ReadPayload(stream);
+		}
+	}
 }
 
 bool Game::SaveGame(const std::string& filename) {
+	FinishBackgroundSave(true);
 	try {
-		std::ofstream rawStream(filename.c_str(), std::ios::binary);
-		io::filtering_ostream stream;
-		
-		// Write the file header
-		WriteUInt<boost::uint32_t>(rawStream, saveMagicConst);
-		WriteUInt<boost::uint8_t> (rawStream, fileFormatConst);
-		
 		bool compress = Config::GetCVar<bool>("compressSaves");
-		// compression flag
-		WriteUInt<boost::uint8_t>(rawStream, (compress ? 0x01 : 0x00));
+		Game::SavingScreen(boost::bind(&WriteSaveFile, boost::cref(filename), compress));
 		
-		// reserved
-		WriteUInt<boost::uint8_t> (rawStream, 0x00U);
-		WriteUInt<boost::uint16_t>(rawStream, 0x00U);
-		WriteUInt<boost::uint32_t>(rawStream, 0x00UL);
-		WriteUInt<boost::uint64_t>(rawStream, 0x00ULL);
-		WriteUInt<boost::uint64_t>(rawStream, 0x00ULL);
-		WriteUInt<boost::uint64_t>(rawStream, 0x00ULL);
-		
-		// Write the payload
-		if (compress) {
-			io::zlib_params params(6); // level
-			stream.push(io::zlib_compressor(params));
+		return true;
+	} catch (const std::exception& e) {
+		LOG("std::exception while trying to save the game: " << e.what());
+		return false;
+	}
+}
+
+/* Serialises the game into memory right away, the compression and file output happen on
+   another thread so that the game keeps running meanwhile. The outcome is reported by
+   FinishBackgroundSave(). */
+bool Game::SaveGameInBackground(const std::string& filename) {
+	FinishBackgroundSave(true);
+	try {
+		bool compress = Config::GetCVar<bool>("compressSaves");
+		boost::shared_ptr<std::vector<char> > payload(new std::vector<char>());
+		boost::shared_ptr<std::vector<Section> > sections(new std::vector<Section>());
+		WritePayload(*payload, *sections);
+
+		backgroundSave.filename = filename;
+		backgroundSave.pending = true;
+#if GCAMP_USE_THREADS
+		backgroundSave.done = std::async(std::launch::async, [=]() {
+			WriteSections(filename, compress, *payload, *sections);
+		});
+#else
+		try {
+			WriteSections(filename, compress, *payload, *sections);
+			backgroundSave.failed = false;
+		} catch (const std::exception& e) {
+			LOG("std::exception while trying to save the game: " << e.what());
+			backgroundSave.failed = true;
 		}
-		
-		stream.push(rawStream);
-		Game::SavingScreen(boost::bind(&WritePayload, boost::ref(stream)));
-		
+#endif
 		return true;
 	} catch (const std::exception& e) {
 		LOG("std::exception while trying to save the game: " << e.what());
@@ -205,7 +486,33 @@ bool Game::SaveGame(const std::string& filename) {
 	}
 }
 
+void Game::FinishBackgroundSave(bool wait) {
+	if (!backgroundSave.pending) return;
+	bool failed;
+#if GCAMP_USE_THREADS
+	if (!wait && backgroundSave.done.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return;
+	try {
+		backgroundSave.done.get();
+		failed = false;
+	} catch (const std::exception& e) {
+		LOG("std::exception while trying to save the game: " << e.what());
+		failed = true;
+	}
+#else
+	failed = backgroundSave.failed;
+#endif
+	backgroundSave.pending = false;
+
+	if (failed) {
+		Announce::Inst()->AddMsg("Failed to autosave! Refer to the logfile", GCampColor::red);
+	} else {
+		Announce::Inst()->AddMsg("Autosaved");
+		Script::Event::GameSaved(backgroundSave.filename);
+	}
+}
+
 bool Game::LoadGame(const std::string& filename) {
+	FinishBackgroundSave(true);
 	try {
 		std::ifstream rawStream(filename.c_str(), std::ios::binary);
 		io::filtering_istream stream;
@@ -215,7 +522,8 @@ bool Game::LoadGame(const std::string& filename) {
 			throw std::runtime_error("Invalid magic value.");
 		}
 		
-		if (ReadUInt<boost::uint8_t>(rawStream) != fileFormatConst) {
+		boost::uint8_t fileFormat = ReadUInt<boost::uint8_t>(rawStream);
+		if (fileFormat != fileFormatConst && fileFormat != legacyFileFormatConst) {
 			throw std::runtime_error("Invalid file format value.");
 		}
 		
@@ -230,13 +538,15 @@ bool Game::LoadGame(const std::string& filename) {
 		if (ReadUInt<boost::uint8_t>(rawStream) != 0) {
 			throw std::runtime_error("Forward compatibility: reserved value #1 not 0x00.");
 		}
-		if (ReadUInt<boost::uint16_t>(rawStream) != 0) {
+		boost::uint16_t sectionCount = ReadUInt<boost::uint16_t>(rawStream);
+		if (fileFormat == legacyFileFormatConst && sectionCount != 0) {
 			throw std::runtime_error("Forward compatibility: reserved value #2 not 0x0000.");
 		}
 		if (ReadUInt<boost::uint32_t>(rawStream) != 0) {
 			throw std::runtime_error("Forward compatibility: reserved value #3 not 0x00000000.");
 		}
-		if (ReadUInt<boost::uint64_t>(rawStream) != 0) {
+		boost::uint64_t payloadSize = ReadUInt<boost::uint64_t>(rawStream);
+		if (fileFormat == legacyFileFormatConst && payloadSize != 0) {
 			throw std::runtime_error("Forward compatibility: reserved value #4 not 0x0000000000000000.");
 		}
 		if (ReadUInt<boost::uint64_t>(rawStream) != 0) {
@@ -249,14 +559,19 @@ bool Game::LoadGame(const std::string& filename) {
 		Game::Inst()->Reset();
 		
 		// Read the payload
-		if (compressed) {
-			stream.push(io::zlib_decompressor());
+		if (fileFormat == legacyFileFormatConst) {
+			if (compressed) {
+				stream.push(io::zlib_decompressor());
+			}
+			
+			stream.push(rawStream);
+			Game::LoadingScreen(boost::bind(&ReadPayload, boost::ref(stream)));
+		} else {
+			Game::LoadingScreen(boost::bind(&ReadSections, boost::ref(rawStream), compressed != 0, sectionCount, payloadSize));
 		}
-		
-		stream.push(rawStream);
-		Game::LoadingScreen(boost::bind(&ReadPayload, boost::ref(stream)));
 		Game::Inst()->TranslateContainerListeners();
 		Game::Inst()->ProvideMap();
+		Map::Inst()->RebuildCache();
 		Game::Inst()->Pause();
 		
 		return true;
@@ -19,6 +19,9 @@ along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
 #include <cassert>
 #include <cstdarg>
 #include <list>
+#include <map>
+#include <string>
+#include <functional>
 #include <boost/foreach.hpp>
 
 #include <boost/python/detail/wrap_python.hpp>
@@ -36,6 +39,17 @@ namespace py = boost::python;
 
 namespace Globals {
 	std::list<py::object> listeners;
+	// Bound event handlers, keyed by event method name. Filled in once per listener
+	// by AppendListener, so dispatching does not have to probe every listener.
+	std::map<std::string, std::list<py::object>, std::less<> > subscribers;
+}
+
+namespace {
+	// Every method name Script::Event may invoke on a listener.
+	const char *eventMethods[] = {
+		"onGameStart", "onGameEnd", "onGameSaved", "onGameLoaded",
+		"onBuildingCreated", "onBuildingDestroyed", "onItemCreated", "onTierChanged"
+	};
 }
 
 namespace Script { namespace API {
@@ -75,15 +89,23 @@ namespace Script {
 		}
 		
 		Globals::listeners.push_back(oListener);
+
+		for (unsigned idx = 0; idx < sizeof(eventMethods) / sizeof(eventMethods[0]); ++idx) {
+			if (PyObject_HasAttrString(listener, eventMethods[idx])) {
+				Globals::subscribers[eventMethods[idx]].push_back(oListener.attr(eventMethods[idx]));
+			}
+		}
+	}
+	
+	bool HasListeners(const char *method) {
+		return Globals::subscribers.find(method) != Globals::subscribers.end();
 	}
 	
 	void InvokeListeners(const char *method, PyObject *args) {
-		BOOST_FOREACH(py::object listener, Globals::listeners) {
-			if (!PyObject_HasAttrString(listener.ptr(), method)) {
-				continue;
-			}
-			
-			py::object callable = listener.attr(method);
+		std::map<std::string, std::list<py::object>, std::less<> >::iterator subscribersi = Globals::subscribers.find(method);
+		if (subscribersi == Globals::subscribers.end()) return;
+
+		BOOST_FOREACH(py::object callable, subscribersi->second) {
 			try {
 				py::handle<> result(
 					PyObject_CallObject(callable.ptr(), args)
@@ -108,6 +130,7 @@ namespace Script {
 	}
 	
 	void ReleaseListeners() {
+		Globals::subscribers.clear();
 		Globals::listeners.clear();
 	}
 }
@@ -16,6 +16,7 @@ along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
 #include "stdafx.hpp"
 
 #include <list>
+#include <vector>
 #include <string>
 #include <boost/shared_ptr.hpp>
 #include <boost/python/detail/wrap_python.hpp>
@@ -31,11 +32,50 @@ namespace py = boost::python;
 #include "scripting/_gcampapi/PyItem.hpp"
 #include "scripting/_gcampapi/PyConstruction.hpp"
 
+namespace {
+	struct QueuedEvent {
+		const char *method;
+		bool isItem;
+		boost::weak_ptr<Construction> construction;
+		boost::weak_ptr<Item> item;
+		int x, y;
+	};
+
+	std::vector<QueuedEvent> queue;
+}
+
 namespace Script { namespace Event {
+	void DispatchQueued() {
+		if (queue.empty()) return;
+
+		// Listeners may raise new events, those will wait for the next dispatch
+		std::vector<QueuedEvent> events;
+		events.swap(queue);
+
+		for (std::vector<QueuedEvent>::iterator eventi = events.begin(); eventi != events.end(); ++eventi) {
+			if (eventi->isItem) {
+				Script::API::PyItem pyitem(eventi->item);
+				py::object obj(boost::ref(pyitem));
+				Script::InvokeListeners(eventi->method, "(Oii)", obj.ptr(), eventi->x, eventi->y);
+			} else {
+				Script::API::PyConstruction pyconstruction(eventi->construction);
+				py::object obj(boost::ref(pyconstruction));
+				Script::InvokeListeners(eventi->method, "(Oii)", obj.ptr(), eventi->x, eventi->y);
+			}
+		}
+
+		// Keep the allocated storage around for the next tick
+		if (queue.empty()) {
+			events.clear();
+			queue.swap(events);
+		}
+	}
+
 	void GameStart() {
 		PyGILState_STATE gstate;
 		gstate = PyGILState_Ensure(); // Grab Global Interpreter Log before doing python stuff
 		{
+			DispatchQueued();
 			Script::InvokeListeners("onGameStart");
 		}
 		PyGILState_Release(gstate);
@@ -45,6 +85,7 @@ namespace Script { namespace Event {
 		PyGILState_STATE gstate;
 		gstate = PyGILState_Ensure(); // Grab Global Interpreter Log before doing python stuff
 		{
+			DispatchQueued();
 			Script::InvokeListeners("onGameEnd");
 		}
 		PyGILState_Release(gstate);
@@ -54,6 +95,7 @@ namespace Script { namespace Event {
 		PyGILState_STATE gstate;
 		gstate = PyGILState_Ensure(); // Grab Global Interpreter Log before doing python stuff
 		{
+			DispatchQueued();
 			Script::InvokeListeners("onGameSaved", "(s)", filename.c_str());
 		}
 		PyGILState_Release(gstate);
@@ -63,49 +105,38 @@ namespace Script { namespace Event {
 		PyGILState_STATE gstate;
 		gstate = PyGILState_Ensure(); // Grab Global Interpreter Log before doing python stuff
 		{
+			DispatchQueued();
 			Script::InvokeListeners("onGameLoaded", "(s)", filename.c_str());
 		}
 		PyGILState_Release(gstate);
 	}
 	
 	void BuildingCreated(boost::weak_ptr<Construction> cons, int x, int y) {
-		PyGILState_STATE gstate;
-		gstate = PyGILState_Ensure(); // Grab Global Interpreter Log before doing python stuff
-		{
-			Script::API::PyConstruction pyconstruction(cons);
-			py::object obj(boost::ref(pyconstruction));
-			Script::InvokeListeners("onBuildingCreated", "(Oii)", obj.ptr(), x, y);
-		}
-		PyGILState_Release(gstate);
+		if (!Script::HasListeners("onBuildingCreated")) return;
+
+		QueuedEvent event = { "onBuildingCreated", false, cons, boost::weak_ptr<Item>(), x, y };
+		queue.push_back(event);
 	}
 	
 	void BuildingDestroyed(boost::weak_ptr<Construction> cons, int x, int y) {
-		PyGILState_STATE gstate;
-		gstate = PyGILState_Ensure(); // Grab Global Interpreter Log before doing python stuff
-		{
-			Script::API::PyConstruction pyconstruction(cons);
-			py::object obj(boost::ref(pyconstruction));
-			Script::InvokeListeners("onBuildingDestroyed", "(Oii)", obj.ptr(), x, y);
-		}
-		PyGILState_Release(gstate);
+		if (!Script::HasListeners("onBuildingDestroyed")) return;
+
+		QueuedEvent event = { "onBuildingDestroyed", false, cons, boost::weak_ptr<Item>(), x, y };
+		queue.push_back(event);
 	}
 	
 	void ItemCreated(boost::weak_ptr<Item> item, int x, int y) {
-		PyGILState_STATE gstate;
-		gstate = PyGILState_Ensure(); // Grab Global Interpreter Log before doing python stuff
-		{
-			Script::API::PyItem pyitem(item);
-		
-			py::object obj(boost::ref(pyitem));
-			Script::InvokeListeners("onItemCreated", "(Oii)", obj.ptr(), x, y);
-		}
-		PyGILState_Release(gstate);
+		if (!Script::HasListeners("onItemCreated")) return;
+
+		QueuedEvent event = { "onItemCreated", true, boost::weak_ptr<Construction>(), item, x, y };
+		queue.push_back(event);
 	}
 	
 	void TierChanged(int tier, const std::string& campName) {
 		PyGILState_STATE gstate;
 		gstate = PyGILState_Ensure(); // Grab Global Interpreter Log before doing python stuff
 		{
+			DispatchQueued();
 			Script::InvokeListeners("onTierChanged", "(is)", tier, campName.c_str());
 		}
 		PyGILState_Release(gstate);
@@ -91,6 +91,21 @@ bool TerrainSprite::Exists() const {
 	return numSprites > 0 || edge.Exists();
 }
 
+namespace {
+	bool AnyAnimated(const std::vector<Sprite_ptr>& sprites) {
+		for (std::vector<Sprite_ptr>::const_iterator spritei = sprites.begin(); spritei != sprites.end(); ++spritei) {
+			if (spritei->IsAnimated()) return true;
+		}
+		return false;
+	}
+}
+
+bool TerrainSprite::IsAnimated() const {
+	return AnyAnimated(sprites) || AnyAnimated(snowSprites) || edge.IsAnimated() || snowEdge.IsAnimated()
+		|| AnyAnimated(details) || AnyAnimated(burntDetails) || AnyAnimated(snowedDetails) || AnyAnimated(corruptedDetails)
+		|| corruption.IsAnimated() || burntOverlay.IsAnimated();
+}
+
 namespace {
 	bool WangConnected(const PermutationTable* permTable, Coordinate pos, Direction dir) {
 		switch (dir)
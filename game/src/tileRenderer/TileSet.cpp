@@ -110,6 +110,14 @@ bool TileSet::IsIceSupported() const {
 	return waterTile.IsTwoLayeredConnectionMap() || iceTile.Exists();
 }
 
+bool TileSet::IsTerrainAnimated() const {
+	if (defaultTerrainTile.IsAnimated()) return true;
+	for (TileTypeSpriteArray::const_iterator terraini = terrainTiles.begin(); terraini != terrainTiles.end(); ++terraini) {
+		if (terraini->IsAnimated()) return true;
+	}
+	return waterTile.IsAnimated() || iceTile.IsAnimated() || blood.IsAnimated() || markedOverlay.IsAnimated();
+}
+
 void TileSet::DrawMarkedOverlay(int screenX, int screenY) const {
 	markedOverlay.Draw(screenX, screenY);
 }
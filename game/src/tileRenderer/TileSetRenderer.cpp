@@ -223,6 +223,8 @@ void TilesetRenderer::DrawMap(Map* mapToDraw, float focusX, float focusY, int vi
 	tilesX = CeilToInt::convert((focusX * tileSet->TileWidth() + viewportW / 2) / tileSet->TileWidth()) - startTileX;
 	tilesY = CeilToInt::convert((focusY * tileSet->TileHeight() + viewportH / 2) / tileSet->TileHeight()) - startTileY;
 
+	bool terrainDrawn = DrawCachedTerrain();
+
     // And then render to map
 	for (int y = 0; y < tilesY; ++y) {
 		for (int x = 0; x <= tilesX; ++x) {
@@ -230,7 +232,7 @@ void TilesetRenderer::DrawMap(Map* mapToDraw, float focusX, float focusY, int vi
 			
 			// Draw Terrain
 			if (map->IsInside(pos)) {
-				DrawTerrain(x, y, pos);			
+				if (!terrainDrawn) DrawTerrain(x, y, pos);
 				
 				if (!(map->GetOverlayFlags() & TERRAIN_OVERLAY)) {
 					if (boost::shared_ptr<Construction> construction = (Game::Inst()->GetConstruction(map->GetConstruction(pos))).lock()) {
@@ -358,7 +360,7 @@ void TilesetRenderer::DrawSpells() const {
 }
 
 void TilesetRenderer::DrawFires() const {
-	for (std::list<boost::weak_ptr<FireNode> >::iterator firei = Game::Inst()->fireList.begin(); firei != Game::Inst()->fireList.end(); ++firei) {
+	for (std::vector<boost::weak_ptr<FireNode> >::iterator firei = Game::Inst()->fireList.begin(); firei != Game::Inst()->fireList.end(); ++firei) {
 		if (boost::shared_ptr<FireNode> fire = firei->lock())
 		{
 			Coordinate firePos = fire->Position();
@@ -466,6 +468,10 @@ bool TilesetRenderer::TilesetChanged() {
 	return true;
 }
 
+bool TilesetRenderer::DrawCachedTerrain() {
+	return false;
+}
+
 void TilesetRenderer::SetTranslucentUI(bool translucent) {
 	translucentUI = translucent;
 }
@@ -0,0 +1,137 @@
+/* Copyright 2010-2011 Ilkka Halila
+This file is part of Goblins' Lot (former Goblin Camp)
+
+Goblin Camp is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Goblin Camp is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
+#include "stdafx.hpp"
+
+#include "tileRenderer/sdl/SDLTerrainCache.hpp"
+
+#include <algorithm>
+
+#include "Logger.hpp"
+
+SDLTerrainCache::SDLTerrainCache()
+: chunks(),
+  mapExtent(),
+  tileWidth(0),
+  tileHeight(0),
+  pixelFormat(0),
+  bitsPerPixel(0),
+  current()
+{
+}
+
+void SDLTerrainCache::Reset(const Coordinate& extent, int width, int height, const SDL_PixelFormat* format) {
+	if (extent != mapExtent || width != tileWidth || height != tileHeight ||
+		format->format != pixelFormat || format->BitsPerPixel != bitsPerPixel) {
+		Clear();
+		mapExtent = extent;
+		tileWidth = width;
+		tileHeight = height;
+		pixelFormat = format->format;
+		bitsPerPixel = format->BitsPerPixel;
+	}
+}
+
+void SDLTerrainCache::Clear() {
+	chunks.clear();
+}
+
+void SDLTerrainCache::Draw(SDL_Surface* target, int originX, int originY, const Coordinate& start, const Coordinate& extent,
+	const SignatureFunction& signature, const DrawFunction& draw) {
+	for (std::map<int, Chunk>::iterator chunki = chunks.begin(); chunki != chunks.end(); ++chunki) {
+		chunki->second.used = false;
+	}
+
+	// The tiles to draw that are inside the map
+	int left = std::max(start.X(), 0);
+	int top = std::max(start.Y(), 0);
+	int right = std::min(start.X() + extent.X(), mapExtent.X());
+	int bottom = std::min(start.Y() + extent.Y(), mapExtent.Y());
+	int chunksX = (mapExtent.X() + ChunkSize - 1) / ChunkSize;
+
+	for (int chunkY = top / ChunkSize; chunkY * ChunkSize < bottom; ++chunkY) {
+		for (int chunkX = left / ChunkSize; chunkX * ChunkSize < right; ++chunkX) {
+			Coordinate origin(chunkX * ChunkSize, chunkY * ChunkSize);
+			int x0 = std::max(left, origin.X());
+			int y0 = std::max(top, origin.Y());
+			int x1 = std::min(right, origin.X() + ChunkSize);
+			int y1 = std::min(bottom, origin.Y() + ChunkSize);
+
+			Chunk& chunk = chunks[chunkY * chunksX + chunkX];
+			chunk.used = true;
+			if (!Refresh(chunk, origin, signature, draw)) {
+				// No surface to cache it in, draw the tiles straight onto the target
+				for (int y = y0; y < y1; ++y) {
+					for (int x = x0; x < x1; ++x) {
+						draw(target, originX + (x - start.X()) * tileWidth, originY + (y - start.Y()) * tileHeight, Coordinate(x, y));
+					}
+				}
+				continue;
+			}
+
+			SDL_Rect srcRect = {
+				(x0 - origin.X()) * tileWidth,
+				(y0 - origin.Y()) * tileHeight,
+				(x1 - x0) * tileWidth,
+				(y1 - y0) * tileHeight
+			};
+			SDL_Rect dstRect = {
+				originX + (x0 - start.X()) * tileWidth,
+				originY + (y0 - start.Y()) * tileHeight,
+				srcRect.w,
+				srcRect.h
+			};
+			SDL_BlitSurface(chunk.surface.get(), &srcRect, target, &dstRect);
+		}
+	}
+
+	// Only keep what's on screen, scrolling back redraws the chunks that come into view
+	for (std::map<int, Chunk>::iterator chunki = chunks.begin(); chunki != chunks.end();) {
+		if (!chunki->second.used) chunks.erase(chunki++);
+		else ++chunki;
+	}
+}
+
+bool SDLTerrainCache::Refresh(Chunk& chunk, const Coordinate& origin, const SignatureFunction& signature, const DrawFunction& draw) {
+	current.clear();
+	for (int y = -1; y <= ChunkSize; ++y) {
+		for (int x = -1; x <= ChunkSize; ++x) {
+			Coordinate pos(origin.X() + x, origin.Y() + y);
+			bool inside = pos.X() >= 0 && pos.Y() >= 0 && pos.X() < mapExtent.X() && pos.Y() < mapExtent.Y();
+			current.push_back(inside ? signature(pos) : 0);
+		}
+	}
+	if (chunk.surface && chunk.signatures == current) return true;
+
+	if (!chunk.surface) {
+		SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, ChunkSize * tileWidth, ChunkSize * tileHeight, bitsPerPixel, pixelFormat);
+		if (!surface) {
+			LOG(SDL_GetError());
+			return false;
+		}
+		// Copied over the map as is, the tiles have already been blended into it
+		SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_NONE);
+		chunk.surface = boost::shared_ptr<SDL_Surface>(surface, SDL_FreeSurface);
+	}
+
+	SDL_FillRect(chunk.surface.get(), 0, 0);
+	for (int y = 0; y < ChunkSize && origin.Y() + y < mapExtent.Y(); ++y) {
+		for (int x = 0; x < ChunkSize && origin.X() + x < mapExtent.X(); ++x) {
+			draw(chunk.surface.get(), x * tileWidth, y * tileHeight, Coordinate(origin.X() + x, origin.Y() + y));
+		}
+	}
+	chunk.signatures.swap(current);
+	return true;
+}
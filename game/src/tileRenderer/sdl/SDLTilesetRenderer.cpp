@@ -29,6 +29,15 @@ along with Goblin Camp. If not, see <http://www.gnu.org/licenses/>.*/
 
 #include <libtcod/libtcod_int.h>
 
+#include <algorithm>
+#include <cstring>
+#include <boost/bind.hpp>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
 
 boost::shared_ptr<TilesetRenderer> CreateSDLTilesetRenderer(TCODConsole * console, std::string tilesetName) {
 	boost::shared_ptr<SDLTilesetRenderer> sdlRenderer(new SDLTilesetRenderer(console));
@@ -43,7 +52,10 @@ boost::shared_ptr<TilesetRenderer> CreateSDLTilesetRenderer(TCODConsole * consol
 
 SDLTilesetRenderer::SDLTilesetRenderer(TCODConsole * mapConsole)
 : TilesetRenderer(mapConsole),
-  mapSurface()
+  mapSurface(),
+  target(0),
+  terrainCache(),
+  terrainCacheable(false)
 {
 	TCODSystem::registerSDLRenderer(this/*, translucentUI*/);  // FIXME translucentUI came from tcod 1.5.x times. Later should find out how to remove it properly
 	Uint32 rmask, gmask, bmask, amask;
@@ -79,6 +91,7 @@ SDLTilesetRenderer::SDLTilesetRenderer(TCODConsole * mapConsole)
 	{
 		LOG(SDL_GetError());
 	}
+	target = mapSurface.get();
 }
 
 SDLTilesetRenderer::~SDLTilesetRenderer() {
@@ -108,12 +121,12 @@ void SDLTilesetRenderer::PostDrawMap() {
 	
 void SDLTilesetRenderer::DrawSprite(int screenX, int screenY, boost::shared_ptr<TileSetTexture> texture, int tile) const {
 	SDL_Rect dstRect = CalcDest(screenX, screenY);
-	texture->DrawTile(tile, mapSurface.get(), &dstRect);
+	texture->DrawTile(tile, target, &dstRect);
 }
 
 void SDLTilesetRenderer::DrawSpriteCorner(int screenX, int screenY, boost::shared_ptr<TileSetTexture> texture, int tile, Corner corner) const {
 	SDL_Rect dstRect = CalcDest(screenX, screenY);
-	texture->DrawTileCorner(tile, corner, mapSurface.get(), &dstRect);
+	texture->DrawTileCorner(tile, corner, target, &dstRect);
 }
 
 
@@ -122,6 +135,62 @@ void SDLTilesetRenderer::DrawNullTile(int screenX, int screenY) {
 	SDL_FillRect(mapSurface.get(), &dstRect, 0);
 }
 
+bool SDLTilesetRenderer::TilesetChanged() {
+	terrainCache.Clear();
+	terrainCacheable = !tileSet->IsTerrainAnimated();
+	return TilesetRenderer::TilesetChanged();
+}
+
+bool SDLTilesetRenderer::DrawCachedTerrain() {
+	if (!mapSurface || !terrainCacheable) return false;
+
+	terrainCache.Reset(map->Extent(), tileSet->TileWidth(), tileSet->TileHeight(), mapSurface->format);
+	terrainCache.Draw(mapSurface.get(), startPixelX + mapOffsetX, startPixelY + mapOffsetY,
+		Coordinate(startTileX, startTileY), Coordinate(tilesX + 1, tilesY),
+		boost::bind(&SDLTilesetRenderer::TerrainSignature, this, _1),
+		boost::bind(&SDLTilesetRenderer::DrawTerrainTo, this, _1, _2, _3, _4));
+	return true;
+}
+
+// Everything DrawTerrain looks at when drawing the tile, or a neighbour connecting to it
+boost::uint64_t SDLTilesetRenderer::TerrainSignature(const Coordinate& pos) const {
+	boost::uint32_t flags = map->GetType(pos);
+	if (map->GetCorruption(pos) >= 100) flags |= 1 << 8;
+	if (map->Burnt(pos) >= 10) flags |= 1 << 9;
+	if (boost::shared_ptr<WaterNode> water = map->GetWater(pos).lock()) {
+		if (water->Depth() > 0) flags |= 1 << 10;
+	}
+	int natNum = map->GetNatureObject(pos);
+	if (natNum >= 0 && Game::Inst()->natureList[natNum]->IsIce()) flags |= 1 << 11;
+	if (boost::shared_ptr<BloodNode> blood = map->GetBlood(pos).lock()) {
+		if (blood->Depth() > 0) flags |= 1 << 12;
+	}
+	if (map->GroundMarked(pos)) flags |= 1 << 13;
+
+	float height = map->heightMap->getValue(pos.X(), pos.Y());
+	boost::uint32_t heightBits;
+	std::memcpy(&heightBits, &height, sizeof(heightBits));
+	return (static_cast<boost::uint64_t>(heightBits) << 32) | flags;
+}
+
+void SDLTilesetRenderer::DrawTerrainTo(SDL_Surface * surface, int pixelX, int pixelY, const Coordinate& pos) {
+	SDL_Surface * previousTarget = target;
+	int previousOffsetX = mapOffsetX, previousOffsetY = mapOffsetY;
+	int previousStartX = startPixelX, previousStartY = startPixelY;
+
+	target = surface;
+	mapOffsetX = pixelX;
+	mapOffsetY = pixelY;
+	startPixelX = startPixelY = 0;
+	DrawTerrain(0, 0, pos);
+
+	target = previousTarget;
+	mapOffsetX = previousOffsetX;
+	mapOffsetY = previousOffsetY;
+	startPixelX = previousStartX;
+	startPixelY = previousStartY;
+}
+
 void SDLTilesetRenderer::SetTranslucentUI(bool translucent) {
 	if (translucent != translucentUI) {
 		TCODSystem::registerSDLRenderer(this/*, translucent*/);
@@ -130,19 +199,62 @@ void SDLTilesetRenderer::SetTranslucentUI(bool translucent) {
 }
 
 namespace {
-	inline void setPixelAlpha(SDL_Surface *surface, int x, int y, Uint32 keyColor)
-	{
-		SDL_PixelFormat *fmt = surface->format;
-		int bpp = fmt->BytesPerPixel;
-		if (bpp != 4) return;
-
-		Uint32 *p = (Uint32 *)((Uint8 *)surface->pixels + y * surface->pitch) + x;
-		Uint32 c = (*p | fmt->Amask);
-		if (c == keyColor) {
-			*p = *p & ~fmt->Amask;
-		} else if (c == fmt->Amask) {
-			*p = (*p & ~fmt->Amask) | (128 << fmt->Ashift);
+	/* Every pixel of a span is rewritten on its own: pixels that are the key color once their
+	   alpha is forced to opaque lose their alpha, and black ones get half of it. */
+	void KeySpanScalar(Uint32 *p, int count, Uint32 keyColor, Uint32 amask, Uint32 halfAlpha) {
+		for (int i = 0; i < count; ++i) {
+			Uint32 c = p[i] | amask;
+			if (c == keyColor) {
+				p[i] &= ~amask;
+			} else if (c == amask) {
+				p[i] = (p[i] & ~amask) | halfAlpha;
+			}
+		}
+	}
+
+	// Same as KeySpanScalar, four pixels at a time
+	void KeySpan(Uint32 *p, int count, Uint32 keyColor, Uint32 amask, Uint32 halfAlpha) {
+		int i = 0;
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		const __m128i key = _mm_set1_epi32(static_cast<int>(keyColor));
+		const __m128i alpha = _mm_set1_epi32(static_cast<int>(amask));
+		const __m128i half = _mm_set1_epi32(static_cast<int>(halfAlpha));
+		for (; i + 4 <= count; i += 4) {
+			__m128i *pixels = reinterpret_cast<__m128i*>(p + i);
+			__m128i v = _mm_loadu_si128(pixels);
+			__m128i c = _mm_or_si128(v, alpha);
+			__m128i isKey = _mm_cmpeq_epi32(c, key);
+			__m128i isBlack = _mm_andnot_si128(isKey, _mm_cmpeq_epi32(c, alpha));
+			__m128i cleared = _mm_and_si128(_mm_or_si128(isKey, isBlack), alpha);
+			_mm_storeu_si128(pixels, _mm_or_si128(_mm_andnot_si128(cleared, v), _mm_and_si128(isBlack, half)));
+		}
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+		const uint32x4_t key = vdupq_n_u32(keyColor);
+		const uint32x4_t alpha = vdupq_n_u32(amask);
+		const uint32x4_t half = vdupq_n_u32(halfAlpha);
+		for (; i + 4 <= count; i += 4) {
+			uint32x4_t v = vld1q_u32(p + i);
+			uint32x4_t c = vorrq_u32(v, alpha);
+			uint32x4_t isKey = vceqq_u32(c, key);
+			uint32x4_t isBlack = vbicq_u32(vceqq_u32(c, alpha), isKey);
+			uint32x4_t cleared = vandq_u32(vorrq_u32(isKey, isBlack), alpha);
+			vst1q_u32(p + i, vorrq_u32(vbicq_u32(v, cleared), vandq_u32(isBlack, half)));
 		}
+#endif
+		KeySpanScalar(p + i, count - i, keyColor, amask, halfAlpha);
+	}
+}
+
+void KeyTranslucentSurface(SDL_Surface *surface, int width, int height, Uint32 keyColor) {
+	SDL_PixelFormat *fmt = surface->format;
+	if (fmt->BytesPerPixel != 4) return;
+
+	width = std::min(width, surface->w);
+	height = std::min(height, surface->h);
+	Uint32 halfAlpha = 128 << fmt->Ashift;
+	for (int y = 0; y < height; ++y) {
+		Uint32 *row = reinterpret_cast<Uint32*>(static_cast<Uint8*>(surface->pixels) + y * surface->pitch);
+		KeySpan(row, width, keyColor, fmt->Amask, halfAlpha);
 	}
 }
 
@@ -169,11 +281,7 @@ void SDLTilesetRenderer::render(void *surf) {
 		{
 			SDL_LockSurface(tcod);
 		}
-		for (int x = 0; x < viewportWidth; ++x) {
-			for (int y = 0; y < viewportHeight; ++y) {
-				setPixelAlpha(tcod,x,y, keyColorVal);
-			}
-		}
+		KeyTranslucentSurface(tcod, viewportWidth, viewportHeight, keyColorVal);
 		if (SDL_MUSTLOCK(tcod))
 		{
 			SDL_UnlockSurface(tcod);
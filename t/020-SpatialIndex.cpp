@@ -0,0 +1,51 @@
+#define WANT_TEST_EXTRAS
+#include <tap++/tap++.h>
+
+#include "SpatialIndex.hpp"
+
+using namespace TAP;
+
+namespace {
+	struct PlainDistance {
+		Coordinate origin;
+		int operator()(const Coordinate& p) const { return Distance(origin, p); }
+	};
+
+	struct SkipOrigin {
+		Coordinate origin;
+		int operator()(const Coordinate& p) const { return p == origin ? -1 : Distance(origin, p); }
+	};
+}
+
+int main() {
+	TEST_START(9);
+
+	SpatialIndex index;
+	index.Reset(Coordinate(100, 100));
+	ok(index.Empty(), "New index is empty");
+
+	Coordinate origin(50, 50);
+	PlainDistance plain = { origin };
+	ok(index.Nearest(origin, plain) == undefined, "Nearest() on an empty index is undefined");
+
+	index.Insert(Coordinate(90, 90));
+	index.Insert(Coordinate(10, 45));
+	index.Insert(Coordinate(10, 45));
+	is(index.Size(), 2u, "Duplicates are ignored");
+	ok(index.Nearest(origin, plain) == Coordinate(10, 45), "Finds the nearest position in another cell");
+
+	index.Insert(origin);
+	ok(index.Nearest(origin, plain) == origin, "Finds a position in the origin cell");
+
+	SkipOrigin skip = { origin };
+	ok(index.Nearest(origin, skip) == Coordinate(10, 45), "Rejected positions are skipped");
+
+	index.Remove(Coordinate(10, 45));
+	ok(!index.Contains(Coordinate(10, 45)), "Removed position is gone");
+	ok(index.Nearest(origin, skip) == Coordinate(90, 90), "Falls back to the farther position");
+
+	PlainDistance outside = { Coordinate(-10, 40) };
+	ok(index.Nearest(Coordinate(-10, 40), outside) == origin, "Origin outside the map works");
+
+	TEST_END;
+}
@@ -0,0 +1,54 @@
+#define WANT_TEST_EXTRAS
+#include <tap++/tap++.h>
+
+#include <vector>
+
+#include "TimerWheel.hpp"
+
+using namespace TAP;
+
+namespace {
+	//Advances the wheel until value fires, returns the amount of ticks that took or -1
+	int TicksUntil(TimerWheel<int>& wheel, int value, int limit) {
+		std::vector<int> due;
+		for (int tick = 1; tick <= limit; ++tick) {
+			due.clear();
+			wheel.Advance(due);
+			for (std::vector<int>::iterator i = due.begin(); i != due.end(); ++i) {
+				if (*i == value) return tick;
+			}
+		}
+		return -1;
+	}
+}
+
+int main() {
+	TEST_START(8);
+
+	TimerWheel<int> wheel;
+	ok(wheel.Empty(), "New wheel is empty");
+
+	wheel.Schedule(1, 1);
+	is(TicksUntil(wheel, 1, 10), 1, "Delay of one tick fires on the next tick");
+
+	wheel.Schedule(0, 2);
+	is(TicksUntil(wheel, 2, 10), 1, "Zero delay is treated as one tick");
+
+	wheel.Schedule(300, 3);
+	is(TicksUntil(wheel, 3, 1000), 300, "Delay crossing a level-0 wrap fires on time");
+
+	wheel.Schedule(70000, 4);
+	is(TicksUntil(wheel, 4, 100000), 70000, "Delay in the third level fires on time");
+
+	wheel.Schedule(5, 5);
+	wheel.Schedule(5, 6);
+	wheel.Schedule(7, 7);
+	is(wheel.Size(), 3u, "Size counts pending values");
+	std::vector<int> due;
+	for (int tick = 0; tick < 5; ++tick) wheel.Advance(due);
+	is(due.size(), 2u, "Values due on the same tick fire together");
+	for (int tick = 0; tick < 2; ++tick) wheel.Advance(due);
+	ok(wheel.Empty(), "Wheel is empty once everything fired");
+
+	TEST_END;
+}
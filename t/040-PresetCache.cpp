@@ -0,0 +1,176 @@
+#define WANT_TEST_EXTRAS
+#include <tap++/tap++.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <boost/filesystem.hpp>
+
+#include "stdafx.hpp"
+#include "data/Mods.hpp"
+#include "data/PresetCache.hpp"
+#include "Game.hpp"
+#include "Item.hpp"
+#include "Construction.hpp"
+#include "NatureObject.hpp"
+#include "NPC.hpp"
+#include "Spell.hpp"
+#include "Faction.hpp"
+
+using namespace TAP;
+namespace fs = boost::filesystem;
+
+namespace {
+	std::string Color(const TCODColor& color) {
+		std::ostringstream out;
+		out << (int)color.r << "," << (int)color.g << "," << (int)color.b;
+		return out.str();
+	}
+
+	//One line per preset with the fields that matter to the game, plus the name lookups
+	std::vector<std::string> Describe() {
+		std::vector<std::string> lines;
+		std::ostringstream out;
+		out << "counts " << Game::ItemTypeCount << " " << Game::ItemCatCount;
+		lines.push_back(out.str());
+
+		for (size_t i = 0; i < Item::Categories.size(); ++i) {
+			const ItemCat& cat = Item::Categories[i];
+			out.str("");
+			out << "category " << cat.name << " " << cat.parent << " " << cat.flammable
+				<< " " << Item::StringToItemCategory(cat.name);
+			lines.push_back(out.str());
+		}
+		for (size_t i = 0; i < Item::Presets.size(); ++i) {
+			const ItemPreset& preset = Item::Presets[i];
+			out.str("");
+			out << "item " << preset.name << " " << Item::StringToItemType(preset.name) << " " << preset.graphic
+				<< " " << Color(preset.color) << " " << preset.nutrition << " " << preset.growth
+				<< " " << preset.fitsin << " " << preset.containIn << " " << preset.container
+				<< " " << preset.decays << " " << preset.decaySpeed << " " << preset.decayList.size()
+				<< " " << preset.fruits.size() << " " << preset.components.size()
+				<< " " << preset.bulk << " " << preset.condition
+				<< " " << preset.resistances[0] << " " << preset.fallbackGraphicsSet << " bits";
+			for (size_t cat = 0; cat < Item::Categories.size(); ++cat) {
+				out << (preset.IsCategory(cat) ? "1" : "0");
+			}
+			lines.push_back(out.str());
+		}
+		for (size_t i = 0; i < Construction::Presets.size(); ++i) {
+			const ConstructionPreset& preset = Construction::Presets[i];
+			out.str("");
+			out << "construction " << preset.name << " " << Construction::StringToConstructionType(preset.name)
+				<< " " << Construction::AllowedAmount[i] << " " << preset.maxCondition << " " << preset.graphic.size()
+				<< " " << preset.materials.size() << " " << preset.producer << " " << preset.products.size()
+				<< " " << preset.blueprint.X() << "x" << preset.blueprint.Y() << " " << preset.category
+				<< " " << Color(preset.color) << " " << preset.tileReqs.size() << " " << preset.description;
+			for (int tag = 0; tag < TAGCOUNT; ++tag) out << (preset.tags[tag] ? "1" : "0");
+			lines.push_back(out.str());
+		}
+		for (size_t i = 0; i < NatureObject::Presets.size(); ++i) {
+			const NatureObjectPreset& preset = NatureObject::Presets[i];
+			out.str("");
+			out << "wildplant " << preset.name << " " << preset.graphic << " " << Color(preset.color)
+				<< " " << preset.components.size() << " " << preset.rarity << " " << preset.cluster
+				<< " " << preset.tree << " " << preset.minHeight << " " << preset.maxHeight;
+			lines.push_back(out.str());
+		}
+		for (size_t i = 0; i < NPC::Presets.size(); ++i) {
+			const NPCPreset& preset = NPC::Presets[i];
+			out.str("");
+			out << "creature " << preset.typeName << " " << NPC::StringToNPCType(preset.typeName)
+				<< " " << preset.name << " " << preset.plural << " " << Color(preset.color)
+				<< " " << preset.ai << " " << preset.health << " " << preset.stats[0]
+				<< " " << preset.group.nb_faces << " " << preset.attacks.size() << " " << preset.tags.size()
+				<< " " << preset.deathItem << " " << preset.possibleEquipment.size() << " " << preset.faction;
+			lines.push_back(out.str());
+		}
+		for (size_t i = 0; i < Spell::Presets.size(); ++i) {
+			const SpellPreset& preset = Spell::Presets[i];
+			out.str("");
+			out << "spell " << preset.name << " " << Spell::StringToSpellType(preset.name)
+				<< " " << preset.attacks.size() << " " << preset.speed << " " << Color(preset.color);
+			lines.push_back(out.str());
+		}
+		for (size_t i = 0; i < Faction::factions.size(); ++i) {
+			out.str("");
+			out << "faction " << Faction::FactionTypeToString(i) << " "
+				<< Faction::StringToFactionType(Faction::FactionTypeToString(i))
+				<< " " << Faction::factions[i]->IsAggressive() << " " << Faction::factions[i]->IsCoward();
+			for (size_t other = 0; other < Faction::factions.size(); ++other) {
+				out << (Faction::factions[i]->IsFriendsWith(other) ? "1" : "0");
+			}
+			lines.push_back(out.str());
+		}
+		return lines;
+	}
+
+	bool SameDescription(const std::vector<std::string>& left, const std::vector<std::string>& right, const std::string& message) {
+		bool same = ok(left == right, message);
+		for (size_t i = 0; !same && i < left.size() && i < right.size(); ++i) {
+			if (left[i] != right[i]) {
+				diag("first difference:\n    ", left[i], "\n    ", right[i]);
+				break;
+			}
+		}
+		return same;
+	}
+
+	std::string Contents(const fs::path& file) {
+		std::ifstream stream(file.string().c_str(), std::ios::binary);
+		return std::string(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+	}
+}
+
+int main() {
+	TEST_START(9);
+
+	fs::path core = fs::path(__FILE__).parent_path() / ".." / "game" / "lib" / "gcamp_core";
+	fs::path cacheFile = fs::temp_directory_path() / fs::unique_path("presets-%%%%%%%%.cache");
+	fs::path copyFile = fs::temp_directory_path() / fs::unique_path("presets-%%%%%%%%.cache");
+
+	//Parse the core data the way Mods::Load does
+	Spell::LoadPresets((core / "spells.dat").string());
+	Item::LoadPresets((core / "items.dat").string());
+	Construction::LoadPresets((core / "constructions.dat").string());
+	NatureObject::LoadPresets((core / "wildplants.dat").string());
+	NPC::LoadPresets((core / "creatures.dat").string());
+	Faction::LoadPresets((core / "factions.dat").string());
+	Item::ResolveContainers();
+	Construction::ResolveProducts();
+	std::vector<std::string> parsed = Describe();
+	ok(Item::Presets.size() > 0 && NPC::Presets.size() > 0, "Core presets parsed");
+
+	std::vector<fs::path> mods(1, core);
+	boost::uint64_t key = PresetCache::Key(Mods::PresetFiles(mods));
+	ok(PresetCache::Save(cacheFile, key), "Cache written");
+	not_ok(PresetCache::Load(cacheFile, key + 1), "Cache with another key is rejected");
+	SameDescription(Describe(), parsed, "Rejected cache leaves the presets alone");
+
+	//Wipe the tables so that everything has to come from the cache
+	Item::Presets.clear();
+	Item::Categories.clear();
+	Construction::Presets.clear();
+	NatureObject::Presets.clear();
+	NPC::Presets.clear();
+	Spell::Presets.clear();
+	Faction::factions.clear();
+	Game::ItemTypeCount = Game::ItemCatCount = 0;
+
+	ok(PresetCache::Load(cacheFile, key), "Cache loaded");
+	SameDescription(Describe(), parsed, "Cached presets are identical to parsed ones");
+
+	ok(PresetCache::Save(copyFile, key), "Loaded presets written again");
+	ok(Contents(copyFile) == Contents(cacheFile), "Cache round trip is byte for byte identical");
+
+	std::string damaged = Contents(cacheFile);
+	damaged[damaged.size() / 2] ^= 0x5a;
+	std::ofstream(copyFile.string().c_str(), std::ios::binary) << damaged;
+	not_ok(PresetCache::Load(copyFile, key), "Damaged cache is rejected");
+
+	fs::remove(cacheFile);
+	fs::remove(copyFile);
+
+	TEST_END;
+}
@@ -0,0 +1,76 @@
+#define WANT_TEST_EXTRAS
+#include <tap++/tap++.h>
+
+#include <cstring>
+#include <SDL.h>
+
+#include "stdafx.hpp"
+#include "tileRenderer/sdl/SDLTilesetRenderer.hpp"
+
+using namespace TAP;
+
+namespace {
+	//The pixel by pixel, column by column pass SDLTilesetRenderer::render used to do
+	void ReferenceKey(SDL_Surface *surface, int width, int height, Uint32 keyColor) {
+		SDL_PixelFormat *fmt = surface->format;
+		if (fmt->BytesPerPixel != 4) return;
+		for (int x = 0; x < width; ++x) {
+			for (int y = 0; y < height; ++y) {
+				Uint32 *p = (Uint32 *)((Uint8 *)surface->pixels + y * surface->pitch) + x;
+				Uint32 c = (*p | fmt->Amask);
+				if (c == keyColor) {
+					*p = *p & ~fmt->Amask;
+				} else if (c == fmt->Amask) {
+					*p = (*p & ~fmt->Amask) | (128 << fmt->Ashift);
+				}
+			}
+		}
+	}
+
+	//Noise with plenty of key colored and black pixels, with and without alpha
+	void Fill(SDL_Surface *surface, Uint32 keyColor) {
+		Uint32 state = 12345;
+		for (int y = 0; y < surface->h; ++y) {
+			Uint32 *row = (Uint32 *)((Uint8 *)surface->pixels + y * surface->pitch);
+			for (int x = 0; x < surface->w; ++x) {
+				state = state * 1664525 + 1013904223;
+				Uint32 alpha = state & surface->format->Amask;
+				switch ((state >> 28) % 4) {
+				case 0: row[x] = (keyColor & ~surface->format->Amask) | alpha; break;
+				case 1: row[x] = alpha; break;
+				default: row[x] = state * 2654435761u; break;
+				}
+			}
+		}
+	}
+
+	//Keys two copies of the same noise both ways, and compares every byte of them
+	bool SameAsReference(int w, int h, int viewW, int viewH, Uint32 rmask, Uint32 gmask, Uint32 bmask, Uint32 amask, bool blackKey) {
+		SDL_Surface *expected = SDL_CreateRGBSurface(0, w, h, 32, rmask, gmask, bmask, amask);
+		SDL_Surface *actual = SDL_CreateRGBSurface(0, w, h, 32, rmask, gmask, bmask, amask);
+		Uint32 keyColor = blackKey ? SDL_MapRGBA(expected->format, 0, 0, 0, 255) : SDL_MapRGBA(expected->format, 255, 0, 255, 255);
+		Fill(expected, keyColor);
+		Fill(actual, keyColor);
+
+		ReferenceKey(expected, viewW, viewH, keyColor);
+		KeyTranslucentSurface(actual, viewW, viewH, keyColor);
+		bool same = std::memcmp(expected->pixels, actual->pixels, expected->pitch * h) == 0;
+
+		SDL_FreeSurface(expected);
+		SDL_FreeSurface(actual);
+		return same;
+	}
+}
+
+int main() {
+	TEST_START(6);
+
+	ok(SameAsReference(64, 48, 64, 48, 0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000, false), "ARGB surface matches");
+	ok(SameAsReference(61, 17, 61, 17, 0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000, false), "ABGR surface with an odd width matches");
+	ok(SameAsReference(37, 20, 37, 20, 0x00ff0000, 0x0000ff00, 0x000000ff, 0, false), "Surface without alpha matches");
+	ok(SameAsReference(40, 30, 40, 30, 0xff000000, 0x00ff0000, 0x0000ff00, 0x000000ff, true), "RGBA surface with a black key color matches");
+	ok(SameAsReference(128, 64, 45, 23, 0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000, false), "Pixels outside the viewport are left alone");
+	ok(SameAsReference(3, 5, 3, 5, 0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000, false), "Spans narrower than a vector match");
+
+	TEST_END;
+}
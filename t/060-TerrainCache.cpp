@@ -0,0 +1,110 @@
+#define WANT_TEST_EXTRAS
+#include <tap++/tap++.h>
+
+#include <cstring>
+#include <vector>
+#include <SDL.h>
+#include <boost/bind.hpp>
+
+#include "stdafx.hpp"
+#include "tileRenderer/sdl/SDLTerrainCache.hpp"
+
+using namespace TAP;
+
+namespace {
+	const int mapWidth = 70;
+	const int mapHeight = 45;
+
+	struct FakeMap {
+		std::vector<Uint32> tiles;
+		int tileWidth, tileHeight;
+		int drawn;
+
+		FakeMap() : tiles(mapWidth * mapHeight), tileWidth(4), tileHeight(3), drawn(0) {
+			Uint32 state = 4242;
+			for (size_t i = 0; i < tiles.size(); ++i) {
+				state = state * 1664525 + 1013904223;
+				tiles[i] = (state >> 8) | 0xff;
+			}
+		}
+
+		Uint32 At(int x, int y) const {
+			if (x < 0 || y < 0 || x >= mapWidth || y >= mapHeight) return 0;
+			return tiles[y * mapWidth + x];
+		}
+
+		boost::uint64_t Signature(const Coordinate& pos) const {
+			return At(pos.X(), pos.Y());
+		}
+
+		// The tile's own color, with a corner that connects to its west neighbour like connection maps do
+		void Draw(SDL_Surface* surface, int pixelX, int pixelY, const Coordinate& pos) {
+			++drawn;
+			SDL_Rect tile = { pixelX, pixelY, tileWidth, tileHeight };
+			SDL_FillRect(surface, &tile, At(pos.X(), pos.Y()));
+			SDL_Rect corner = { pixelX, pixelY, 1, 1 };
+			SDL_FillRect(surface, &corner, At(pos.X() - 1, pos.Y()) ^ 0xffffff00);
+		}
+
+		// What drawing every tile in view one by one gives
+		void DrawDirect(SDL_Surface* target, int originX, int originY, const Coordinate& start, const Coordinate& extent) {
+			for (int y = start.Y(); y < start.Y() + extent.Y(); ++y) {
+				for (int x = start.X(); x < start.X() + extent.X(); ++x) {
+					if (x >= 0 && y >= 0 && x < mapWidth && y < mapHeight) {
+						Draw(target, originX + (x - start.X()) * tileWidth, originY + (y - start.Y()) * tileHeight, Coordinate(x, y));
+					}
+				}
+			}
+		}
+	};
+
+	SDL_Surface* Viewport() {
+		SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, 200, 120, 32, SDL_PIXELFORMAT_RGBA8888);
+		SDL_FillRect(surface, 0, 0x12345678);
+		SDL_Rect clip = { 5, 7, 180, 100 };
+		SDL_SetClipRect(surface, &clip);
+		return surface;
+	}
+
+	// Draws the view both ways onto off-screen surfaces and compares every byte of them
+	bool SameAsDirect(FakeMap& map, SDLTerrainCache& cache, int originX, int originY, const Coordinate& start, const Coordinate& extent) {
+		SDL_Surface* expected = Viewport();
+		SDL_Surface* actual = Viewport();
+
+		map.DrawDirect(expected, originX, originY, start, extent);
+		map.drawn = 0;
+		cache.Reset(Coordinate(mapWidth, mapHeight), map.tileWidth, map.tileHeight, actual->format);
+		cache.Draw(actual, originX, originY, start, extent,
+			boost::bind(&FakeMap::Signature, &map, _1), boost::bind(&FakeMap::Draw, &map, _1, _2, _3, _4));
+		bool same = std::memcmp(expected->pixels, actual->pixels, expected->pitch * expected->h) == 0;
+
+		SDL_FreeSurface(expected);
+		SDL_FreeSurface(actual);
+		return same;
+	}
+}
+
+int main() {
+	TEST_START(8);
+
+	FakeMap map;
+	SDLTerrainCache cache;
+	const int chunkTiles = SDLTerrainCache::ChunkSize * SDLTerrainCache::ChunkSize;
+
+	ok(SameAsDirect(map, cache, 3, 2, Coordinate(-2, 5), Coordinate(46, 34)), "View over the map's edge matches");
+	ok(SameAsDirect(map, cache, 3, 2, Coordinate(-2, 5), Coordinate(46, 34)), "Unchanged view matches");
+	is(map.drawn, 0, "Unchanged view draws no tiles");
+
+	map.tiles[20 * mapWidth + SDLTerrainCache::ChunkSize - 1] ^= 0xff00;
+	ok(SameAsDirect(map, cache, 3, 2, Coordinate(-2, 5), Coordinate(46, 34)), "Tile changed on a chunk's edge shows up");
+	is(map.drawn, 2 * chunkTiles, "Its chunk and the one it connects to are redrawn");
+
+	ok(SameAsDirect(map, cache, -1, 0, Coordinate(30, 15), Coordinate(46, 34)), "Scrolled view over the map's corner matches");
+
+	map.tileWidth = 3;
+	map.tileHeight = 5;
+	ok(SameAsDirect(map, cache, 0, -4, Coordinate(12, 9), Coordinate(61, 22)), "Tiles of another size match");
+	ok(map.drawn > 0, "New tile size redraws the chunks");
+
+	TEST_END;
+}
@@ -0,0 +1,93 @@
+#define WANT_TEST_EXTRAS
+#include <tap++/tap++.h>
+
+#include <cstdlib>
+#include <vector>
+#include <libtcod.hpp>
+
+#include "stdafx.hpp"
+#include "GroupPath.hpp"
+
+using namespace TAP;
+
+namespace {
+	const int width = 60;
+	const int height = 40;
+
+	//Open ground with a wall down the middle that has a gap in it
+	class Grid : public ITCODPathCallback {
+	public:
+		std::vector<bool> blocked;
+		Grid() : blocked(width * height, false) {
+			for (int y = 0; y < height; ++y) {
+				if (y < 18 || y > 21) Block(Coordinate(30, y));
+			}
+		}
+		void Block(const Coordinate& p) { blocked[p.Y() * width + p.X()] = true; }
+		bool Walkable(const Coordinate& p) const {
+			return p.X() >= 0 && p.Y() >= 0 && p.X() < width && p.Y() < height && !blocked[p.Y() * width + p.X()];
+		}
+		float getWalkCost(int, int, int toX, int toY, void*) const {
+			return Walkable(Coordinate(toX, toY)) ? 1.0f : 0.0f;
+		}
+	};
+
+	std::vector<Coordinate> Search(const Grid& grid, const Coordinate& start, const Coordinate& end) {
+		TCODPath search(width, height, &grid, 0);
+		std::vector<Coordinate> path;
+		if (search.compute(start.X(), start.Y(), end.X(), end.Y())) {
+			for (int i = 0; i < search.size(); ++i) {
+				Coordinate p;
+				search.get(i, p.Xptr(), p.Yptr());
+				path.push_back(p);
+			}
+		}
+		return path;
+	}
+
+	//Every step goes to a walkable neighbour, and the last one onto the target
+	bool Walks(const Grid& grid, const Coordinate& start, const Coordinate& target, const std::vector<Coordinate>& path) {
+		if (path.empty() || path.back() != target) return false;
+		Coordinate from = start;
+		for (std::vector<Coordinate>::const_iterator p = path.begin(); p != path.end(); ++p) {
+			if (std::abs(p->X() - from.X()) > 1 || std::abs(p->Y() - from.Y()) > 1 || !grid.Walkable(*p)) return false;
+			from = *p;
+		}
+		return true;
+	}
+}
+
+int main() {
+	TEST_START(11);
+
+	Grid grid;
+	Coordinate extent(width, height);
+	std::vector<Coordinate> path;
+
+	GroupPath lost;
+	lost.Enlist();
+	lost.Publish(0);
+	is(lost.GetState(), GroupPath::FAILED, "Leader without a path fails the group");
+
+	GroupPath group;
+	is(group.Enlist(), GroupPath::LEADING, "First member leads");
+	is(group.Enlist(), GroupPath::PENDING, "The others wait for it");
+	not_ok(group.Follow(Coordinate(5, 5), Coordinate(50, 30), extent, &grid, 0, path), "There's nothing to follow yet");
+
+	std::vector<Coordinate> route = Search(grid, Coordinate(5, 5), Coordinate(50, 30));
+	group.Publish(&route);
+	is(group.Enlist(), GroupPath::READY, "Route is ready once the leader published it");
+
+	Coordinate start(7, 9), target(53, 27);
+	ok(group.Follow(start, target, extent, &grid, 0, path), "Member next to the leader follows the route");
+	ok(Walks(grid, start, target, path), "Followed path leads to the member's own target");
+	ok(path.size() <= Search(grid, start, target).size() + 2 * GroupPath::JoinDistance, "Followed path isn't much longer than its own");
+
+	not_ok(group.Follow(Coordinate(3, 38), target, extent, &grid, 0, path), "Member far from the route searches on its own");
+	not_ok(group.Follow(start, Coordinate(55, 2), extent, &grid, 0, path), "Target far from the route is searched for on its own");
+
+	grid.Block(route[route.size() / 2]);
+	not_ok(group.Follow(start, target, extent, &grid, 0, path), "Route blocked since it was found isn't followed");
+
+	TEST_END;
+}